@@ -0,0 +1,172 @@
+/*!
+ * \file analysis_types.h
+ *
+ * Contains the element and degree of freedom configurations that the
+ * assembler, constraint loading and post-processing are specialized on.
+ */
+
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_ANALYSIS_TYPES_H
+#define FEA_ANALYSIS_TYPES_H
+
+#include "containers.h"
+
+namespace fea {
+
+/**
+ * @brief Selects the element formulation and the degrees of freedom carried by
+ * each node.
+ */
+enum AnalysisType {
+  /**
+   * 3D Euler-Bernoulli frame. 6 DOFs per node.
+   */
+  FRAME_3D,
+
+  /**
+   * Frame in the global x-y plane. Nodes carry `DISPLACEMENT_X`,
+   * `DISPLACEMENT_Y` and `ROTATION_Z`.
+   */
+  FRAME_2D,
+
+  /**
+   * Pin-jointed 3D truss. Elements only carry axial load and nodes carry the 3
+   * translational DOFs.
+   */
+  TRUSS_3D,
+
+  /**
+   * Pin-jointed truss in the global x-y plane. Nodes carry `DISPLACEMENT_X`
+   * and `DISPLACEMENT_Y`.
+   */
+  TRUSS_2D
+};
+
+/**
+ * @brief Configuration of a 3D frame analysis.
+ * @details Each configuration defines the number of DOFs stored per node in
+ * the global system (`NUM_DOFS`), whether elements are restricted to the x-y
+ * plane (`PLANAR`), whether elements only carry axial load (`TRUSS`), and the
+ * mapping between `fea::DOF` values and the position of the DOF within a node
+ * of the global system. DOFs that are not active are identically zero.
+ */
+struct Frame3D {
+  static const unsigned int NUM_DOFS = 6; /**<Active DOFs per node.*/
+  static const bool PLANAR = false; /**<Elements lie in the x-y plane.*/
+  static const bool TRUSS = false;  /**<Elements only carry axial load.*/
+
+  /**
+   * @brief Returns the position of `dof` within a node of the global system,
+   * or -1 if `dof` is not active.
+   */
+  static int activeIndex(unsigned int dof) {
+    return dof < DOF::NUM_DOFS ? static_cast<int>(dof) : -1;
+  }
+
+  /**
+   * @brief Returns the `fea::DOF` stored at position `i` of a node.
+   */
+  static unsigned int dof(unsigned int i) { return i; }
+};
+
+/**
+ * @brief Configuration of a frame analysis in the x-y plane.
+ * @sa fea::Frame3D
+ */
+struct Frame2D {
+  static const unsigned int NUM_DOFS = 3; /**<Active DOFs per node.*/
+  static const bool PLANAR = true;  /**<Elements lie in the x-y plane.*/
+  static const bool TRUSS = false;  /**<Elements only carry axial load.*/
+
+  /**
+   * @brief Returns the position of `dof` within a node of the global system,
+   * or -1 if `dof` is not active.
+   */
+  static int activeIndex(unsigned int dof) {
+    static const int map[DOF::NUM_DOFS] = {0, 1, -1, -1, -1, 2};
+    return dof < DOF::NUM_DOFS ? map[dof] : -1;
+  }
+
+  /**
+   * @brief Returns the `fea::DOF` stored at position `i` of a node.
+   */
+  static unsigned int dof(unsigned int i) {
+    static const unsigned int map[NUM_DOFS] = {
+        DOF::DISPLACEMENT_X, DOF::DISPLACEMENT_Y, DOF::ROTATION_Z};
+    return map[i];
+  }
+};
+
+/**
+ * @brief Configuration of a pin-jointed 3D truss analysis.
+ * @sa fea::Frame3D
+ */
+struct Truss3D {
+  static const unsigned int NUM_DOFS = 3; /**<Active DOFs per node.*/
+  static const bool PLANAR = false; /**<Elements lie in the x-y plane.*/
+  static const bool TRUSS = true;   /**<Elements only carry axial load.*/
+
+  /**
+   * @brief Returns the position of `dof` within a node of the global system,
+   * or -1 if `dof` is not active.
+   */
+  static int activeIndex(unsigned int dof) {
+    return dof < NUM_DOFS ? static_cast<int>(dof) : -1;
+  }
+
+  /**
+   * @brief Returns the `fea::DOF` stored at position `i` of a node.
+   */
+  static unsigned int dof(unsigned int i) { return i; }
+};
+
+/**
+ * @brief Configuration of a pin-jointed truss analysis in the x-y plane.
+ * @sa fea::Frame3D
+ */
+struct Truss2D {
+  static const unsigned int NUM_DOFS = 2; /**<Active DOFs per node.*/
+  static const bool PLANAR = true;  /**<Elements lie in the x-y plane.*/
+  static const bool TRUSS = true;   /**<Elements only carry axial load.*/
+
+  /**
+   * @brief Returns the position of `dof` within a node of the global system,
+   * or -1 if `dof` is not active.
+   */
+  static int activeIndex(unsigned int dof) {
+    return dof < NUM_DOFS ? static_cast<int>(dof) : -1;
+  }
+
+  /**
+   * @brief Returns the `fea::DOF` stored at position `i` of a node.
+   */
+  static unsigned int dof(unsigned int i) { return i; }
+};
+
+} // namespace fea
+
+#endif // FEA_ANALYSIS_TYPES_H
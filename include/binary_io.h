@@ -0,0 +1,210 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_BINARY_IO_H
+#define FEA_BINARY_IO_H
+
+#include <boost/format.hpp>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "csv_parser.h"
+
+namespace fea {
+
+    /**
+     * @brief Writes a 2D array of doubles as a raw little-endian float64 file.
+     * @details The file starts with a 64 byte header: the magic string "FEARES" padded to 8 bytes, the `uint32`
+     * format version and header size, followed by the `uint64` number of rows and columns. The values follow in
+     * row-major order, so the array starts 64-byte aligned. Throws `std::runtime_error` if the rows of `data`
+     * have different lengths or the file cannot be written.
+     *
+     * @param[in] filename `std::string`. The file to write data to.
+     * @param[in] data `std::vector< std::vector<double> >`. Data to write to file.
+     */
+    void writeRawBinary(const std::string &filename, const std::vector<std::vector<double> > &data);
+
+    /**
+     * @brief Writes the `num_rows` x `num_cols` row-major array `data` as a raw little-endian float64 file.
+     * @details Same as above for results that are stored contiguously. The values are written directly from
+     * `data`.
+     */
+    void writeRawBinary(const std::string &filename, const double *data, size_t num_rows, size_t num_cols);
+
+    /**
+     * @brief Writes a 2D array of doubles as a NumPy `.npy` file.
+     * @details The array is stored as little-endian float64 in row-major order, so `numpy.load` maps it without
+     * parsing. Throws `std::runtime_error` if the rows of `data` have different lengths or the file cannot be
+     * written.
+     *
+     * @param[in] filename `std::string`. The file to write data to.
+     * @param[in] data `std::vector< std::vector<double> >`. Data to write to file.
+     */
+    void writeNpy(const std::string &filename, const std::vector<std::vector<double> > &data);
+
+    /**
+     * @brief Writes the `num_rows` x `num_cols` row-major array `data` as a NumPy `.npy` file.
+     * @details Same as above for results that are stored contiguously. The values are written directly from
+     * `data`.
+     */
+    void writeNpy(const std::string &filename, const double *data, size_t num_rows, size_t num_cols);
+
+    /**
+     * @brief Location and layout of a 2D NumPy array inside a file.
+     */
+    struct NpyArray {
+        char kind; /**<'f' for floating point, 'i' for signed and 'u' for unsigned integer values.*/
+        size_t item_size; /**<Size of each value in bytes.*/
+        size_t rows; /**<Number of rows. A 1D array has one column per row.*/
+        size_t cols; /**<Number of columns.*/
+        bool fortran_order; /**<Whether the values are stored column by column.*/
+        const char *data; /**<The first value. Points into the memory holding the file.*/
+    };
+
+    /**
+     * @brief Parses the header of the `.npy` file held in `[data, data + size)`.
+     * @details Only little-endian arrays of up to 2 dimensions holding `float32`, `float64` or 1, 2, 4 or 8 byte
+     * integers are supported. Throws `std::runtime_error` naming `filename` otherwise.
+     *
+     * @param[in] data `const char*`. Contents of the `.npy` file.
+     * @param[in] size `size_t`. Number of bytes in `data`.
+     * @param[in] filename `std::string`. File name used in error messages.
+     * @return The layout of the array. `fea::NpyArray`.
+     */
+    NpyArray parseNpy(const char *data, size_t size, const std::string &filename);
+
+    /**
+     * @brief Finds the array `array_name` in the `.npz` archive held in `[data, data + size)`.
+     * @details The archive member named `array_name` + ".npy" is used, or the only member if the archive holds a
+     * single array. Members must be stored uncompressed as written by `numpy.savez`, archives written by
+     * `numpy.savez_compressed` are rejected. Throws `std::runtime_error` naming `filename` if the array is not
+     * found.
+     *
+     * @param[in] data `const char*`. Contents of the `.npz` file.
+     * @param[in] size `size_t`. Number of bytes in `data`.
+     * @param[in] filename `std::string`. File name used in error messages.
+     * @param[in] array_name `std::string`. Name of the array to find.
+     * @return The layout of the array. `fea::NpyArray`.
+     */
+    NpyArray findNpzArray(const char *data, size_t size, const std::string &filename, const std::string &array_name);
+
+    /**
+     * @brief Copies the values of `array`, stored as `S`, into `out` in row-major order converting them to `T`.
+     * @return <B>Success</B> `bool`. False if a negative value was converted to an unsigned `T`.
+     */
+    template<typename S, typename T>
+    bool convertNpyArray(const NpyArray &array, T *out) {
+        bool negative = false;
+        for (size_t i = 0; i < array.rows; ++i) {
+            for (size_t j = 0; j < array.cols; ++j) {
+                const size_t k = array.fortran_order ? j * array.rows + i : i * array.cols + j;
+                S value;
+                std::memcpy(&value, array.data + k * sizeof(S), sizeof(S));
+                negative |= value < S();
+                out[i * array.cols + j] = static_cast<T>(value);
+            }
+        }
+        return !negative || std::is_signed<T>::value;
+    }
+
+    /**
+     * @brief Reads a 2D array from a `.npy` file or from the member `array_name` of a `.npz` archive.
+     * @details The file is memory-mapped and the values are copied into `data`, converting them to `T` if their
+     * dtype differs. Integral types only accept integer arrays, and unsigned types only non-negative values. Throws
+     * `std::runtime_error` if the file cannot be read or holds an unsupported array.
+     *
+     * @param[in] filename `std::string`. The `.npy` or `.npz` file to read.
+     * @param[in] array_name `std::string`. Name of the array within a `.npz` archive.
+     * @param data `std::vector<T>`. Updated in place to hold the values in row-major order.
+     * @param row_offsets `std::vector<size_t>`. Updated in place to hold the offset into `data` of the first value
+     * of each row, followed by `data.size()`, as filled by `fea::CSVParser::parseToArray`.
+     */
+    template<typename T>
+    void readNumpyArray(const std::string &filename, const std::string &array_name,
+                        std::vector<T> &data, std::vector<size_t> &row_offsets) {
+        const MappedFile file(filename);
+        const bool is_npz = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".npz") == 0;
+        const NpyArray array = is_npz ? findNpzArray(file.data(), file.size(), filename, array_name)
+                                      : parseNpy(file.data(), file.size(), filename);
+
+        if (std::is_integral<T>::value && array.kind == 'f') {
+            throw std::runtime_error(
+                    (boost::format("Array %s in %s holds floating point values, but integers were expected.") %
+                     array_name % filename).str()
+            );
+        }
+
+        data.resize(array.rows * array.cols);
+        row_offsets.resize(array.rows + 1);
+        for (size_t i = 0; i <= array.rows; ++i) {
+            row_offsets[i] = i * array.cols;
+        }
+        if (data.empty()) {
+            return;
+        }
+
+        const bool same_type = array.item_size == sizeof(T) &&
+                               (array.kind == 'f' ? std::is_floating_point<T>::value
+                                                  : std::is_integral<T>::value &&
+                                                    std::is_signed<T>::value == (array.kind == 'i'));
+        if (same_type && !array.fortran_order) {
+            std::memcpy(data.data(), array.data, data.size() * sizeof(T));
+        }
+        else if (array.kind == 'f') {
+            if (array.item_size == 4) convertNpyArray<float>(array, data.data());
+            else convertNpyArray<double>(array, data.data());
+        }
+        else if (array.kind == 'i') {
+            bool converted;
+            switch (array.item_size) {
+                case 1: converted = convertNpyArray<std::int8_t>(array, data.data()); break;
+                case 2: converted = convertNpyArray<std::int16_t>(array, data.data()); break;
+                case 4: converted = convertNpyArray<std::int32_t>(array, data.data()); break;
+                default: converted = convertNpyArray<std::int64_t>(array, data.data());
+            }
+            if (!converted) {
+                throw std::runtime_error(
+                        (boost::format("Array %s in %s holds negative values, but unsigned integers were "
+                                               "expected.") % array_name % filename).str()
+                );
+            }
+        }
+        else {
+            switch (array.item_size) {
+                case 1: convertNpyArray<std::uint8_t>(array, data.data()); break;
+                case 2: convertNpyArray<std::uint16_t>(array, data.data()); break;
+                case 4: convertNpyArray<std::uint32_t>(array, data.data()); break;
+                default: convertNpyArray<std::uint64_t>(array, data.data());
+            }
+        }
+    }
+
+} // namespace fea
+
+#endif // FEA_BINARY_IO_H
@@ -0,0 +1,62 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_BINARY_JOB_H
+#define FEA_BINARY_JOB_H
+
+#include <string>
+#include <vector>
+
+#include "containers.h"
+
+namespace fea {
+
+    /**
+     * @brief Writes `model` to a binary job file.
+     * @details The file starts with a 32 byte header holding the magic string "FEABJOB", the format version and
+     * the number of sections, followed by a table with the type, element size, offset and length of each
+     * section. Each section is a little-endian array aligned to 64 bytes. Node indices are stored as 64-bit
+     * integers so that files can be read by builds with either index width.
+     * Throws `std::runtime_error` if the file cannot be written or the elements of `model` are streamed.
+     *
+     * @param[in] filename `std::string`. The file to write.
+     * @param[in] model `fea::Model`. The job and constraints to save.
+     */
+    void writeBinaryJob(const std::string &filename, const Model &model);
+
+    /**
+     * @brief Reads a binary job file written by `fea::writeBinaryJob`.
+     * @details The file is memory-mapped and each section is copied into the job in a single pass, so loading
+     * takes a fraction of the time needed to parse the equivalent csv files. Throws `std::runtime_error` if the
+     * file is not a binary job file, was written with an unsupported version or is truncated.
+     *
+     * @param[in] filename `std::string`. The file to read.
+     * @return The job and constraints. `fea::Model`.
+     */
+    Model readBinaryJob(const std::string &filename);
+
+} // namespace fea
+
+#endif // FEA_BINARY_JOB_H
@@ -0,0 +1,101 @@
+/*!
+ * \file coincident_nodes.h
+ *
+ * Contains functions that find nodes lying within a tolerance of each other
+ * and connect them.
+ */
+
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_COINCIDENT_NODES_H
+#define FEA_COINCIDENT_NODES_H
+
+#include <vector>
+
+#include "containers.h"
+
+namespace fea {
+
+/**
+ * @brief Finds groups of coincident nodes.
+ * @details Nodes are binned into a spatial hash grid with a cell size equal to
+ * `tolerance`, so only nodes in the same or adjacent cells are compared and
+ * the search runs in linear time for meshes without large clusters. Nodes
+ * closer than `tolerance` belong to the same group, as do nodes linked through
+ * a chain of such pairs. Hashing and the neighbor search run in parallel when
+ * the library is built with OpenMP.
+ *
+ * Throws `std::runtime_error` if `tolerance` is not positive.
+ *
+ * @param[in] nodes `std::vector<fea::Node>`. Nodes to search.
+ * @param[in] tolerance `double`. Distance below which 2 nodes coincide.
+ * @return <B>Representatives</B> `std::vector<fea::NodeIndex>`. `[i]` is the
+ * smallest node index of the group containing node `i`, i.e. `i` for nodes
+ * that do not coincide with any node of lower index.
+ */
+std::vector<NodeIndex> findCoincidentNodes(const std::vector<Node> &nodes,
+                                           double tolerance);
+
+/**
+ * @brief Creates rigid links that merge coincident nodes.
+ * @details Each group found by `fea::findCoincidentNodes` becomes a
+ * `fea::RigidBody` whose master is the node of lowest index. Passing the rigid
+ * bodies to `fea::solve` condenses the duplicate nodes into their master, which
+ * is equivalent to merging them in the job without renumbering the nodes
+ * referenced by elements and constraints.
+ *
+ * @param[in] nodes `std::vector<fea::Node>`. Nodes to search.
+ * @param[in] tolerance `double`. Distance below which 2 nodes coincide.
+ * @param[in] existing `std::vector<fea::RigidBody>`. Rigid bodies that are
+ * already part of the analysis. Since a node may only belong to one rigid
+ * body, their nodes are not made slaves. Instead the other nodes of a group
+ * that contains such a node become slaves of the master of its rigid body.
+ * Throws if a node of an existing rigid body does not exist.
+ * @return <B>Rigid bodies</B> `std::vector<fea::RigidBody>`.
+ */
+std::vector<RigidBody> createCoincidentNodeRigidBodies(
+    const std::vector<Node> &nodes, double tolerance,
+    const std::vector<RigidBody> &existing = std::vector<RigidBody>());
+
+/**
+ * @brief Creates ties between coincident nodes.
+ * @details Ties each node found by `fea::findCoincidentNodes` to the node of
+ * lowest index in its group. Prefer `fea::createCoincidentNodeRigidBodies`
+ * unless the joints are meant to be flexible.
+ *
+ * @param[in] nodes `std::vector<fea::Node>`. Nodes to search.
+ * @param[in] tolerance `double`. Distance below which 2 nodes coincide.
+ * @param[in] lmult `double`. Spring constant of the translational DOFs.
+ * @param[in] rmult `double`. Spring constant of the rotational DOFs.
+ * @return <B>Ties</B> `std::vector<fea::Tie>`.
+ */
+std::vector<Tie> createCoincidentNodeTies(const std::vector<Node> &nodes,
+                                          double tolerance, double lmult,
+                                          double rmult);
+
+} // namespace fea
+
+#endif // FEA_COINCIDENT_NODES_H
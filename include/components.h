@@ -0,0 +1,133 @@
+/*!
+ * \file components.h
+ *
+ * Contains functions that split an analysis into its connected components and
+ * check that each component is restrained against rigid body motion.
+ */
+
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_COMPONENTS_H
+#define FEA_COMPONENTS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "analysis_types.h"
+#include "containers.h"
+
+namespace fea {
+
+/**
+ * @brief A part of an analysis that is not connected to the rest of the model.
+ * @details Nodes are connected by elements, ties, equations and rigid bodies.
+ * Each member holds indices into the corresponding input of the analysis in
+ * ascending order.
+ */
+struct Component {
+  std::vector<NodeIndex> nodes; /**<Nodes of the component.*/
+  std::vector<size_t> elems; /**<Elements of the component.*/
+  std::vector<size_t> bcs; /**<Boundary conditions on its nodes.*/
+  std::vector<size_t> forces; /**<Forces on its nodes.*/
+  std::vector<size_t> ties; /**<Ties between its nodes.*/
+  std::vector<size_t> equations; /**<Equations on its nodes.*/
+  std::vector<size_t> rigid_bodies; /**<Rigid bodies of its nodes.*/
+};
+
+/**
+ * @brief The input of an analysis restricted to a single component.
+ * @details Node indices are renumbered to the position of the node in
+ * `Component::nodes`.
+ */
+struct ComponentAnalysis {
+  Job job; /**<Nodes and elements of the component.*/
+  std::vector<BC> bcs; /**<Boundary conditions of the component.*/
+  std::vector<Force> forces; /**<Forces of the component.*/
+  std::vector<Tie> ties; /**<Ties of the component.*/
+  std::vector<Equation> equations; /**<Equations of the component.*/
+  std::vector<RigidBody> rigid_bodies; /**<Rigid bodies of the component.*/
+};
+
+/**
+ * @brief Finds the connected components of an analysis.
+ * @details Runs a union-find pass over the elements, ties, equations and rigid
+ * bodies, which is linear in the size of the input. Nodes that are not
+ * connected to any other node form a component of their own.
+ *
+ * @return <B>Components</B> `std::vector<fea::Component>`. Ordered by their
+ * lowest node index.
+ */
+std::vector<Component> findComponents(const Job &job,
+                                      const std::vector<BC> &BCs,
+                                      const std::vector<Force> &forces,
+                                      const std::vector<Tie> &ties,
+                                      const std::vector<Equation> &equations,
+                                      const std::vector<RigidBody> &rigid_bodies);
+
+/**
+ * @brief Extracts the input of a single component from the analysis.
+ *
+ * @param[in] component `fea::Component`. Component to extract.
+ * @return <B>Analysis of the component</B> `fea::ComponentAnalysis`.
+ */
+ComponentAnalysis
+extractComponent(const Component &component, const Job &job,
+                 const std::vector<BC> &BCs, const std::vector<Force> &forces,
+                 const std::vector<Tie> &ties,
+                 const std::vector<Equation> &equations,
+                 const std::vector<RigidBody> &rigid_bodies);
+
+/**
+ * @brief Counts the rigid body modes of a component that are not restrained.
+ * @details A component moves as a rigid body without straining its elements.
+ * Such a motion is only prevented if the boundary conditions and equations of
+ * the component restrain every rigid body mode the nodal DOFs can represent,
+ * otherwise the global stiffness matrix is singular. Modes that do not move
+ * any DOF, e.g. the rotation of a straight truss about its own axis, are not
+ * counted. `Config` (see analysis_types.h) determines the DOFs of each node and
+ * the rigid body modes of planar analyses.
+ *
+ * Only motions of the component as a whole are detected. Mechanisms inside a
+ * restrained component, e.g. a truss node held by collinear members or a
+ * four-bar linkage, are not counted and surface, if at all, as a failed or
+ * ill-conditioned factorization.
+ *
+ * @param[in] component `fea::Component`. Component to check, as found by
+ * `fea::findComponents` from `job`, `BCs` and `equations`.
+ * @param[in] job `fea::Job`. Job providing the nodal coordinates.
+ * @param[in] BCs `std::vector<fea::BC>`. Boundary conditions on DOFs that are
+ * active in `Config`.
+ * @param[in] equations `std::vector<fea::Equation>`. Equation constraints.
+ * @return <B>Number of unrestrained modes</B> `unsigned int`.
+ */
+template <typename Config>
+unsigned int countUnrestrainedModes(const Component &component, const Job &job,
+                                    const std::vector<BC> &BCs,
+                                    const std::vector<Equation> &equations);
+
+} // namespace fea
+
+#endif // FEA_COMPONENTS_H
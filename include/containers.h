@@ -36,10 +36,52 @@
 #define FEA_CONTAINERS_H
 
 #include <Eigen/Core>
+#include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace fea {
 
+#ifdef FEA_USE_64BIT_INDICES
+/**
+ * @brief Index of a node or element.
+ * @details 64 bits wide since the library was built with
+ * `FEA_USE_64BIT_INDICES`.
+ */
+typedef std::uint64_t NodeIndex;
+
+/**
+ * @brief Index type of the global stiffness matrix and its triplets.
+ * @details 64 bits wide since the library was built with
+ * `FEA_USE_64BIT_INDICES`.
+ */
+typedef std::int64_t StorageIndex;
+#else
+/**
+ * @brief Index of a node or element.
+ * @details Limits a model to \f$2^{32}\f$ nodes. Build with
+ * `FEA_USE_64BIT_INDICES` for larger models.
+ */
+typedef unsigned int NodeIndex;
+
+/**
+ * @brief Index type of the global stiffness matrix and its triplets.
+ * @details Must be signed. Limits the number of DOFs and of nonzeros in the
+ * global stiffness matrix to \f$2^{31}-1\f$. Build with
+ * `FEA_USE_64BIT_INDICES` for larger models.
+ */
+typedef int StorageIndex;
+#endif
+
+/**
+ * @brief The indices of the two nodes of an element.
+ * @details Uses `fea::NodeIndex` like every other reference to a node. Node
+ * indices are converted to `fea::StorageIndex` when the DOFs of a node are
+ * looked up for the global stiffness matrix.
+ */
+typedef Eigen::Matrix<NodeIndex, 2, 1> Connectivity;
+
 /**
  * @brief Convenience enumerator for specifying the active degree of freedom in
  * a constraint.
@@ -104,14 +146,14 @@ typedef Eigen::Vector3d Node;
  *
  * @code
  * // define the node number to constrain
- * unsigned int nn1 = 0;
+ * fea::NodeIndex nn1 = 0;
  * // define the value to hold the nodal DOF at
  * double value = 0.0;
  * fea::BC bc(nn1, fea::DOF::DISPLACEMENT_X, value);
  * @endcode
  */
 struct BC {
-  unsigned int node; /**<The index of the node to constrain*/
+  NodeIndex node; /**<The index of the node to constrain*/
 
   /**
    * The index of the dof to constrain. The fea::DOF enum can be used for
@@ -130,12 +172,12 @@ struct BC {
 
   /**
    * @brief Constructor
-   * @param[in] node `unsigned int`. The index of the node.
+   * @param[in] node `fea::NodeIndex`. The index of the node.
    * @param[in] dof `unsigned int`. Degree of freedom to constrain (See
    * fea::DOF).
    * @param[in] value `double`. The prescribed value for the boundary condition.
    */
-  BC(unsigned int _node, unsigned int _dof, double _value)
+  BC(NodeIndex _node, unsigned int _dof, double _value)
       : node(_node), dof(_dof), value(_value) {
     assert(dof < DOF::NUM_DOFS);
   };
@@ -148,14 +190,14 @@ struct BC {
  *
  * @code
  * // define the node number to constrain
- * unsigned int nn1 = 0;
+ * fea::NodeIndex nn1 = 0;
  * // define the value to hold the nodal DOF at
  * double value = 0.0;
  * fea::Force force(nn1, fea::DOF::DISPLACEMENT_X, value);
  * @endcode
  */
 struct Force {
-  unsigned int node; /**<The index of the node to apply the force*/
+  NodeIndex node; /**<The index of the node to apply the force*/
 
   /**
    * The index of the dof to constrain. The fea::DOF enum can be used for
@@ -174,12 +216,12 @@ struct Force {
 
   /**
    * @brief Constructor
-   * @param[in] node `unsigned int`. The index of the node.
+   * @param[in] node `fea::NodeIndex`. The index of the node.
    * @param[in] dof `unsigned int`. Degree of freedom to constrain (See
    * fea::DOF).
    * @param[in] value `double`. The prescribed value for the force.
    */
-  Force(unsigned int _node, unsigned int _dof, double _value)
+  Force(NodeIndex _node, unsigned int _dof, double _value)
       : node(_node), dof(_dof), value(_value) {
     assert(dof < DOF::NUM_DOFS);
   };
@@ -241,8 +283,8 @@ struct Props {
  * DOFs.
  * @code
  * // create the tie between node2 and node3
- * unsigned int nn1 = 1; // i.e. the second node in the node list
- * unsigned int nn2 = 2; // i.e. the third node in the node list
+ * fea::NodeIndex nn1 = 1; // i.e. the second node in the node list
+ * fea::NodeIndex nn2 = 2; // i.e. the third node in the node list
  *
  * // define the spring constant for x, y, and z translational DOFs
  * double lmult = 100.0;
@@ -255,10 +297,10 @@ struct Props {
  * @endcode
  */
 struct Tie {
-  unsigned int
+  NodeIndex
       node_number_1; /**<The first element's index involved in the constraint.*/
-  unsigned int node_number_2; /**<The second element's index involved in the
-                                 constraint.*/
+  NodeIndex node_number_2; /**<The second element's index involved in the
+                              constraint.*/
   double lmult;               /**<multiplier for the linear spring.*/
   double rmult;               /**<multiplier for the rotational spring.*/
 
@@ -270,19 +312,69 @@ struct Tie {
 
   /**
    * @brief Constructor
-   * @param[in] node_number_1 `unsigned int`. Index of the first node.
-   * @param[in] node_number_2 `unsigned int`. Index of the second node.
+   * @param[in] node_number_1 `fea::NodeIndex`. Index of the first node.
+   * @param[in] node_number_2 `fea::NodeIndex`. Index of the second node.
    * @param[in] lmult `double`. Spring constant for the translational degrees of
    * freedom.
    * @param[in] rmult `double`. Spring constant for the rotational degrees of
    * freedom.
    */
-  Tie(unsigned int _node_number_1, unsigned int _node_number_2, double _lmult,
+  Tie(NodeIndex _node_number_1, NodeIndex _node_number_2, double _lmult,
       double _rmult)
       : node_number_1(_node_number_1), node_number_2(_node_number_2),
         lmult(_lmult), rmult(_rmult){};
 };
 
+/**
+ * @brief Rigidly connects a set of slave nodes to a master node.
+ * @details The slave nodes follow the rigid body motion of the master node,
+ * i.e. a slave at position \f$x_s\f$ displaces by
+ * \f$u_s = u_m + \theta_m \times (x_s - x_m)\f$ and rotates by
+ * \f$\theta_s = \theta_m\f$. Unlike a stiff `fea::Tie`, the constraint is
+ * exact: the DOFs of the slave nodes are condensed into those of the master
+ * node and do not appear in the global system. A rigid link is a rigid body
+ * with a single slave node.
+ *
+ * Each node may be the slave of at most one rigid body and the master node of
+ * a rigid body may not be the slave of another.
+ *
+ * @code
+ * // rigidly link node 1 to node 0
+ * fea::RigidBody link(0, 1);
+ *
+ * // make nodes 3, 4 and 5 follow node 2
+ * fea::RigidBody body(2, {3, 4, 5});
+ * @endcode
+ */
+struct RigidBody {
+  NodeIndex master_node; /**<Index of the node that carries the DOFs of the
+                            rigid body.*/
+  std::vector<NodeIndex>
+      slave_nodes; /**<Indices of the nodes that follow the master node.*/
+
+  /**
+   * @brief Default Constructor
+   */
+  RigidBody() : master_node(0){};
+
+  /**
+   * @brief Constructor of a rigid link.
+   * @param[in] master_node `fea::NodeIndex`. Index of the master node.
+   * @param[in] slave_node `fea::NodeIndex`. Index of the slave node.
+   */
+  RigidBody(NodeIndex _master_node, NodeIndex slave_node)
+      : master_node(_master_node), slave_nodes(1, slave_node){};
+
+  /**
+   * @brief Constructor
+   * @param[in] master_node `fea::NodeIndex`. Index of the master node.
+   * @param[in] slave_nodes `std::vector<fea::NodeIndex>`. Indices of the slave
+   * nodes.
+   */
+  RigidBody(NodeIndex _master_node, const std::vector<NodeIndex> &_slave_nodes)
+      : master_node(_master_node), slave_nodes(_slave_nodes){};
+};
+
 /**
  * @brief A linear multipoint constraint.
  * @details Equation constraints are defined by a series of terms that
@@ -300,7 +392,7 @@ struct Tie {
  * fea::Equation eqn;
  *
  * // Stipulate that the x and y displacement for the first node must be equal
- * unsigned int node_number = 0;
+ * fea::NodeIndex node_number = 0;
  * eqn.terms.push_back(fea::Equation::Term(node_number,
  * fea::DOF::DISPLACEMENT_X, 1.0));
  * eqn.terms.push_back(fea::Equation::Term(node_number,
@@ -315,8 +407,8 @@ struct Equation {
    * coefficient.
    */
   struct Term {
-    unsigned int node_number; /**<Index of the node in the node list.*/
-    unsigned int dof;         /**<Degree of freedom. @sa fea::DOF*/
+    NodeIndex node_number; /**<Index of the node in the node list.*/
+    unsigned int dof;      /**<Degree of freedom. @sa fea::DOF*/
     double coefficient; /**<Coefficient to multiply the nodal variable by.*/
 
     /**
@@ -326,13 +418,13 @@ struct Equation {
 
     /**
      * @brief Constructor
-     * @param node_number. `unsigned int`. Index of the node within the node
+     * @param node_number. `fea::NodeIndex`. Index of the node within the node
      * list.
      * @param dof. `unsigned int`. Degree of freedom for the specified node.
      * @param coefficient. `double`. coefficient to multiply the corresponding
      * nodal variable by.
      */
-    Term(unsigned int _node_number, unsigned int _dof, double _coefficient)
+    Term(NodeIndex _node_number, unsigned int _dof, double _coefficient)
         : node_number(_node_number), dof(_dof), coefficient(_coefficient){};
   };
 
@@ -356,7 +448,7 @@ struct Equation {
  * `fea::Props` struct.
  */
 struct Elem {
-  Eigen::Vector2i
+  Connectivity
       node_numbers; /**<The indices of the node list that define the element.*/
   Props props;      /**<The set of properties to associate with the element.*/
 
@@ -370,13 +462,13 @@ struct Elem {
    * @details Constructor if the node indices are passed independently. Assumes
    * 2 nodes per element.
    *
-   * @param[in] node1 unsigned int. The indices of first node associate with the
+   * @param[in] node1 NodeIndex. The indices of first node associate with the
    * element.
-   * @param[in] node2 unsigned int. The indices of second node associate with
+   * @param[in] node2 NodeIndex. The indices of second node associate with
    * the element.
    * @param[in] props Props. The element's properties.
    */
-  Elem(unsigned int node1, unsigned int node2, const Props &_props)
+  Elem(NodeIndex node1, NodeIndex node2, const Props &_props)
       : props(_props) {
     node_numbers << node1, node2;
   }
@@ -385,13 +477,31 @@ struct Elem {
 /**
  * @brief Contains a node list, element list, and the properties of each
  * element.
+ * @details Element properties are either stored per element in `props`, or as
+ * a table of unique `sections` referenced by `section_ids`. The section table
+ * is much smaller for models built from a few distinct cross-sections. In the
+ * latter case `props` is empty and element properties should be read through
+ * `getProps` and `getNormalVec`, which work for both layouts.
+ *
+ * Each member is a separate contiguous array, so node coordinates and the
+ * connectivity list can also be viewed as flat matrices through `coordinates`
+ * and `connectivity`. The constructors take their arrays by value: pass them
+ * with `std::move` to hand the storage over to the job without copying.
  */
 struct Job {
   std::vector<Node> nodes; /**<A vector of Node objects that define the mesh.*/
-  std::vector<Eigen::Vector2i> elems; /**<A 2D vector of ints that defines the
-                                         connectivity of the node list.*/
+  std::vector<Connectivity> elems; /**<A 2D vector of ints that defines the
+                                      connectivity of the node list.*/
   std::vector<Props>
       props; /**<A vector that contains the properties of each element.*/
+  std::vector<Props> sections; /**<Unique properties referenced by
+                                  `section_ids`. Only used if `props` is
+                                  empty.*/
+  std::vector<unsigned int>
+      section_ids; /**<Index into `sections` for each element.*/
+  std::vector<Eigen::Vector3d>
+      orientations; /**<Optional normal vector of each element. Overrides the
+                       `normal_vec` of the element's section if not empty.*/
 
   /**
    * @brief Default constructor
@@ -402,24 +512,121 @@ struct Job {
    * @brief Constructor
    * @details Takes an list of nodes and elements as inputs. The elements are
    * deconstructed into an array holding the connectivity list and an array
-   * holding the properties.
+   * holding the properties. Kept for compatibility, the constructors taking
+   * the connectivity and properties as separate arrays avoid the copy.
    *
    * @param[in] nodes std::vector<Node>. The node list that defines the mesh.
    * @param[in] elems std::vector<Elem>. The elements that define the mesh.
    *                  An element is defined by the connectivity list and the
    * associated properties.
    */
-  Job(const std::vector<Node> &_nodes, const std::vector<Elem> _elems)
-      : nodes(_nodes) {
-    unsigned int num_elems = _elems.size();
+  Job(std::vector<Node> _nodes, const std::vector<Elem> &_elems)
+      : nodes(std::move(_nodes)) {
+    size_t num_elems = _elems.size();
     elems.reserve(num_elems);
     props.reserve(num_elems);
 
-    for (unsigned int i = 0; i < num_elems; i++) {
+    for (size_t i = 0; i < num_elems; i++) {
       elems.push_back(_elems[i].node_numbers);
       props.push_back(_elems[i].props);
     }
   };
+
+  /**
+   * @brief Constructor
+   * @details Forms a job from separate arrays of connectivity and per-element
+   * properties.
+   *
+   * @param[in] nodes std::vector<Node>. The node list that defines the mesh.
+   * @param[in] elems std::vector<Connectivity>. Connectivity of each
+   * element.
+   * @param[in] props std::vector<Props>. Properties of each element.
+   */
+  Job(std::vector<Node> _nodes, std::vector<Connectivity> _elems,
+      std::vector<Props> _props)
+      : nodes(std::move(_nodes)), elems(std::move(_elems)),
+        props(std::move(_props)) {
+    assert(props.size() == elems.size());
+  };
+
+  /**
+   * @brief Constructor
+   * @details Forms a job that references a table of unique sections instead of
+   * storing the properties of every element.
+   *
+   * @param[in] nodes std::vector<Node>. The node list that defines the mesh.
+   * @param[in] elems std::vector<Connectivity>. Connectivity of each
+   * element.
+   * @param[in] sections std::vector<Props>. Unique element properties.
+   * @param[in] section_ids std::vector<unsigned int>. Index into `sections` for
+   * each element.
+   * @param[in] orientations std::vector<Eigen::Vector3d>. Either empty, or the
+   * normal vector of each element overriding the normal vector of its section.
+   */
+  Job(std::vector<Node> _nodes, std::vector<Connectivity> _elems,
+      std::vector<Props> _sections, std::vector<unsigned int> _section_ids,
+      std::vector<Eigen::Vector3d> _orientations =
+          std::vector<Eigen::Vector3d>())
+      : nodes(std::move(_nodes)), elems(std::move(_elems)), props(0),
+        sections(std::move(_sections)), section_ids(std::move(_section_ids)),
+        orientations(std::move(_orientations)) {
+    assert(section_ids.size() == elems.size());
+    assert(orientations.empty() || orientations.size() == elems.size());
+  };
+
+  /**
+   * @brief Returns the node coordinates as a 3 x N matrix without copying.
+   */
+  Eigen::Map<const Eigen::Matrix<double, 3, Eigen::Dynamic>>
+  coordinates() const {
+    return Eigen::Map<const Eigen::Matrix<double, 3, Eigen::Dynamic>>(
+        nodes.empty() ? nullptr : nodes[0].data(), 3, nodes.size());
+  }
+
+  /**
+   * @brief Returns the connectivity list as a 2 x N matrix without copying.
+   */
+  Eigen::Map<const Eigen::Matrix<NodeIndex, 2, Eigen::Dynamic>>
+  connectivity() const {
+    return Eigen::Map<const Eigen::Matrix<NodeIndex, 2, Eigen::Dynamic>>(
+        elems.empty() ? nullptr : elems[0].data(), 2, elems.size());
+  }
+
+  /**
+   * @brief Returns the properties of the `ith` element.
+   * @details The normal vector of the returned properties is not overridden by
+   * `orientations`. Use `getNormalVec` to obtain the element's normal vector.
+   */
+  const Props &getProps(size_t i) const {
+    return props.empty() ? sections[section_ids[i]] : props[i];
+  }
+
+  /**
+   * @brief Returns the vector normal to the `ith` element.
+   */
+  const Eigen::Vector3d &getNormalVec(size_t i) const {
+    return orientations.empty() ? getProps(i).normal_vec : orientations[i];
+  }
+};
+
+class ElementStream;
+
+/**
+ * @brief A job together with the boundary conditions, loads and constraints
+ * applied to it.
+ * @details If `element_stream` is set the elements are not held in memory:
+ * `job` only holds the nodes and the elements are read from the stream while
+ * the analysis runs, see `fea::ElementStream`.
+ */
+struct Model {
+  Job job;                 /**<Nodes, elements and element properties.*/
+  std::vector<BC> bcs;     /**<Boundary conditions.*/
+  std::vector<Force> forces; /**<Prescribed nodal forces.*/
+  std::vector<Tie> ties;   /**<Ties between nodes.*/
+  std::vector<Equation> equations; /**<Linear equation constraints.*/
+  std::vector<RigidBody> rigid_bodies; /**<Rigid bodies.*/
+  std::shared_ptr<ElementStream>
+      element_stream; /**<Source of the elements if they are streamed.*/
 };
 
 } // namespace fea
@@ -27,16 +27,26 @@
 #define CSV_PARSER_H
 
 #include <boost/format.hpp>
+#include <algorithm>
 #include <boost/tokenizer.hpp>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace fea {
     /**
      * Takes a line from the input stream and appends it to the record.
@@ -86,6 +96,65 @@ namespace fea {
         return ins;
     }
 
+    /**
+     * @brief Read-only view of the contents of a file.
+     * @details The file is memory-mapped on POSIX systems, elsewhere its contents are read into memory.
+     * Throws `std::runtime_error` if the file cannot be opened.
+     */
+    class MappedFile {
+    public:
+        /**
+         * @brief Maps the file `filename`.
+         *
+         * @param[in] filename `std::string`. The file to map.
+         */
+        explicit MappedFile(const std::string &filename);
+
+        ~MappedFile();
+
+        /**
+         * @brief Returns a pointer to the first byte of the file. The contents are not null terminated.
+         */
+        const char *data() const { return begin; }
+
+        /**
+         * @brief Returns the size of the file in bytes.
+         */
+        size_t size() const { return length; }
+
+        /**
+         * @brief Hints that the bytes before `end` will not be read again.
+         * @details The pages of the mapping that lie entirely before `end` are released, they are read from the
+         * file again if they are accessed later. Only the pages not released by the previous call are advised,
+         * unless `end` lies before them, in which case the file is taken to be read again from the start. Does
+         * nothing if the file is not mapped.
+         *
+         * @param[in] end `size_t`. Offset up to which the file has been read.
+         */
+        void release(size_t end);
+
+    private:
+        MappedFile(const MappedFile &);
+        MappedFile &operator=(const MappedFile &);
+
+        const char *begin; /**<First byte of the file.*/
+        size_t length; /**<Size of the file in bytes.*/
+        bool mapped; /**<Whether `begin` points to a memory mapping or into `buffer`.*/
+        std::vector<char> buffer; /**<Contents of the file if it is not mapped.*/
+        size_t released; /**<Number of bytes at the start of the mapping released by `release`.*/
+    };
+
+    /**
+     * @brief Splits a text buffer into chunks that start at the beginning of a line.
+     *
+     * @param[in] data `const char*`. The text to split.
+     * @param[in] size `size_t`. The number of bytes in `data`.
+     * @param[in] num_chunks `size_t`. The desired number of chunks.
+     * @return Chunk boundaries. `std::vector<size_t>`. Offsets into `data`, starting with 0 and ending with `size`.
+     * Holds fewer than `num_chunks + 1` offsets if lines are long compared to the chunk size.
+     */
+    std::vector<size_t> splitLines(const char *data, size_t size, size_t num_chunks);
+
     /**
      * @brief Reads data from a csv file into an `std::vector` and writes the contents of an `std::vector` to a file.
      * \note The parser assumes the data is comma delimited when reading data from a file.
@@ -125,8 +194,54 @@ namespace fea {
             }
         }
 
+        /**
+         * @brief Parses the contents of `filename` into a flat array.
+         * @details Much faster than `parseToVector` for large files: the file is memory-mapped and split into
+         * line-aligned chunks that are parsed concurrently if OpenMP is enabled. Numbers are converted in place
+         * without allocating and written directly into `data`. Values are separated by commas and/or whitespace,
+         * and blank lines are skipped. Integral types accept values written as floating point numbers, which are
+         * truncated as in `parseToVector`. Throws `std::runtime_error` naming the line of the first value that
+         * is not a number.
+         *
+         * @param[in] filename `std::string`. The file to parse.
+         * @param data `std::vector<T>`. Updated in place to hold the values of all rows, one row after another.
+         * @param row_offsets `std::vector<size_t>`. Updated in place to hold the offset into `data` of the first
+         * value of each row, followed by `data.size()`. Row `i` thus has `row_offsets[i + 1] - row_offsets[i]`
+         * values.
+         */
+        template<typename T>
+        void parseToArray(const std::string &filename, std::vector<T> &data, std::vector<size_t> &row_offsets);
+
+        /**
+         * @brief Parses the lines in `[first, last)` into a flat array.
+         * @details Same as `parseToArray` for a range of a buffer that starts at the beginning of a line, parsed
+         * on the calling thread. Used to read a file a bounded number of rows at a time.
+         *
+         * @param[in] first `const char*`. First character of the range.
+         * @param[in] last `const char*`. One past the last character of the range.
+         * @param data `std::vector<T>`. Updated in place to hold the values of all rows in the range.
+         * @param row_offsets `std::vector<size_t>`. Updated in place to hold the offset into `data` of the first
+         * value of each row, followed by `data.size()`.
+         * @return The index of the first line relative to `first` that contains a value that is not a number,
+         * or `std::numeric_limits<size_t>::max()` if all values were parsed.
+         */
+        template<typename T>
+        static size_t parseLines(const char *first, const char *last, std::vector<T> &data,
+                                 std::vector<size_t> &row_offsets) {
+            ChunkCount count;
+            parseChunk<T>(first, last, count, nullptr, nullptr, 0);
+            data.resize(count.values);
+            row_offsets.resize(count.rows + 1);
+            row_offsets[0] = 0;
+            ChunkCount parsed;
+            return parseChunk<T>(first, last, parsed, data.data(), row_offsets.data() + 1, 0);
+        }
+
         /**
          * Writes the 2D vector `data` to the file specified by `filename`.
+         * @details Floating point values are written in fixed notation with `precision` decimal places, exactly as
+         * `std::fixed << std::setprecision(precision)` formats them. Blocks of rows are formatted concurrently into
+         * memory if OpenMP is enabled and written to the file in large chunks.
          *
          * @param[in] filename `std::string`. The file to write data to.
          * @param[in] data `std::vector< std::vector< T > >`. Data to write to file.
@@ -138,30 +253,341 @@ namespace fea {
                    const std::vector<std::vector<T> > &data,
                    unsigned int precision,
                    const std::string &delimiter) {
+            writeRows<T>(filename, data.size(), precision, delimiter, [&data](size_t i, size_t &num_cols) {
+                num_cols = data[i].size();
+                return data[i].data();
+            });
+        }
+
+        /**
+         * Writes the `num_rows` x `num_cols` row-major array `data` to the file specified by `filename`.
+         * @details Same as above for results that are stored contiguously, which are written without copying them
+         * into a 2D vector.
+         *
+         * @param[in] filename `std::string`. The file to write data to.
+         * @param[in] data `const T*`. The values of all rows, one row after another.
+         * @param[in] num_rows `size_t`. Number of rows of `data`.
+         * @param[in] num_cols `size_t`. Number of values in each row.
+         * @param[in] precision `unsigned int`. The number of decimal places to use when writing the data to file.
+         * @param[in] demlimiter `std::string`. The delimiter to use between data entries.
+         */
+        template<typename T>
+        void write(const std::string &filename,
+                   const T *data,
+                   size_t num_rows,
+                   size_t num_cols,
+                   unsigned int precision,
+                   const std::string &delimiter) {
+            writeRows<T>(filename, num_rows, precision, delimiter, [data, num_cols](size_t i, size_t &row_size) {
+                row_size = num_cols;
+                return data + i * num_cols;
+            });
+        }
+
+        /**
+         * @brief Converts a value read as a floating point number to the integer type `T`, e.g. a node index.
+         *
+         * @param[in] value `double`. The value to convert.
+         * @param[out] out `T`. Holds `value` if the conversion succeeds and is left unchanged otherwise.
+         * @return <B>Success</B> `bool`. False if `value` is fractional or out of the range of `T`, which includes
+         * negative values for unsigned types.
+         */
+        template<typename T>
+        static bool toInteger(double value, T &out) {
+            if (!(value == std::floor(value) &&
+                  value >= static_cast<double>(std::numeric_limits<T>::min()) &&
+                  value < static_cast<double>(std::numeric_limits<T>::max()))) {
+                return false;
+            }
+            out = static_cast<T>(value);
+            return true;
+        }
+
+    private:
+        /**
+         * Writes `num_rows` rows to `filename`. `row(i, num_cols)` returns the values of row `i` and stores their
+         * number in `num_cols`.
+         */
+        template<typename T, typename RowFunction>
+        static void writeRows(const std::string &filename,
+                              size_t num_rows,
+                              unsigned int precision,
+                              const std::string &delimiter,
+                              RowFunction row) {
             std::ofstream output_file;
             output_file.open(filename);
-            size_t num_cols;
 
             if (!output_file.is_open()) {
                 throw std::runtime_error(
                         (boost::format("Error opening file %s") % filename).str()
                 );
             }
+
+            const size_t rows_per_block = 4096;
+            const size_t num_blocks = (num_rows + rows_per_block - 1) / rows_per_block;
+#ifdef _OPENMP
+            const size_t blocks_per_batch = 4 * omp_get_max_threads();
+#else
+            const size_t blocks_per_batch = 1;
+#endif
+            // format a bounded number of blocks at a time so the whole file is never held in memory
+            std::vector<std::string> blocks(std::min(num_blocks, blocks_per_batch));
+            for (size_t first_block = 0; first_block < num_blocks; first_block += blocks.size()) {
+                const long long num_batch_blocks = std::min(blocks.size(), num_blocks - first_block);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+                for (long long b = 0; b < num_batch_blocks; ++b) {
+                    const size_t first_row = (first_block + b) * rows_per_block;
+                    const size_t last_row = std::min(first_row + rows_per_block, num_rows);
+                    std::string &block = blocks[b];
+                    block.clear();
+                    for (size_t i = first_row; i < last_row; ++i) {
+                        size_t num_cols;
+                        const T *values = row(i, num_cols);
+                        for (size_t j = 0; j < num_cols; ++j) {
+                            appendValue(block, values[j], precision, std::is_floating_point<T>());
+                            if (j < num_cols - 1) {
+                                block += delimiter;
+                            }
+                        }
+                        block += '\n';
+                    }
+                }
+                for (long long b = 0; b < num_batch_blocks; ++b) {
+                    output_file.write(blocks[b].data(), blocks[b].size());
+                }
+            }
+            output_file.close();
+
+            if (!output_file) {
+                throw std::runtime_error(
+                        (boost::format("Error writing file %s") % filename).str()
+                );
+            }
+        }
+
+        /**
+         * Number of rows, values and lines in a chunk of a file.
+         */
+        struct ChunkCount {
+            ChunkCount() : rows(0), values(0), lines(0) { };
+
+            size_t rows;
+            size_t values;
+            size_t lines;
+        };
+
+        /**
+         * Appends `value` in fixed notation with `precision` decimal places to `out`.
+         */
+        template<typename T>
+        static void appendValue(std::string &out, T value, unsigned int precision, std::true_type) {
+            // snprintf produces the same digits as std::fixed without the per-value cost of the stream
+            char buffer[64];
+            const int length = std::snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(precision),
+                                             static_cast<double>(value));
+            if (length < static_cast<int>(sizeof(buffer))) {
+                out.append(buffer, length);
+            }
             else {
-                for (size_t i = 0; i < data.size(); ++i) {
-                    num_cols = data[i].size();
-                    for (size_t j = 0; j < num_cols; ++j) {
-                        output_file << std::fixed << std::setprecision(precision) << data[i][j];
-                        if (j < num_cols - 1) {
-                            output_file << delimiter;
+                std::vector<char> large_buffer(length + 1);
+                std::snprintf(large_buffer.data(), large_buffer.size(), "%.*f", static_cast<int>(precision),
+                              static_cast<double>(value));
+                out.append(large_buffer.data(), length);
+            }
+        }
+
+        /**
+         * Appends the integer `value` to `out`. The precision does not apply to integers.
+         */
+        template<typename T>
+        static void appendValue(std::string &out, T value, unsigned int, std::false_type) {
+            char buffer[24];
+            char *end = buffer + sizeof(buffer);
+            char *c = end;
+            const bool negative = value < 0;
+            unsigned long long magnitude = negative ? 0ULL - static_cast<unsigned long long>(value)
+                                                    : static_cast<unsigned long long>(value);
+            do {
+                *--c = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude > 0);
+            if (negative) {
+                *--c = '-';
+            }
+            out.append(c, end - c);
+        }
+
+        /**
+         * Calls `parse(i)` for each chunk `i` in `[0, num_chunks)` concurrently. Inside a parallel region, e.g. while
+         * `fea::runLoadTasks` loads several files, a nested parallel region would run on one thread, so the chunks
+         * become tasks that the idle threads of the enclosing team can run instead.
+         */
+        template<typename Parse>
+        static void forEachChunk(long long num_chunks, const Parse &parse) {
+#if defined(_OPENMP) && _OPENMP >= 201511
+            if (omp_in_parallel()) {
+#pragma omp taskloop grainsize(1)
+                for (long long i = 0; i < num_chunks; ++i) {
+                    parse(i);
+                }
+                return;
+            }
+#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+            for (long long i = 0; i < num_chunks; ++i) {
+                parse(i);
+            }
+        }
+
+        static bool isSeparator(char c) {
+            return c == ',' || c == ' ' || c == '\t' || c == '\r';
+        }
+
+        /**
+         * Converts the characters in `[first, last)` into a floating point number.
+         */
+        template<typename T>
+        static bool parseNumber(const char *first, const char *last, T &value, std::true_type) {
+            // the mapped file is not null terminated, so the token is copied to the stack for strtod
+            char token[64];
+            const size_t length = last - first;
+            if (length >= sizeof(token)) {
+                return false;
+            }
+            std::memcpy(token, first, length);
+            token[length] = '\0';
+            char *end;
+            value = static_cast<T>(std::strtod(token, &end));
+            return end == token + length;
+        }
+
+        /**
+         * Converts the characters in `[first, last)` into an integer. Fails if the value is fractional or negative for
+         * an unsigned `T`.
+         */
+        template<typename T>
+        static bool parseNumber(const char *first, const char *last, T &value, std::false_type) {
+            const char *c = first;
+            const bool negative = *c == '-';
+            if (*c == '-' || *c == '+') {
+                ++c;
+            }
+            unsigned long long magnitude = 0;
+            const char *digits = c;
+            while (c != last && *c >= '0' && *c <= '9') {
+                magnitude = 10 * magnitude + (*c - '0');
+                ++c;
+            }
+            if (c == last && c != digits) {
+                if (negative && std::is_unsigned<T>::value && magnitude != 0) {
+                    return false;
+                }
+                value = static_cast<T>(negative ? -static_cast<long long>(magnitude) : static_cast<long long>(magnitude));
+                return true;
+            }
+            // fall back to a floating point number, e.g. "1.0" or "1e3", which must still be an integer
+            double d;
+            if (!parseNumber(first, last, d, std::true_type())) {
+                return false;
+            }
+            return toInteger(d, value);
+        }
+
+        /**
+         * Counts the rows and values of the lines in `[first, last)` if `values` is null, otherwise parses them
+         * into `values` and stores the end offset of each row in `row_ends`. Returns the index of the first
+         * line that could not be parsed relative to `first`, or `std::numeric_limits<size_t>::max()`.
+         */
+        template<typename T>
+        static size_t parseChunk(const char *first, const char *last, ChunkCount &count, T *values,
+                                 size_t *row_ends, size_t value_offset) {
+            const char *c = first;
+            while (c != last) {
+                size_t values_in_row = 0;
+                while (c != last && *c != '\n') {
+                    if (isSeparator(*c)) {
+                        ++c;
+                        continue;
+                    }
+                    const char *token = c;
+                    while (c != last && *c != '\n' && !isSeparator(*c)) {
+                        ++c;
+                    }
+                    if (values) {
+                        if (!parseNumber(token, c, values[count.values], std::is_floating_point<T>())) {
+                            return count.lines;
                         }
                     }
-                    output_file << "\n";
+                    ++count.values;
+                    ++values_in_row;
+                }
+                if (values_in_row > 0) {
+                    if (row_ends) {
+                        row_ends[count.rows] = value_offset + count.values;
+                    }
+                    ++count.rows;
+                }
+                ++count.lines;
+                if (c != last) {
+                    ++c;
                 }
-                output_file.close();
             }
+            return std::numeric_limits<size_t>::max();
         }
     };
+
+    template<typename T>
+    void CSVParser::parseToArray(const std::string &filename, std::vector<T> &data,
+                                 std::vector<size_t> &row_offsets) {
+        const MappedFile file(filename);
+
+        // chunks of at least 1MB, a few per thread to balance uneven lines
+        size_t num_chunks = file.size() / (1 << 20) + 1;
+#ifdef _OPENMP
+        num_chunks = std::min(num_chunks, static_cast<size_t>(4 * omp_get_max_threads()));
+#else
+        num_chunks = 1;
+#endif
+        const std::vector<size_t> bounds = splitLines(file.data(), file.size(), num_chunks);
+        const long long num_bounded = bounds.size() - 1;
+
+        // [count the rows and values of each chunk to find where its values go
+        std::vector<ChunkCount> counts(num_bounded);
+        forEachChunk(num_bounded, [&](long long i) {
+            parseChunk<T>(file.data() + bounds[i], file.data() + bounds[i + 1], counts[i], nullptr, nullptr, 0);
+        });
+        std::vector<ChunkCount> starts(num_bounded + 1);
+        for (long long i = 0; i < num_bounded; ++i) {
+            starts[i + 1].rows = starts[i].rows + counts[i].rows;
+            starts[i + 1].values = starts[i].values + counts[i].values;
+            starts[i + 1].lines = starts[i].lines + counts[i].lines;
+        }
+        // ]
+
+        data.resize(starts[num_bounded].values);
+        row_offsets.resize(starts[num_bounded].rows + 1);
+        row_offsets[0] = 0;
+
+        std::vector<size_t> failed_lines(num_bounded, std::numeric_limits<size_t>::max());
+        forEachChunk(num_bounded, [&](long long i) {
+            ChunkCount count;
+            failed_lines[i] = parseChunk<T>(file.data() + bounds[i], file.data() + bounds[i + 1], count,
+                                            data.data() + starts[i].values, row_offsets.data() + starts[i].rows + 1,
+                                            starts[i].values);
+        });
+        for (long long i = 0; i < num_bounded; ++i) {
+            if (failed_lines[i] != std::numeric_limits<size_t>::max()) {
+                throw std::runtime_error(
+                        (boost::format("Error when parsing csv file %s.\nLine %d contains a value that is not a "
+                                               "number.") % filename % (starts[i].lines + failed_lines[i] + 1)).str()
+                );
+            }
+        }
+    }
 } // namespace fea
 
 #endif //CSV_PARSER_H
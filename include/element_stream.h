@@ -0,0 +1,126 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_ELEMENT_STREAM_H
+#define FEA_ELEMENT_STREAM_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "containers.h"
+#include "csv_parser.h"
+
+namespace fea {
+
+    /**
+     * @brief A block of consecutive elements read by `fea::ElementStream`.
+     */
+    struct ElementChunk {
+        size_t first; /**<Index of the first element of the chunk in the model.*/
+        std::vector<Connectivity> elems; /**<Connectivity of each element.*/
+        std::vector<Props> props; /**<Properties of each element. `normal_vec` holds the element's orientation.*/
+    };
+
+    /**
+     * @brief Reads the elements of a model from csv files a bounded number of rows at a time.
+     * @details The files are memory-mapped and parsed one chunk at a time. The pages of the rows that have been
+     * read are released, so the memory used by the input does not grow with the number of elements. The
+     * elements are read either from an "elems" file of [nn1,nn2] rows with a matching "props" file of
+     * [EA, EIz, EIy, GJ, nx, ny, nz] rows, or from an "elems" file of [nn1,nn2,section] or
+     * [nn1,nn2,section,nx,ny,nz] rows that refer to a table of sections held in memory. Throws
+     * `std::runtime_error` if a file cannot be opened or a row is malformed.
+     */
+    class ElementStream {
+    public:
+        /**
+         * @brief Streams elements with per-element properties.
+         *
+         * @param[in] elems_filename `std::string`. File of [nn1,nn2] rows.
+         * @param[in] props_filename `std::string`. File of [EA, EIz, EIy, GJ, nx, ny, nz] rows, one per element.
+         * @param[in] chunk_size `size_t`. Maximum number of elements per chunk.
+         */
+        ElementStream(const std::string &elems_filename, const std::string &props_filename, size_t chunk_size);
+
+        /**
+         * @brief Streams elements that refer to a table of sections.
+         *
+         * @param[in] elems_filename `std::string`. File of [nn1,nn2,section] or [nn1,nn2,section,nx,ny,nz] rows.
+         * @param[in] sections `std::vector<fea::Props>`. Properties referenced by the section column.
+         * @param[in] chunk_size `size_t`. Maximum number of elements per chunk.
+         */
+        ElementStream(const std::string &elems_filename, std::vector<Props> sections, size_t chunk_size);
+
+        /**
+         * @brief Reads the next chunk of elements into `chunk`.
+         *
+         * @param chunk `fea::ElementChunk`. Updated in place, its arrays are reused between calls.
+         * @return `false` if all elements have been read, `true` otherwise.
+         */
+        bool next(ElementChunk &chunk);
+
+        /**
+         * @brief Starts reading from the first element again.
+         */
+        void rewind();
+
+        /**
+         * @brief Returns the maximum number of elements per chunk.
+         */
+        size_t getChunkSize() const { return chunkSize; }
+
+        /**
+         * @brief Returns the number of elements read since the last call to `rewind`.
+         */
+        size_t getNumRead() const { return numRead; }
+
+    private:
+        ElementStream(const ElementStream &);
+        ElementStream &operator=(const ElementStream &);
+
+        /**
+         * Parses the next `num_rows` rows of `file` that start at `pos` into `data`, advancing `pos` and `line`.
+         */
+        void readRows(MappedFile &file, const std::string &variable, size_t num_rows, size_t &pos,
+                      size_t &line, std::vector<double> &data, std::vector<size_t> &row_offsets);
+
+        MappedFile elemsFile; /**<Connectivity rows.*/
+        std::unique_ptr<MappedFile> propsFile; /**<Property rows, null if `sections` are used.*/
+        std::vector<Props> sections; /**<Section table referenced by the connectivity rows.*/
+        size_t chunkSize; /**<Maximum number of elements per chunk.*/
+        size_t numRead; /**<Number of elements read since the last rewind.*/
+        size_t elemsPos; /**<Offset of the next row in `elemsFile`.*/
+        size_t elemsLine; /**<Line number of the next row in `elemsFile`.*/
+        size_t propsPos; /**<Offset of the next row in `propsFile`.*/
+        size_t propsLine; /**<Line number of the next row in `propsFile`.*/
+        std::vector<double> elemsData; /**<Values of the current chunk of connectivity rows.*/
+        std::vector<size_t> elemsOffsets; /**<Row offsets into `elemsData`.*/
+        std::vector<double> propsData; /**<Values of the current chunk of property rows.*/
+        std::vector<size_t> propsOffsets; /**<Row offsets into `propsData`.*/
+    };
+
+} // namespace fea
+
+#endif // FEA_ELEMENT_STREAM_H
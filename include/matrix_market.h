@@ -0,0 +1,67 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_MATRIX_MARKET_H
+#define FEA_MATRIX_MARKET_H
+
+#include <string>
+
+#include "threed_beam_fea.h"
+
+namespace fea {
+
+    /**
+     * @brief Writes the leading `num_rows` x `num_cols` block of a sparse matrix as a Matrix Market file.
+     * @details The file uses the "coordinate real general" format: a header line, the dimensions and number of
+     * nonzeros, then one 1-based "row col value" line per stored coefficient. Values are written with 17
+     * significant digits, so they are read back exactly. Only the stored coefficients are written, so the size
+     * of the file grows with the number of nonzeros rather than the dimensions of the matrix. Throws
+     * `std::runtime_error` if the file cannot be written.
+     *
+     * @param[in] filename `std::string`. The file to write.
+     * @param[in] matrix `fea::SparseMat`. The compressed matrix to write.
+     * @param[in] num_rows `StorageIndex`. Number of leading rows to write.
+     * @param[in] num_cols `StorageIndex`. Number of leading columns to write.
+     */
+    void writeMatrixMarket(const std::string &filename, const SparseMat &matrix, StorageIndex num_rows,
+                           StorageIndex num_cols);
+
+    /**
+     * @brief Writes a sparse matrix as a Matrix Market file.
+     * @details Same as above for the whole matrix.
+     */
+    void writeMatrixMarket(const std::string &filename, const SparseMat &matrix);
+
+    /**
+     * @brief Writes a vector as a Matrix Market file in the "array real general" format.
+     *
+     * @param[in] filename `std::string`. The file to write.
+     * @param[in] vector `fea::ForceVector`. The values to write, e.g. the right hand side of the global system.
+     */
+    void writeMatrixMarket(const std::string &filename, const ForceVector &vector);
+
+} // namespace fea
+
+#endif // FEA_MATRIX_MARKET_H
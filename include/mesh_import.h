@@ -0,0 +1,75 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_MESH_IMPORT_H
+#define FEA_MESH_IMPORT_H
+
+#include <string>
+#include <vector>
+
+#include "containers.h"
+
+namespace fea {
+
+    /**
+     * @brief Reads the nodes and line elements of a Gmsh mesh.
+     * @details Reads ASCII `.msh` files of format version 2.2 or 4.1 in a single pass over the memory-mapped
+     * file. Node tags are remapped to consecutive indices in the order the nodes appear in the file. Elements
+     * other than 2-node lines are skipped. The returned job references `sections` through the physical group of
+     * each line: if `sections` holds a single section all lines use it, otherwise a line of physical group `t`
+     * uses `sections[t - 1]`. Throws `std::runtime_error` if the file is not an ASCII Gmsh file, a line refers
+     * to a node that does not exist or to a physical group without section.
+     *
+     * @param[in] filename `std::string`. The `.msh` file to read.
+     * @param[in] sections `std::vector<fea::Props>`. Properties of the physical groups.
+     * @return The job of the mesh, without constraints or loads. `fea::Model`.
+     */
+    Model readGmsh(const std::string &filename, const std::vector<Props> &sections);
+
+    /**
+     * @brief Reads the beam model of an Abaqus input file.
+     * @details Reads the file in a single pass and supports the keywords *NODE, *ELEMENT with TYPE=B31 or B33,
+     * *NSET and *ELSET (including GENERATE), *MATERIAL with *ELASTIC, *BEAM SECTION with SECTION=RECT, CIRC or
+     * PIPE, *BEAM GENERAL SECTION with SECTION=GENERAL, *BOUNDARY (DOF ranges, ENCASTRE and PINNED) and *CLOAD.
+     * Other keywords and their data lines are skipped. Node labels are remapped to consecutive indices in the
+     * order the nodes appear in the file, and constraints and loads may refer to node labels or node sets. The
+     * local 1-direction of a beam section becomes the normal vector of its elements, so `EIy` holds the stiffness
+     * about the 1-direction and `EIz` the stiffness about the 2-direction. Throws `std::runtime_error` naming the
+     * line of any unsupported element type, section or malformed data line, and if an element has no section.
+     *
+     * @param[in] filename `std::string`. The `.inp` file to read.
+     * @return The job with the boundary conditions and concentrated loads of the file. `fea::Model`.
+     */
+    Model readAbaqus(const std::string &filename);
+
+    /**
+     * @brief Reads a Gmsh `.msh` or Abaqus `.inp` file depending on the extension of `filename`.
+     * @details `sections` is only used by Gmsh meshes. Throws `std::runtime_error` for other extensions.
+     */
+    Model readMesh(const std::string &filename, const std::vector<Props> &sections);
+
+} // namespace fea
+
+#endif // FEA_MESH_IMPORT_H
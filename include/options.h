@@ -28,7 +28,30 @@
 
 #include <string>
 
+#include "analysis_types.h"
+
 namespace fea {
+
+/**
+ * @brief File format used to save the results requested in `fea::Options`.
+ */
+enum ResultFormat {
+  /**
+   * Delimited text written with `csv_delimiter` and `csv_precision`.
+   */
+  CSV_RESULTS,
+
+  /**
+   * Little-endian float64 array in row-major order after a 64 byte header. See
+   * `fea::writeRawBinary`.
+   */
+  RAW_BINARY_RESULTS,
+
+  /**
+   * NumPy `.npy` file holding a float64 array. See `fea::writeNpy`.
+   */
+  NPY_RESULTS
+};
 /**
  * @brief Provides a method for customizing the finite element analysis.
  */
@@ -47,14 +70,32 @@ struct Options {
 
     save_nodal_displacements = false;
     save_nodal_forces = false;
+    save_elemental_forces = false;
     save_tie_forces = false;
     verbose = false;
     save_report = false;
+    save_vtu = false;
+    save_global_system = false;
+    compute_nodal_forces = true;
+    compute_tie_forces = true;
+    compute_element_forces = true;
+    result_format = CSV_RESULTS;
+
+    analysis_type = FRAME_3D;
+
+    cache_element_matrices = false;
+    element_cache_tolerance = 1e-12;
+
+    merge_coincident_nodes = false;
+    coincident_node_tolerance = 1e-9;
 
     nodal_displacements_filename = "nodal_displacements.csv";
     nodal_forces_filename = "nodal_forces.csv";
+    elemental_forces_filename = "elemental_forces.csv";
     tie_forces_filename = "tie_forces.csv";
     report_filename = "report.txt";
+    vtu_filename = "results.vtu";
+    global_system_prefix = "global_system";
   }
 
   /**
@@ -120,6 +161,97 @@ struct Options {
    */
   bool save_report;
 
+  /**
+   * Specifies if the mesh and results should be saved as a VTK unstructured
+   * grid for visualization. Default = `false`. If `true` the nodal
+   * displacements, nodal forces and elemental forces are written to the binary
+   * `.vtu` file indicated by `vtu_filename`, see `fea::writeVTU`.
+   */
+  bool save_vtu;
+
+  /**
+   * Specifies if the assembled global system should be saved as Matrix Market
+   * files, e.g. to benchmark external solvers. Default = `false`. If `true`
+   * the stiffness matrix without constraints, the full matrix including the
+   * Lagrange multipliers of boundary conditions and equations, and the right
+   * hand side are written to `<global_system_prefix>_KgNoBC.mtx`,
+   * `<global_system_prefix>_Kg.mtx` and `<global_system_prefix>_rhs.mtx`. The
+   * systems of independent parts of the model are saved with the suffix
+   * `_component<index>` added to the prefix. See `fea::writeMatrixMarket`.
+   */
+  bool save_global_system;
+
+  /**
+   * Specifies if the nodal forces should be computed and stored in
+   * `fea::Summary::nodal_forces`. Default = `true`. If `false` and
+   * `save_nodal_forces == false` the nodal forces are neither computed nor
+   * allocated, and the summary holds an empty array.
+   */
+  bool compute_nodal_forces;
+
+  /**
+   * Specifies if the tie forces should be computed and stored in
+   * `fea::Summary::tie_forces`. Default = `true`. If `false` and
+   * `save_tie_forces == false` the tie forces are neither computed nor
+   * allocated.
+   */
+  bool compute_tie_forces;
+
+  /**
+   * Specifies if the elemental forces should be computed and stored in
+   * `fea::Summary::element_forces`. Default = `true`. If `false` and
+   * `save_elemental_forces == false` the elemental forces are not computed,
+   * the force operators of the elements are not kept during assembly, and
+   * streamed elements are not read again after assembly. A `.vtu` file saved
+   * with `save_vtu` then holds no elemental forces.
+   */
+  bool compute_element_forces;
+
+  /**
+   * File format of the saved nodal displacements, nodal forces, tie forces and
+   * elemental forces. Default = `fea::CSV_RESULTS`. The binary formats store
+   * every value at full precision and are read back without parsing. The file
+   * names are used as given, so choose extensions that match the format.
+   */
+  ResultFormat result_format;
+  /**
+   * Element formulation and degrees of freedom per node of the analysis.
+   * Default = `fea::FRAME_3D`. Planar frames and trusses store fewer DOFs per
+   * node in the global system and do not require boundary conditions on the
+   * unused DOFs. See `fea::AnalysisType`.
+   */
+  AnalysisType analysis_type;
+
+  /**
+   * Specifies if geometrically identical elements with the same properties
+   * should share one elemental stiffness matrix and force operator during
+   * assembly. Default = `false`. Useful for regular lattices where most
+   * elements differ only by their position.
+   */
+  bool cache_element_matrices;
+
+  /**
+   * Quantization tolerance used to decide if two elements are identical when
+   * `cache_element_matrices == true`. Lengths and section values are compared
+   * relative to their magnitude, unit vectors absolutely. Default = `1e-12`.
+   */
+  double element_cache_tolerance;
+
+  /**
+   * Specifies if nodes closer than `coincident_node_tolerance` should be
+   * merged before assembly. Default = `false`. Duplicate nodes are condensed
+   * into the node of lowest index as if joined by a `fea::RigidBody`, so they
+   * do not need to be glued with ties. Nodes of user-supplied rigid bodies are
+   * not merged.
+   */
+  bool merge_coincident_nodes;
+
+  /**
+   * Distance below which nodes are merged when `merge_coincident_nodes ==
+   * true`. Default = `1e-9`.
+   */
+  double coincident_node_tolerance;
+
   /**
    * File name to save the nodal displacements to when `save_nodal_displacements
    * == true`.
@@ -145,6 +277,17 @@ struct Options {
    * File name to save the nodal forces to when `save_report == true`.
    */
   std::string report_filename;
+
+  /**
+   * File name to save the mesh and results to when `save_vtu == true`.
+   */
+  std::string vtu_filename;
+
+  /**
+   * Prefix of the files the global system is saved to when
+   * `save_global_system == true`.
+   */
+  std::string global_system_prefix;
 };
 
 } // namespace fea
@@ -26,9 +26,16 @@
 #ifndef FEA_SETUP_H
 #define FEA_SETUP_H
 
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "binary_job.h"
 #include "containers.h"
 #include "csv_parser.h"
+#include "element_stream.h"
 #include "options.h"
+#include "summary.h"
 #include <rapidjson/document.h>
 #include <rapidjson/filereadstream.h>
 
@@ -38,12 +45,37 @@ namespace fea {
      * Opens the specified json file and parses the data into a rapidjson::Document and returns the result.
      * The config document should have key's "nodes", "elems", and "props". Optionally, there can be keys
      * "bcs" for boundary conditions, "forces" for prescribed forces, and "ties" for and tie constraints between nodes.
+     * Each of these keys either names a file or holds the data inline as an array of rows, e.g.
+     * `"nodes" : [[0, 0, 0], [1, 0, 0]]`. Throws `std::runtime_error` if the file is not valid JSON.
      *
      * @param config_filename `std::string`. The location of the configuration json file.
      * @return Document`rapidjson::Document`
      */
     rapidjson::Document parseJSONConfig(const std::string &config_filename);
 
+    /**
+     * An input file to load, named after its key in the configuration document.
+     */
+    struct LoadTask {
+        LoadTask(const std::string &_name, const std::function<void()> &_load) : name(_name), load(_load) { };
+
+        std::string name;
+        std::function<void()> load;
+    };
+
+    /**
+     * Runs the `tasks` concurrently if OpenMP is enabled and stores the time each task took in `load_times`. Each
+     * task is an OpenMP task of a single parallel region, so the threads that are not busy loading a file help to
+     * parse the chunks of the others, see `fea::CSVParser::parseToArray`. A model held in one large file is still
+     * parsed by all threads. Once all tasks finished, the error of the first task that failed is rethrown.
+     *
+     * @param tasks `std::vector<fea::LoadTask>`. The files to load.
+     * @param load_times `std::vector<std::pair<std::string, long long> >`. Updated in place with the name and the
+     *                   time in milliseconds of each task.
+     */
+    void runLoadTasks(const std::vector<LoadTask> &tasks,
+                      std::vector<std::pair<std::string, long long> > &load_times);
+
     /**
      * Parses the file indicated by the "nodes" key in `config_doc` into a vector of `fea::Node`'s.
      *
@@ -52,8 +84,19 @@ namespace fea {
      */
     std::vector<Node> createNodeVecFromJSON(const rapidjson::Document &config_doc);
 
+    /**
+     * Parses the file indicated by the "sections" key in `config_doc` into a vector of `fea::Props`. Each row
+     * holds one unique set of properties `[EA, EIz, EIy, GJ, nx, ny, nz]`.
+     *
+     * @param config_doc `rapidjson::Document`. Document storing the file name containing the section table.
+     * @return Sections. `std::vector<Props>`.
+     */
+    std::vector<Props> createSectionVecFromJSON(const rapidjson::Document &config_doc);
+
     /**
      * Parses the files indicated by the "elems" and "props" keys in `config_doc` into a vector of `fea::Elem`'s.
+     * If `config_doc` has a "sections" key, each row of "elems" instead specifies `[nn1, nn2, section]` or
+     * `[nn1, nn2, section, nx, ny, nz]` and the section table is expanded into per-element properties.
      *
      * @param config_doc `rapidjson::Document`. Document storing the file names of the csv files that contain
      *                    the node number designations for each element and elemental properties.
@@ -93,9 +136,21 @@ namespace fea {
      */
     std::vector<Equation> createEquationVecFromJSON(const rapidjson::Document &config_doc);
 
+    /**
+     * Parses the file indicated by the "rigid_bodies" key in `config_doc` into a vector of `fea::RigidBody`'s.
+     * Each row holds `[master node, slave node 1, slave node 2, ...]`.
+     *
+     * @param config_doc `rapidjson::Document`. Document storing the file name containing the rigid bodies.
+     * @return Rigid bodies. `std::vector<RigidBody>`.
+     */
+    std::vector<RigidBody> createRigidBodyVecFromJSON(const rapidjson::Document &config_doc);
+
     /**
      * Creates vectors of `fea::Node`'s and `fea::Elem`'s from the files specified in `config_doc`. A
-     * `fea::Job` is created from the node and element vectors and returned.
+     * `fea::Job` is created from the node and element vectors and returned. If `config_doc` has a "sections"
+     * key the job references the section table instead of storing properties for every element. The files are
+     * loaded concurrently, see `fea::runLoadTasks`. If `config_doc` has a "mesh" key the job is read from the Gmsh
+     * or Abaqus file it names instead, see `fea::readMesh`.
      *
      * @param config_doc `rapidjson::Document`. Document storing the file name containing the
      *                    nodes, elements, and properties.
@@ -103,6 +158,32 @@ namespace fea {
      */
     Job createJobFromJSON(const rapidjson::Document &config_doc);
 
+    /**
+     * Creates the job together with its boundary conditions, loads and constraints. If `config_doc` has a
+     * "binary_job" key the model is read from the binary job file it names, see `fea::readBinaryJob`. Otherwise the
+     * job is created as in `fea::createJobFromJSON` and the optional "bcs", "forces", "ties", "equations" and
+     * "rigid_bodies" files are parsed. All files are loaded concurrently, see `fea::runLoadTasks`. If `config_doc` has
+     * an "element_chunk_size" key the elements are not loaded: "elems" and "props" must name csv files, which are
+     * read by `model.element_stream` that many rows at a time while the analysis runs. If `config_doc` has a
+     * "mesh" key the job, and the constraints and loads of an Abaqus file, are read from the mesh file it names;
+     * the "bcs" and "forces" files are appended to those of the mesh.
+     *
+     * @param config_doc `rapidjson::Document`. Document storing the file names of the model.
+     * @return Model. `fea::Model`.
+     */
+    Model createModelFromJSON(const rapidjson::Document &config_doc);
+
+    /**
+     * Same as above, but also stores the time taken to load each file in `load_summary.file_load_times_in_ms`
+     * and the total in `load_summary.input_load_time_in_ms`. Pass `load_summary` to `fea::solve` to include the
+     * times in the summary of the analysis.
+     *
+     * @param config_doc `rapidjson::Document`. Document storing the file names of the model.
+     * @param load_summary `fea::Summary`. Updated in place with the load times.
+     * @return Model. `fea::Model`.
+     */
+    Model createModelFromJSON(const rapidjson::Document &config_doc, Summary &load_summary);
+
     /**
      * Creates an `fea::Options` object from the configuration document. Any options provided will override the
      * defaults.
@@ -26,11 +26,48 @@
 #ifndef THREEDBEAMFEA_SUMMARY_H
 #define THREEDBEAMFEA_SUMMARY_H
 
+#include <Eigen/Core>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace fea {
 
+/**
+ * @brief Results of each node or tie, one row of 6 values per node or tie.
+ * @details Rows are stored one after another in a single allocation, so
+ * `data()` is a row-major array that can be handed to other code without
+ * copying.
+ */
+typedef Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor>
+    NodalResults;
+
+/**
+ * @brief End forces of each element, one row of 12 values per element.
+ * @details Stored contiguously in row-major order like `fea::NodalResults`.
+ */
+typedef Eigen::Matrix<double, Eigen::Dynamic, 12, Eigen::RowMajor>
+    ElementResults;
+
+/**
+ * @brief Copies a result array into a vector holding one vector per row.
+ * @details Only needed by code that expects the nested form; the result
+ * arrays of `fea::Summary` can be indexed with `results(row, col)` and their
+ * rows viewed with `results.row(row)` without copying.
+ */
+template <typename Derived>
+std::vector<std::vector<double>>
+toNestedVectors(const Eigen::DenseBase<Derived> &results) {
+  std::vector<std::vector<double>> nested(results.rows());
+  for (Eigen::Index i = 0; i < results.rows(); ++i) {
+    nested[i].resize(results.cols());
+    for (Eigen::Index j = 0; j < results.cols(); ++j) {
+      nested[i][j] = results(i, j);
+    }
+  }
+  return nested;
+}
+
 /**
  * @brief Contains the results of an analysis after calling `fea::solve`.
  */
@@ -51,6 +88,20 @@ struct Summary {
    */
   long long total_time_in_ms;
 
+  /**
+   * The time it took to load all input files. Only set if the model was loaded
+   * with `fea::createModelFromJSON` and passed to `fea::solve`.
+   */
+  long long input_load_time_in_ms;
+
+  /**
+   * The time it took to load each input file, keyed by the member of the
+   * configuration document that names the file. The files are loaded
+   * concurrently, so the times may add up to more than
+   * `input_load_time_in_ms`.
+   */
+  std::vector<std::pair<std::string, long long>> file_load_times_in_ms;
+
   /**
    * The time it took to assemble the global stiffness matrix.
    */
@@ -120,38 +171,44 @@ struct Summary {
    */
   unsigned long num_eqns;
 
+  /**
+   * The number of disconnected parts of the model, each of which was solved
+   * as a separate system.
+   */
+  unsigned long num_components;
+
   /**
    * The resultant nodal displacement from the FE analysis.
-   * `nodal_displacements` is a 2D vector where each row
+   * `nodal_displacements` is a contiguous array where each row
    * correspond to a node, and the columns correspond to
    * `[d_x, d_y, d_z, theta_x, theta_y, theta_z]`
    */
-  std::vector<std::vector<double>> nodal_displacements;
+  NodalResults nodal_displacements;
 
   /**
    * The resultant nodal forces from the FE analysis.
-   * `nodal_displacements` is a 2D vector where each row
+   * `nodal_forces` is a contiguous array where each row
    * correspond to a node, and the columns correspond to
    * `[f_x, f_y, f_z, m_x, m_y, m_z]`
    */
-  std::vector<std::vector<double>> nodal_forces;
+  NodalResults nodal_forces;
 
   /**
    * The resultant forces associated with ties between nodes.
-   * `tie_forces` is a 2D vector where each row
+   * `tie_forces` is a contiguous array where each row
    * correspond to a tie, and the columns correspond to
    * `[f_x, f_y, f_z, f_rot_x, f_rot_y, f_rot_z]`
    */
-  std::vector<std::vector<double>> tie_forces;
+  NodalResults tie_forces;
 
   /**
    * The resultant forces associated each element.
-   * `element_forces` is a 2D vector where each row
+   * `element_forces` is a contiguous array where each row
    * correspond to an element, and the columns correspond to
    * `[f1_x, f1_y, f1_z, f1_rot_x, f1_rot_y, f1_rot_z,
    * f2_x, f2_y, f2_z, f2_rot_x, f2_rot_y, f2_rot_z]`
    */
-  std::vector<std::vector<double>> element_forces;
+  ElementResults element_forces;
 };
 
 } // namespace fea
@@ -44,9 +44,13 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <Eigen/SparseCore>
+#include <array>
+#include <unordered_map>
 
+#include "analysis_types.h"
 #include "containers.h"
 #include "csv_parser.h"
+#include "element_stream.h"
 #include "options.h"
 #include "summary.h"
 
@@ -73,7 +77,12 @@ typedef Eigen::Matrix<double, Eigen::Dynamic, 1> ForceVector;
 /**
  * Sparse matrix that is used internally to hold the global stiffness matrix
  */
-typedef Eigen::SparseMatrix<double> SparseMat;
+typedef Eigen::SparseMatrix<double, Eigen::ColMajor, StorageIndex> SparseMat;
+
+/**
+ * A coefficient of the global stiffness matrix in the form (i, j, value)
+ */
+typedef Eigen::Triplet<double, StorageIndex> Triplet;
 
 /**
  * A 3x3 rotation matrix.
@@ -92,21 +101,178 @@ using RotationMatrix = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
  */
 inline double norm(const Node &n1, const Node &n2);
 
+/**
+ * @brief Key identifying elements whose elemental matrices are identical.
+ * @details Built from the element length, the unit vector along the element,
+ * the unit normal vector and the section values. Lengths and section values
+ * are quantized relative to their magnitude, unit vectors are quantized
+ * absolutely, both using the tolerance supplied to `makeElemMatrixKey`.
+ */
+typedef std::array<long long, 16> ElemMatrixKey;
+
+/**
+ * @brief Hash functor for `fea::ElemMatrixKey`.
+ */
+struct ElemMatrixKeyHash {
+  size_t operator()(const ElemMatrixKey &key) const;
+};
+
+/**
+ * @brief Index of a distinct elemental matrix among those computed during
+ * assembly. Independent of `fea::NodeIndex`, since the number of distinct
+ * matrices is bounded by the number of elements rather than of nodes.
+ */
+typedef size_t ElemMatrixIndex;
+
+/**
+ * @brief Computes the cache key of the `ith` element of `job`.
+ *
+ * @param[in] i `size_t`. Index of the element.
+ * @param[in] job `fea::Job`. Job containing the element.
+ * @param[in] tolerance `double`. Quantization tolerance. Elements whose
+ * geometry and section values agree to within roughly this relative amount
+ * share the same key.
+ * @return <B>Key</B> `fea::ElemMatrixKey`.
+ */
+ElemMatrixKey makeElemMatrixKey(size_t i, const Job &job,
+                                double tolerance);
+
+/**
+ * @brief Maps the nodal DOFs of a job onto the unknowns of the global system.
+ * @details Without rigid bodies every node owns `Config::NUM_DOFS` consecutive
+ * unknowns. The slave nodes of a `fea::RigidBody` do not own any unknowns:
+ * their DOFs are condensed into those of the master node, so that each nodal
+ * DOF of a slave is a linear combination of at most `MAX_TERMS` unknowns of
+ * the master node. Element matrices, ties, boundary conditions, equations and
+ * forces are transformed accordingly when they are loaded.
+ *
+ * Analyses without rotational DOFs (see `fea::Truss3D`) only carry the
+ * translation of the master node over to its slaves.
+ */
+template <typename Config> class DofMap {
+
+public:
+  /**
+   * The maximum number of unknowns a single nodal DOF depends on.
+   */
+  static const unsigned int MAX_TERMS = 3;
+
+  /**
+   * @brief Constructor of the map of a job without rigid bodies.
+   *
+   * @param[in] num_nodes `size_t`. The number of nodes in the job.
+   */
+  explicit DofMap(size_t num_nodes) : numDofNodes(num_nodes){};
+
+  /**
+   * @brief Constructor
+   * @details Throws `std::runtime_error` if a node index is out of range, a
+   * node is the slave of more than one rigid body, or the master node of a
+   * rigid body is the slave of another.
+   *
+   * @param[in] job `fea::Job`. Job providing the nodal coordinates.
+   * @param[in] rigid_bodies `std::vector<fea::RigidBody>`. Rigid bodies whose
+   * slave nodes are condensed into their master nodes.
+   */
+  DofMap(const Job &job, const std::vector<RigidBody> &rigid_bodies);
+
+  /**
+   * @brief Returns the number of unknowns, excluding Lagrange multipliers.
+   */
+  size_t getNumDofs() const { return Config::NUM_DOFS * numDofNodes; }
+
+  /**
+   * @brief Returns `true` if `node` is the slave of a rigid body.
+   */
+  bool isSlave(NodeIndex node) const {
+    return !masterNodes.empty() && masterNodes[node] != node;
+  }
+
+  /**
+   * @brief Returns the index of the first unknown owned by `node`, i.e. the
+   * first unknown of its master node for slave nodes.
+   */
+  size_t getDofIndex(NodeIndex node) const {
+    return Config::NUM_DOFS *
+           static_cast<size_t>(dofNodes.empty() ? node : dofNodes[node]);
+  }
+
+  /**
+   * @brief Expresses a nodal DOF in terms of the unknowns of the global system.
+   * @details The DOF equals the sum of `coefficients[k]` times unknown
+   * `indices[k]` over the returned number of terms. Returns 0 if `dof` is not
+   * active in `Config`.
+   *
+   * @param[in] node `fea::NodeIndex`. Index of the node.
+   * @param[in] dof `unsigned int`. Degree of freedom (see `fea::DOF`).
+   * @param[out] indices `fea::StorageIndex[MAX_TERMS]`. Indices of the
+   * unknowns.
+   * @param[out] coefficients `double[MAX_TERMS]`. Coefficients of the unknowns.
+   * @return <B>Number of terms</B> `unsigned int`.
+   */
+  unsigned int expand(NodeIndex node, unsigned int dof, StorageIndex *indices,
+                      double *coefficients) const;
+
+private:
+  size_t numDofNodes;
+  /**<Number of nodes that own unknowns.*/
+  std::vector<NodeIndex> dofNodes;
+  /**<[i] is the position among the nodes owning unknowns of node i or of its
+   * master node. Empty without rigid bodies.*/
+  std::vector<NodeIndex> masterNodes;
+  /**<[i] is the master node of node i, or i if node i is not a slave. Empty
+   * without rigid bodies.*/
+  std::vector<Eigen::Vector3d> offsets;
+  /**<[i] is the position of node i relative to its master node. Empty without
+   * rigid bodies.*/
+};
+
 /**
  * @brief Assembles the global stiffness matrix.
+ * @details Optionally caches elemental matrices so that geometrically
+ * identical elements with the same properties, as found in regular lattices,
+ * share a single elemental stiffness matrix and force operator instead of
+ * recomputing and storing one per element.
+ *
+ * Elemental matrices are always formed in the 12x12 layout of the 3D frame
+ * element. `Config` (see analysis_types.h) selects the element formulation and
+ * which nodal DOFs are scattered into the global system, which holds
+ * `Config::NUM_DOFS` DOFs per node.
  */
-class GlobalStiffAssembler {
+template <typename Config> class BasicGlobalStiffAssembler {
 
 public:
   /**
    * @brief Default constructor.
+   * @details Initializes all entries in member matrices to 0.0. Elemental
+   * matrix caching is disabled.
+   */
+  BasicGlobalStiffAssembler() : BasicGlobalStiffAssembler(false, 1e-12){};
+
+  /**
+   * @brief Constructor
    * @details Initializes all entries in member matrices to 0.0.
+   *
+   * @param[in] cache_elem_matrices `bool`. If `true` elements that share the
+   * same `fea::ElemMatrixKey` reuse one elemental stiffness matrix and force
+   * operator.
+   * @param[in] cache_tolerance `double`. Quantization tolerance passed to
+   * `fea::makeElemMatrixKey`.
+   * @param[in] keep_force_operators `bool`. If `false` and elemental matrices
+   * are not cached, the force operator of each element is not stored during
+   * assembly, which saves 1152 bytes per element when element forces are not
+   * needed. `getKlocalAelem(i)` may then not be called.
    */
-  GlobalStiffAssembler() {
+  BasicGlobalStiffAssembler(bool cache_elem_matrices, double cache_tolerance,
+                            bool keep_force_operators = true)
+      : cacheElemMatrices(cache_elem_matrices),
+        cacheTolerance(cache_tolerance),
+        keepForceOperators(keep_force_operators) {
     Kelem.setZero();
     Klocal.setZero();
     Aelem.setZero();
     AelemT.setZero();
+    KlocalAelem.setZero();
     SparseKelem.resize(12, 12);
     SparseKelem.reserve(40);
   };
@@ -128,15 +294,90 @@ public:
    */
   void operator()(SparseMat &Kg, const Job &job, const std::vector<Tie> &ties);
 
+  /**
+   * @brief Assembles the global stiffness matrix of a job with rigid bodies.
+   * @details Same as above, except that the rows and columns of the elemental
+   * stiffness matrices and ties are mapped onto the unknowns by `dof_map`.
+   * Elemental matrices of elements attached to slave nodes are transformed
+   * into the DOFs of the master nodes.
+   *
+   * @param[in] dof_map `fea::DofMap`. Maps nodal DOFs onto the unknowns of
+   * `Kg`.
+   */
+  void operator()(SparseMat &Kg, const Job &job, const std::vector<Tie> &ties,
+                  const DofMap<Config> &dof_map);
+
+  /**
+   * @brief Assembles the global system including boundary conditions and
+   * equations.
+   * @details Same as above, except that the border coefficients of the
+   * Lagrange multipliers of `BCs` and `equations` are assembled together with
+   * the elemental stiffness matrices and ties, so `Kg` is formed from a single
+   * set of triplets. Assumes `Kg` has `dof_map.getNumDofs() + BCs.size() +
+   * equations.size()` rows and columns.
+   *
+   * @param force_vec `fea::ForceVector`. Right hand side of the global
+   * system. The values of the boundary conditions are stored.
+   * @param[in] BCs `std::vector<fea::BC>`. Boundary conditions, see
+   * `fea::loadBCs`.
+   * @param[in] equations `std::vector<fea::Equation>`. Equation constraints,
+   * see `fea::loadEquations`.
+   */
+  void operator()(SparseMat &Kg, ForceVector &force_vec, const Job &job,
+                  const std::vector<Tie> &ties, const std::vector<BC> &BCs,
+                  const std::vector<Equation> &equations,
+                  const DofMap<Config> &dof_map);
+
+  /**
+   * @brief Assembles the global system from elements read in chunks.
+   * @details Same as above, except that the elements are read from
+   * `elements` one chunk at a time. A first pass over the stream counts the
+   * coefficients of each column of `Kg`, which is then allocated once, and a
+   * second pass adds the contributions of each chunk in place before the next
+   * chunk is read, so neither the elements nor their coefficients are held in
+   * memory at once. The force operators of the
+   * elements are not kept: use `calcKelem` and `getKlocalAelem()` to recover
+   * element forces from another pass over the stream. Elemental matrix
+   * caching does not apply. Throws `std::runtime_error` if an element refers
+   * to a node that does not exist.
+   *
+   * @param[in] nodes `std::vector<fea::Node>`. The nodes of the mesh.
+   * @param elements `fea::ElementStream`. Source of the elements, read from
+   * the first element.
+   */
+  void operator()(SparseMat &Kg, ForceVector &force_vec,
+                  const std::vector<Node> &nodes, ElementStream &elements,
+                  const std::vector<Tie> &ties, const std::vector<BC> &BCs,
+                  const std::vector<Equation> &equations,
+                  const DofMap<Config> &dof_map);
+
   /**
    * @brief Updates the elemental stiffness matrix for the `ith` element.
+   * @details Also updates the force operator returned by `getKlocalAelem()`.
+   * Truss configurations only keep the axial terms of the local stiffness
+   * matrix. Planar configurations ignore the normal vector of the element and
+   * align the local z-axis with the global z-axis.
    *
-   * @param[in] i `unsigned int`. Specifies the ith element for which the
+   * @param[in] i `size_t`. Specifies the ith element for which the
    * elemental stiffness matrix is calculated.
    * @param[in] job `Job`. Current `fea::Job` to analyze contains node, element,
    * and property lists.
    */
-  void calcKelem(unsigned int i, const Job &job);
+  void calcKelem(size_t i, const Job &job);
+
+  /**
+   * @brief Updates the elemental stiffness matrix for an element given by its
+   * nodes and properties.
+   * @details Same as above for an element that is not part of a `fea::Job`,
+   * e.g. one read from a `fea::ElementStream`.
+   *
+   * @param[in] n1 `fea::Node`. First node of the element.
+   * @param[in] n2 `fea::Node`. Second node of the element.
+   * @param[in] props `fea::Props`. Properties of the element.
+   * @param[in] normal_vec `Eigen::Vector3d`. Vector normal to the element.
+   */
+  void calcKelem(const Node &n1, const Node &n2, const Props &props,
+                 const Eigen::Vector3d &normal_vec);
 
   /**
    * @brief Updates the rotation and transposed rotation matrices.
@@ -162,9 +403,52 @@ public:
    */
   LocalMatrix getAelem() { return Aelem; }
 
+  /**
+   * @brief Returns the force operator of the `ith` element after assembly.
+   * @details The force operator is the local stiffness matrix times the
+   * rotation matrix and maps the element's global nodal displacements to its
+   * end forces in local coordinates.
+   *
+   * @param[in] i `size_t`. Index of the element.
+   * @return <B>Force operator</B> `fea::LocalMatrix`.
+   */
+  const LocalMatrix &getKlocalAelem(size_t i) const {
+    return uniqueKlocalAelem[perElemKlocalAelemIdx[i]];
+  }
+
+  /**
+   * @brief Returns the force operator of the element last passed to
+   * `calcKelem`.
+   */
+  const LocalMatrix &getKlocalAelem() const { return KlocalAelem; }
+
+  /**
+   * @brief Returns a copy of the force operator of every element.
+   * @details Prefer `getKlocalAelem(i)`, which does not expand shared
+   * operators when elemental matrix caching is enabled.
+   */
   std::vector<LocalMatrix> getPerElemKlocalAelem() const;
 
+  /**
+   * @brief Returns the number of distinct elemental matrices computed during
+   * the last assembly.
+   */
+  size_t getNumUniqueElemMatrices() const { return uniqueKlocalAelem.size(); }
+
 private:
+  /**
+   * Appends the coefficients of `Kelem` for the element between the nodes
+   * `nn1` and `nn2` to `triplets`.
+   */
+  void scatterKelem(std::vector<Triplet> &triplets, NodeIndex nn1,
+                    NodeIndex nn2, const DofMap<Config> &dof_map);
+
+  bool cacheElemMatrices;
+  /**<If `true` elements with matching keys share elemental matrices.*/
+  double cacheTolerance;
+  /**<Quantization tolerance used to form elemental matrix keys.*/
+  bool keepForceOperators;
+  /**<If `false` uncached force operators are not stored.*/
   LocalMatrix Kelem;
   /**<Elemental stiffness matrix in global coordinate system.*/
   LocalMatrix Klocal;
@@ -175,39 +459,75 @@ private:
    * (`Kelem`).*/
   LocalMatrix AelemT;
   /**<Transposed rotation matrix.*/
+  LocalMatrix KlocalAelem;
+  /**<Local stiffness matrix times the rotation matrix of the current
+   * element.*/
   SparseMat
       SparseKelem; /**<Sparse representation of elemental stiffness matrix.*/
 
   std::vector<LocalMatrix>
-      perElemKlocalAelem; //[i] holds the local stiffness matrix of the ith beam
-                          // element times the transformation matrix from local
-                          // to global. This is used after the simulation in
-                          // order to find the per element forces
+      uniqueKlocalAelem; // distinct force operators, i.e. the local stiffness
+                         // matrix of a beam element times the transformation
+                         // matrix from local to global. Used after the
+                         // simulation in order to find the per element forces
+  std::vector<ElemMatrixIndex>
+      perElemKlocalAelemIdx; //[i] is the index into uniqueKlocalAelem of the
+                             // force operator of the ith beam element
+  std::vector<LocalMatrix>
+      uniqueKelem; // global elemental stiffness matrices shared through the
+                   // cache, parallel to uniqueKlocalAelem
 };
 
 /**
- * @brief Loads the boundary conditions into the global stiffness matrix and
- * force vector.
+ * Assembler of the 3D frame analysis.
+ */
+typedef BasicGlobalStiffAssembler<Frame3D> GlobalStiffAssembler;
+
+/**
+ * @brief Loads the boundary conditions into the set of triplets that will
+ * become the global stiffness matrix and into the force vector.
  * @details Boundary conditions are enforced via Lagrange multipliers. The
  * reaction force due to imposing the boundary condition will be appended
  * directly onto the returned nodal displacements in the order the boundary
- * conditions were specified.
+ * conditions were specified. Every boundary condition must act on a DOF that
+ * is active in `Config`.
  *
- * @param Kg `fea::GlobalStiffnessMatrix`. Coefficients are modified in place to
- * reflect Lagrange multipliers. Assumes `Kg` has the correct dimensions.
+ * @param triplets `std::vector<fea::Triplet>`. Border coefficients reflecting
+ * the Lagrange multipliers are appended.
  * @param force_vec `fea::ForceVector`. Right hand side of the \f$[K][Q]=[F]\f$
  * equation of the FE analysis.
  * @param[in] BCs `std::vector<fea::BC>`. Vector of `BC`'s to apply to the
  * current analysis.
- * @param[in] num_nodes `unsigned int`. The number of nodes in the current job
- * being analyzed. Used to calculate the position to insert border coefficients
+ * @param[in] dof_map `fea::DofMap`. Maps nodal DOFs onto the unknowns of
+ * the global system. Used to calculate the position of border coefficients
  * associated with enforcing boundary conditions via Langrange multipliers.
+ * Boundary conditions on slave nodes constrain the combination of unknowns of
+ * the master node that the DOF depends on.
  */
-void loadBCs(SparseMat &Kg, ForceVector &force_vec, const std::vector<BC> &BCs,
-             unsigned int num_nodes);
+template <typename Config>
+void loadBCs(std::vector<Triplet> &triplets, ForceVector &force_vec,
+             const std::vector<BC> &BCs, const DofMap<Config> &dof_map);
 
-void loadEquations(SparseMat &Kg, const std::vector<Equation> &equations,
-                   unsigned int num_nodes, unsigned int num_bcs);
+/**
+ * @brief Loads the equation constraints into the set of triplets that will
+ * become the global stiffness matrix.
+ * @details Equations are enforced via Lagrange multipliers placed after those
+ * of the boundary conditions. Terms on DOFs that are not active in `Config`
+ * are skipped, since those DOFs are identically zero.
+ *
+ * @param triplets `std::vector<fea::Triplet>`. Border coefficients reflecting
+ * the Lagrange multipliers are appended.
+ * @param[in] equations `std::vector<fea::Equation>`. Equation constraints to
+ * apply.
+ * @param[in] dof_map `fea::DofMap`. Maps nodal DOFs onto the unknowns of
+ * the global system.
+ * @param[in] num_bcs `size_t`. The number of boundary conditions loaded
+ * by `loadBCs`.
+ */
+template <typename Config>
+void loadEquations(std::vector<Triplet> &triplets,
+                   const std::vector<Equation> &equations,
+                   const DofMap<Config> &dof_map, size_t num_bcs);
 
 /**
  * @brief Loads any tie constraints into the set of triplets that will become
@@ -215,16 +535,20 @@ void loadEquations(SparseMat &Kg, const std::vector<Equation> &equations,
  * @details Tie constraints are enforced via linear springs between the 2
  * specified nodes. The `lmult` member variable is used as the spring constant
  * for displacement degrees of freedom, e.g. 0, 1, and 2. `rmult` is used for
- * rotational degrees of freedom, e.g. 3, 4, and 5.
+ * rotational degrees of freedom, e.g. 3, 4, and 5. Only DOFs active in
+ * `Config` are linked.
  *
- * @param triplets `std::vector< Eigen::Triplet< double > >`. A vector of
+ * @param triplets `std::vector<fea::Triplet>`. A vector of
  * triplets that store data in the form (i, j, value) that will be become the
  * sparse global stiffness matrix.
  * @param[in] ties `std::vector<fea::Tie>`. Vector of `Tie`'s to apply to the
  * current analysis.
+ * @param[in] dof_map `fea::DofMap`. Maps nodal DOFs onto the unknowns of the
+ * global stiffness matrix.
  */
-void loadTies(std::vector<Eigen::Triplet<double>> &triplets,
-              const std::vector<Tie> &ties);
+template <typename Config>
+void loadTies(std::vector<Triplet> &triplets,
+              const std::vector<Tie> &ties, const DofMap<Config> &dof_map);
 
 /**
  * @brief Computes the forces in the tie elements based on the nodal
@@ -232,23 +556,32 @@ void loadTies(std::vector<Eigen::Triplet<double>> &triplets,
  *
  * @param[in] ties `std::vector<Tie>`. Vector of `fea::Tie`'s to applied to the
  * current analysis.
- * @param[in] nodal_displacements `std::vector < std::vector < double > >`. The
- * resultant nodal displacements of the analysis.
- * @return Tie forces. `std::vector < std::vector < double > >`
+ * @param[in] nodal_displacements `fea::NodalResults`. The resultant nodal
+ * displacements of the analysis.
+ * @return Tie forces, one row per tie. `fea::NodalResults`
  */
-std::vector<std::vector<double>>
-computeTieForces(const std::vector<Tie> &ties,
-                 const std::vector<std::vector<double>> &nodal_displacements);
+NodalResults computeTieForces(const std::vector<Tie> &ties,
+                              const NodalResults &nodal_displacements);
 
 /**
  * @brief Loads the prescribed forces into the force vector.
+ * @details Forces with a value of zero on DOFs that are not active in `Config`
+ * are skipped. A non-zero force on an inactive DOF throws
+ * `std::runtime_error`. Forces on slave nodes are transferred to the master
+ * node together with the moment they exert about it. Several forces on the
+ * same DOF are summed, so load lists of any length and order are loaded in a
+ * single linear pass.
  *
  * @param force_vec `ForceVector`. Right hand side of the \f$[K][Q]=[F]\f$
  * equation of the FE analysis.
  * @param[in] forces std::vector<Force>. Vector of prescribed forces to apply to
  * the current analysis.
+ * @param[in] dof_map `fea::DofMap`. Maps nodal DOFs onto the unknowns of the
+ * global system.
  */
-void loadForces(SparseMat &force_vec, const std::vector<Force> &forces);
+template <typename Config>
+void loadForces(ForceVector &force_vec, const std::vector<Force> &forces,
+                const DofMap<Config> &dof_map);
 
 /**
  * @brief Solves the finite element analysis defined by the input Job, boundary
@@ -266,6 +599,15 @@ void loadForces(SparseMat &force_vec, const std::vector<Force> &forces);
  * @param[in] ties `std::vector<fea::Tie>`. Vector of ties that apply to attach
  * springs of specified stiffness to all nodal degrees of freedom between each
  * set of nodes indicated.
+ * @param[in] equations `std::vector<fea::Equation>`. Vector of linear
+ * multipoint constraints.
+ * @param[in] options `fea::Options`. Options of the analysis.
+ * `Options::analysis_type` selects the element formulation and the DOFs per
+ * node of the global system. Boundary conditions with a value of zero and
+ * equation terms on DOFs that are not part of the selected analysis type are
+ * dropped, since those DOFs are identically zero. Planar analysis types throw
+ * `std::runtime_error` if a node lies out of the x-y plane. Results are always
+ * reported with 6 DOFs per node.
  *
  * @return <B>Summary</B> `fea::Summary`. Summary containing the results of the
  * analysis.
@@ -273,6 +615,41 @@ void loadForces(SparseMat &force_vec, const std::vector<Force> &forces);
 Summary solve(const Job &job, const std::vector<BC> &BCs,
               const std::vector<Force> &forces, const std::vector<Tie> &ties,
               const std::vector<Equation> &equations, const Options &options);
+
+/**
+ * @brief Solves the finite element analysis of a job with rigid bodies.
+ * @details Same as above. The DOFs of the slave nodes of `rigid_bodies` are
+ * condensed into those of their master nodes before assembly, which enforces
+ * the rigid constraints exactly and removes the slave DOFs from the global
+ * system. Displacements, tie forces and element forces are reported for every
+ * node. The nodal forces of a rigid body are reported as the resultant about
+ * its master node, the nodal forces of its slave nodes are zero.
+ *
+ * @param[in] rigid_bodies `std::vector<fea::RigidBody>`. Rigid links and rigid
+ * bodies of the analysis.
+ */
+Summary solve(const Job &job, const std::vector<BC> &BCs,
+              const std::vector<Force> &forces, const std::vector<Tie> &ties,
+              const std::vector<Equation> &equations,
+              const std::vector<RigidBody> &rigid_bodies,
+              const Options &options);
+
+/**
+ * @brief Solves the finite element analysis of a model.
+ * @details Same as above for the job, boundary conditions, loads and
+ * constraints of `model`. The input load times of `load_summary`, as filled by
+ * `fea::createModelFromJSON`, are copied to the returned summary and its
+ * report. If `model.element_stream` is set the elements are read from the
+ * stream in chunks, once to assemble the global system and once to recover
+ * the element forces. Such a model is solved as a single system: parts that
+ * are not sufficiently restrained are reported as DOFs without stiffness.
+ *
+ * @param[in] model `fea::Model`. The job and constraints to analyze.
+ * @param[in] options `fea::Options`. Options of the analysis.
+ * @param[in] load_summary `fea::Summary`. Holds the input load times.
+ */
+Summary solve(const Model &model, const Options &options,
+              const Summary &load_summary = Summary());
 } // namespace fea
 
 #endif // THREED_BEAM_FEA_H
@@ -0,0 +1,57 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_VTU_WRITER_H
+#define FEA_VTU_WRITER_H
+
+#include <string>
+
+#include "containers.h"
+#include "element_stream.h"
+#include "summary.h"
+
+namespace fea {
+
+    /**
+     * @brief Writes the mesh and results of an analysis as a VTK unstructured grid (`.vtu`) file.
+     * @details Each element becomes a line cell between its two nodes. The point data holds the "displacement",
+     * "rotation", "force" and "moment" vectors of each node, taken from the nodal displacements and nodal forces
+     * of `summary`, and the cell data holds the 12 "element_forces" of each element. Arrays that `summary` does
+     * not hold are left out. All arrays are stored as raw little-endian binary in the appended data section and
+     * written in one sequential pass with a bounded buffer, so the file can be opened directly by ParaView.
+     * Throws `std::runtime_error` if the file cannot be written.
+     *
+     * @param[in] filename `std::string`. The file to write.
+     * @param[in] job `fea::Job`. The nodes and, unless `element_stream` is given, the elements of the mesh.
+     * @param[in] summary `fea::Summary`. Results of the analysis of `job`.
+     * @param element_stream `fea::ElementStream`. Source of the elements if they are streamed, or null. Its
+     * `summary.num_elems` elements are read again from the first element.
+     */
+    void writeVTU(const std::string &filename, const Job &job, const Summary &summary,
+                  ElementStream *element_stream = nullptr);
+
+} // namespace fea
+
+#endif // FEA_VTU_WRITER_H
@@ -0,0 +1,397 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "binary_io.h"
+
+namespace fea {
+
+    namespace {
+        const char RAW_MAGIC[8] = {'F', 'E', 'A', 'R', 'E', 'S', '\0', '\0'};
+        const std::uint32_t RAW_VERSION = 1;
+        const std::uint32_t RAW_HEADER_SIZE = 64;
+
+        void checkByteOrder() {
+            const std::uint32_t one = 1;
+            if (*reinterpret_cast<const unsigned char *>(&one) != 1) {
+                throw std::runtime_error("Binary results are little-endian and cannot be written on this platform.");
+            }
+        }
+
+        size_t numCols(const std::string &filename, const std::vector<std::vector<double> > &data) {
+            const size_t num_cols = data.empty() ? 0 : data[0].size();
+            for (size_t i = 1; i < data.size(); ++i) {
+                if (data[i].size() != num_cols) {
+                    throw std::runtime_error(
+                            (boost::format("Cannot write %s as a binary array because row %d has %d values "
+                                                   "instead of %d.") % filename % i % data[i].size() %
+                             num_cols).str()
+                    );
+                }
+            }
+            return num_cols;
+        }
+
+        /**
+         * Opens `filename` for writing or throws.
+         */
+        void openOutput(const std::string &filename, std::ofstream &output_file) {
+            output_file.open(filename.c_str(), std::ios::binary);
+            if (!output_file.is_open()) {
+                throw std::runtime_error(
+                        (boost::format("Error opening file %s") % filename).str()
+                );
+            }
+        }
+
+        /**
+         * Closes `output_file` and throws if any write failed.
+         */
+        void closeOutput(const std::string &filename, std::ofstream &output_file) {
+            output_file.close();
+            if (!output_file) {
+                throw std::runtime_error(
+                        (boost::format("Error writing file %s") % filename).str()
+                );
+            }
+        }
+
+        /**
+         * Writes `header` followed by the `num_values` values of the contiguous array `data`.
+         */
+        void writeArray(const std::string &filename, const std::string &header, const double *data,
+                        size_t num_values) {
+            std::ofstream output_file;
+            openOutput(filename, output_file);
+            output_file.write(header.data(), header.size());
+            output_file.write(reinterpret_cast<const char *>(data), num_values * sizeof(double));
+            closeOutput(filename, output_file);
+        }
+
+        /**
+         * Writes `header` followed by the rows of `data` in chunks of about 1MB.
+         */
+        void writeArray(const std::string &filename, const std::string &header,
+                        const std::vector<std::vector<double> > &data, size_t num_cols) {
+            std::ofstream output_file;
+            openOutput(filename, output_file);
+            output_file.write(header.data(), header.size());
+
+            const size_t row_size = num_cols * sizeof(double);
+            if (row_size > 0) {
+                const size_t rows_per_chunk = std::max<size_t>(1, (1 << 20) / row_size);
+                std::vector<char> chunk(rows_per_chunk * row_size);
+                for (size_t first_row = 0; first_row < data.size(); first_row += rows_per_chunk) {
+                    const size_t last_row = std::min(first_row + rows_per_chunk, data.size());
+                    char *c = chunk.data();
+                    for (size_t i = first_row; i < last_row; ++i) {
+                        std::memcpy(c, data[i].data(), row_size);
+                        c += row_size;
+                    }
+                    output_file.write(chunk.data(), c - chunk.data());
+                }
+            }
+            closeOutput(filename, output_file);
+        }
+
+        template<typename T>
+        T readLE(const char *data) {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            return value;
+        }
+
+        template<typename T>
+        void appendBytes(std::string &out, const T &value) {
+            out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        /**
+         * Returns the 64 byte header of a raw binary file holding a `num_rows` x `num_cols` array.
+         */
+        std::string rawHeader(size_t num_rows, size_t num_cols) {
+            std::string header(RAW_MAGIC, sizeof(RAW_MAGIC));
+            appendBytes(header, RAW_VERSION);
+            appendBytes(header, RAW_HEADER_SIZE);
+            appendBytes(header, static_cast<std::uint64_t>(num_rows));
+            appendBytes(header, static_cast<std::uint64_t>(num_cols));
+            header.resize(RAW_HEADER_SIZE, '\0');
+            return header;
+        }
+
+        /**
+         * Returns the header of a `.npy` file holding a `num_rows` x `num_cols` float64 array.
+         */
+        std::string npyHeader(size_t num_rows, size_t num_cols) {
+            // version 1.0 header: magic, version, little-endian uint16 length and a python dict literal padded with
+            // spaces and terminated by a newline so that the array starts 64-byte aligned
+            std::string dict = (boost::format("{'descr': '<f8', 'fortran_order': False, 'shape': (%d, %d), }") %
+                                num_rows % num_cols).str();
+            const size_t preamble_size = 10;
+            const size_t header_size = (preamble_size + dict.size() + 1 + 63) / 64 * 64;
+            dict.resize(header_size - preamble_size - 1, ' ');
+            dict += '\n';
+
+            std::string header("\x93NUMPY\x01\x00", 8);
+            appendBytes(header, static_cast<std::uint16_t>(dict.size()));
+            header += dict;
+            return header;
+        }
+    }
+
+    NpyArray parseNpy(const char *data, size_t size, const std::string &filename) {
+        checkByteOrder();
+        const std::string invalid = (boost::format("%s is not a valid .npy file") % filename).str();
+        if (size < 10 || std::memcmp(data, "\x93NUMPY", 6) != 0) {
+            throw std::runtime_error(invalid + ".");
+        }
+
+        // [read the header dict, whose length field grew to 4 bytes in version 2.0
+        size_t header_start;
+        size_t header_length;
+        if (data[6] == 1) {
+            std::uint16_t length;
+            std::memcpy(&length, data + 8, sizeof(length));
+            header_start = 10;
+            header_length = length;
+        }
+        else {
+            std::uint32_t length;
+            if (size < 12) {
+                throw std::runtime_error(invalid + ".");
+            }
+            std::memcpy(&length, data + 8, sizeof(length));
+            header_start = 12;
+            header_length = length;
+        }
+        if (header_length > size - header_start) {
+            throw std::runtime_error(invalid + ": the header is truncated.");
+        }
+        const std::string header(data + header_start, header_length);
+        // ]
+
+        NpyArray array;
+
+        // [parse the dtype, e.g. '<f8'
+        size_t pos = header.find("'descr'");
+        pos = pos == std::string::npos ? pos : header.find('\'', pos + 7);
+        const size_t descr_end = pos == std::string::npos ? pos : header.find('\'', pos + 1);
+        if (descr_end == std::string::npos) {
+            throw std::runtime_error(invalid + ": the header has no descr.");
+        }
+        const std::string descr = header.substr(pos + 1, descr_end - pos - 1);
+        if (descr.size() < 3 || (descr[0] != '<' && descr[0] != '|' && descr[0] != '=')) {
+            throw std::runtime_error(
+                    (boost::format("%s holds values of dtype %s, but only little-endian numbers are supported.") %
+                     filename % descr).str()
+            );
+        }
+        array.kind = descr[1];
+        array.item_size = static_cast<size_t>(std::atoi(descr.c_str() + 2));
+        const bool supported = (array.kind == 'f' && (array.item_size == 4 || array.item_size == 8)) ||
+                               ((array.kind == 'i' || array.kind == 'u') &&
+                                (array.item_size == 1 || array.item_size == 2 || array.item_size == 4 ||
+                                 array.item_size == 8));
+        if (!supported) {
+            throw std::runtime_error(
+                    (boost::format("%s holds values of dtype %s, but only float32, float64 and integer arrays are "
+                                           "supported.") % filename % descr).str()
+            );
+        }
+        // ]
+
+        pos = header.find("'fortran_order'");
+        if (pos == std::string::npos) {
+            throw std::runtime_error(invalid + ": the header has no fortran_order.");
+        }
+        pos = header.find_first_not_of(": ", pos + 15);
+        array.fortran_order = header.compare(pos, 4, "True") == 0;
+
+        // [parse the shape tuple, e.g. (100, 3)
+        pos = header.find("'shape'");
+        pos = pos == std::string::npos ? pos : header.find('(', pos);
+        const size_t shape_end = pos == std::string::npos ? pos : header.find(')', pos);
+        if (shape_end == std::string::npos) {
+            throw std::runtime_error(invalid + ": the header has no shape.");
+        }
+        std::vector<size_t> shape;
+        const char *c = header.c_str() + pos + 1;
+        const char *end = header.c_str() + shape_end;
+        while (c < end) {
+            char *next;
+            const unsigned long long dim = std::strtoull(c, &next, 10);
+            if (next == c) {
+                break;
+            }
+            shape.push_back(static_cast<size_t>(dim));
+            c = next;
+            while (c < end && (*c == ',' || *c == ' ')) {
+                ++c;
+            }
+        }
+        if (shape.empty() || shape.size() > 2) {
+            throw std::runtime_error(
+                    (boost::format("%s holds an array with %d dimensions, but 1 or 2 dimensions were expected.") %
+                     filename % shape.size()).str()
+            );
+        }
+        array.rows = shape[0];
+        array.cols = shape.size() == 2 ? shape[1] : 1;
+        // ]
+
+        const size_t data_start = header_start + header_length;
+        if (array.cols > 0 && array.rows > (size - data_start) / array.item_size / array.cols) {
+            throw std::runtime_error(invalid + ": the file is smaller than the array it describes.");
+        }
+        array.data = data + data_start;
+        return array;
+    }
+
+    NpyArray findNpzArray(const char *data, size_t size, const std::string &filename,
+                          const std::string &array_name) {
+        checkByteOrder();
+        const std::string invalid = (boost::format("%s is not a valid .npz file") % filename).str();
+
+        // [find the end of central directory record, which may be followed by a comment
+        const size_t eocd_size = 22;
+        if (size < eocd_size) {
+            throw std::runtime_error(invalid + ".");
+        }
+        size_t eocd = size - eocd_size;
+        const size_t search_end = size > eocd_size + 65535 ? size - eocd_size - 65535 : 0;
+        while (readLE<std::uint32_t>(data + eocd) != 0x06054b50) {
+            if (eocd == search_end) {
+                throw std::runtime_error(invalid + ": the zip directory was not found.");
+            }
+            --eocd;
+        }
+        const size_t num_entries = readLE<std::uint16_t>(data + eocd + 10);
+        size_t entry = readLE<std::uint32_t>(data + eocd + 16);
+        // ]
+
+        std::vector<std::string> names;
+        std::vector<size_t> local_offsets;
+        std::vector<std::uint16_t> methods;
+        for (size_t i = 0; i < num_entries; ++i) {
+            if (size < 46 || entry > size - 46 || readLE<std::uint32_t>(data + entry) != 0x02014b50) {
+                throw std::runtime_error(invalid + ": the zip directory is corrupt.");
+            }
+            const std::uint16_t method = readLE<std::uint16_t>(data + entry + 10);
+            const size_t name_length = readLE<std::uint16_t>(data + entry + 28);
+            const size_t extra_length = readLE<std::uint16_t>(data + entry + 30);
+            const size_t comment_length = readLE<std::uint16_t>(data + entry + 32);
+            std::uint64_t local_offset = readLE<std::uint32_t>(data + entry + 42);
+            if (entry + 46 + name_length + extra_length > size) {
+                throw std::runtime_error(invalid + ": the zip directory is corrupt.");
+            }
+
+            // large archives keep the offset in the zip64 extra field after the two sizes that are saturated
+            if (local_offset == 0xFFFFFFFF) {
+                const char *extra = data + entry + 46 + name_length;
+                const char *extra_end = extra + extra_length;
+                while (extra + 4 <= extra_end) {
+                    const std::uint16_t id = readLE<std::uint16_t>(extra);
+                    const std::uint16_t length = readLE<std::uint16_t>(extra + 2);
+                    if (id == 0x0001) {
+                        size_t field = 4;
+                        if (readLE<std::uint32_t>(data + entry + 24) == 0xFFFFFFFF) field += 8;
+                        if (readLE<std::uint32_t>(data + entry + 20) == 0xFFFFFFFF) field += 8;
+                        if (field + 8 <= 4u + length && extra + field + 8 <= extra_end) {
+                            local_offset = readLE<std::uint64_t>(extra + field);
+                        }
+                    }
+                    extra += 4 + length;
+                }
+            }
+
+            names.push_back(std::string(data + entry + 46, name_length));
+            local_offsets.push_back(static_cast<size_t>(local_offset));
+            methods.push_back(method);
+            entry += 46 + name_length + extra_length + comment_length;
+        }
+
+        size_t found = names.size();
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == array_name + ".npy") {
+                found = i;
+            }
+        }
+        if (found == names.size() && names.size() == 1) {
+            found = 0;
+        }
+        if (found == names.size()) {
+            throw std::runtime_error(
+                    (boost::format("%s does not hold an array named %s.") % filename % array_name).str()
+            );
+        }
+        if (methods[found] != 0) {
+            throw std::runtime_error(
+                    (boost::format("Array %s in %s is compressed. Save it with numpy.savez instead of "
+                                           "numpy.savez_compressed.") % names[found] % filename).str()
+            );
+        }
+
+        const size_t local = local_offsets[found];
+        if (size < 30 || local > size - 30 || readLE<std::uint32_t>(data + local) != 0x04034b50) {
+            throw std::runtime_error(invalid + ": a local file header is corrupt.");
+        }
+        const size_t start = local + 30 + readLE<std::uint16_t>(data + local + 26) +
+                             readLE<std::uint16_t>(data + local + 28);
+        if (start > size) {
+            throw std::runtime_error(invalid + ": a local file header is corrupt.");
+        }
+        return parseNpy(data + start, size - start, filename + "/" + names[found]);
+    }
+
+    void writeRawBinary(const std::string &filename, const std::vector<std::vector<double> > &data) {
+        checkByteOrder();
+        const size_t num_cols = numCols(filename, data);
+        writeArray(filename, rawHeader(data.size(), num_cols), data, num_cols);
+    }
+
+    void writeRawBinary(const std::string &filename, const double *data, size_t num_rows, size_t num_cols) {
+        checkByteOrder();
+        writeArray(filename, rawHeader(num_rows, num_cols), data, num_rows * num_cols);
+    }
+
+    void writeNpy(const std::string &filename, const std::vector<std::vector<double> > &data) {
+        checkByteOrder();
+        const size_t num_cols = numCols(filename, data);
+        writeArray(filename, npyHeader(data.size(), num_cols), data, num_cols);
+    }
+
+    void writeNpy(const std::string &filename, const double *data, size_t num_rows, size_t num_cols) {
+        checkByteOrder();
+        writeArray(filename, npyHeader(num_rows, num_cols), data, num_rows * num_cols);
+    }
+
+} // namespace fea
@@ -0,0 +1,524 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <boost/format.hpp>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "binary_job.h"
+#include "csv_parser.h"
+
+namespace fea {
+
+    namespace {
+        const char MAGIC[8] = {'F', 'E', 'A', 'B', 'J', 'O', 'B', '\0'};
+        const std::uint32_t VERSION = 1;
+        const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+        const std::uint64_t ALIGNMENT = 64;
+
+        /**
+         * Types of the sections stored in a binary job file. The values are part of the file format.
+         */
+        enum SectionType {
+            NODES = 1, /**<`double[3]` per node.*/
+            ELEMS = 2, /**<`uint64[2]` per element.*/
+            PROPS = 3, /**<`double[7]` [EA, EIz, EIy, GJ, nx, ny, nz] per element.*/
+            SECTIONS = 4, /**<`double[7]` per section.*/
+            SECTION_IDS = 5, /**<`uint32` per element.*/
+            ORIENTATIONS = 6, /**<`double[3]` per element.*/
+            BCS = 7, /**<`NodalValueRecord` per boundary condition.*/
+            FORCES = 8, /**<`NodalValueRecord` per force.*/
+            TIES = 9, /**<`TieRecord` per tie.*/
+            EQUATION_OFFSETS = 10, /**<`uint64` offset of the first term of each equation, then the number of terms.*/
+            EQUATION_TERMS = 11, /**<`NodalValueRecord` per term.*/
+            RIGID_BODY_OFFSETS = 12, /**<`uint64` offset of the master node of each body, then the number of nodes.*/
+            RIGID_BODY_NODES = 13 /**<`uint64` master node followed by the slave nodes of each body.*/
+        };
+
+        struct FileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byte_order_mark;
+            std::uint32_t num_sections;
+            std::uint32_t reserved_0;
+            std::uint64_t reserved_1;
+        };
+
+        struct SectionEntry {
+            std::uint32_t type;
+            std::uint32_t record_size;
+            std::uint64_t offset;
+            std::uint64_t count;
+        };
+
+        struct NodalValueRecord {
+            std::uint64_t node;
+            std::uint32_t dof;
+            std::uint32_t reserved;
+            double value;
+        };
+
+        struct TieRecord {
+            std::uint64_t node_number_1;
+            std::uint64_t node_number_2;
+            double lmult;
+            double rmult;
+        };
+
+        static_assert(sizeof(FileHeader) == 32, "Unexpected padding in FileHeader.");
+        static_assert(sizeof(SectionEntry) == 24, "Unexpected padding in SectionEntry.");
+        static_assert(sizeof(NodalValueRecord) == 24, "Unexpected padding in NodalValueRecord.");
+        static_assert(sizeof(TieRecord) == 32, "Unexpected padding in TieRecord.");
+        static_assert(sizeof(Node) == 3 * sizeof(double), "Nodes are expected to be 3 contiguous doubles.");
+        static_assert(sizeof(unsigned int) == sizeof(std::uint32_t), "Section ids are expected to be 32-bit.");
+
+        void checkByteOrder() {
+            const std::uint32_t one = 1;
+            if (*reinterpret_cast<const unsigned char *>(&one) != 1) {
+                throw std::runtime_error("Binary job files are little-endian and cannot be used on this platform.");
+            }
+        }
+
+        /**
+         * A section to be written to a binary job file.
+         */
+        struct OutputSection {
+            OutputSection(SectionType _type, std::uint32_t _record_size, std::uint64_t _count)
+                    : type(_type), record_size(_record_size), count(_count), bytes(_record_size * _count) { };
+
+            template<typename T>
+            void set(size_t record, size_t offset, const T &value) {
+                std::memcpy(&bytes[record * record_size + offset], &value, sizeof(T));
+            }
+
+            SectionType type;
+            std::uint32_t record_size;
+            std::uint64_t count;
+            std::vector<char> bytes;
+        };
+
+        OutputSection nodalValueSection(SectionType type, size_t count) {
+            return OutputSection(type, sizeof(NodalValueRecord), count);
+        }
+
+        void setNodalValue(OutputSection &section, size_t i, NodeIndex node, unsigned int dof, double value) {
+            NodalValueRecord record;
+            record.node = node;
+            record.dof = dof;
+            record.reserved = 0;
+            record.value = value;
+            section.set(i, 0, record);
+        }
+
+        OutputSection propsSection(SectionType type, const std::vector<Props> &props) {
+            OutputSection section(type, 7 * sizeof(double), props.size());
+            for (size_t i = 0; i < props.size(); ++i) {
+                const double row[7] = {props[i].EA, props[i].EIz, props[i].EIy, props[i].GJ,
+                                       props[i].normal_vec(0), props[i].normal_vec(1), props[i].normal_vec(2)};
+                section.set(i, 0, row);
+            }
+            return section;
+        }
+
+        OutputSection vectorSection(SectionType type, const std::vector<Eigen::Vector3d> &vecs) {
+            OutputSection section(type, 3 * sizeof(double), vecs.size());
+            if (!vecs.empty()) {
+                std::memcpy(section.bytes.data(), vecs.data(), section.bytes.size());
+            }
+            return section;
+        }
+
+        std::uint64_t alignOffset(std::uint64_t offset) {
+            return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        /**
+         * Sections of a memory-mapped binary job file.
+         */
+        class InputSections {
+        public:
+            InputSections(const MappedFile &_file, const std::string &_filename)
+                    : file(_file), filename(_filename) {
+                FileHeader header;
+                if (file.size() < sizeof(header)) {
+                    fail("it is too small to hold the header");
+                }
+                std::memcpy(&header, file.data(), sizeof(header));
+                if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+                    fail("it does not start with the binary job magic string");
+                }
+                if (header.byte_order_mark != BYTE_ORDER_MARK) {
+                    fail("its byte order does not match this platform");
+                }
+                if (header.version != VERSION) {
+                    throw std::runtime_error(
+                            (boost::format("Binary job file %s has version %d, but only version %d is supported.") %
+                             filename % header.version % VERSION).str()
+                    );
+                }
+                if ((file.size() - sizeof(header)) / sizeof(SectionEntry) < header.num_sections) {
+                    fail("it is too small to hold the section table");
+                }
+                entries.resize(header.num_sections);
+                if (!entries.empty()) {
+                    std::memcpy(entries.data(), file.data() + sizeof(header),
+                                entries.size() * sizeof(SectionEntry));
+                }
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    const SectionEntry &entry = entries[i];
+                    if (entry.offset > file.size() ||
+                        (entry.record_size > 0 && entry.count > (file.size() - entry.offset) / entry.record_size)) {
+                        fail((boost::format("section %d extends past the end of the file") % i).str());
+                    }
+                }
+            }
+
+            /**
+             * Returns the records of the section of type `type`, or null if the file has no such section.
+             */
+            const char *find(SectionType type, std::uint32_t record_size, size_t &count) const {
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    if (entries[i].type == static_cast<std::uint32_t>(type)) {
+                        if (entries[i].record_size != record_size) {
+                            fail((boost::format("section %d has records of %d bytes instead of %d") %
+                                  i % entries[i].record_size % record_size).str());
+                        }
+                        count = static_cast<size_t>(entries[i].count);
+                        return file.data() + entries[i].offset;
+                    }
+                }
+                count = 0;
+                return nullptr;
+            }
+
+            template<typename T>
+            T read(const char *records, size_t i, size_t offset = 0) const {
+                T value;
+                std::memcpy(&value, records + i * sizeof(T) + offset, sizeof(T));
+                return value;
+            }
+
+            NodeIndex toNodeIndex(std::uint64_t node) const {
+                if (node > std::numeric_limits<NodeIndex>::max()) {
+                    fail((boost::format("node %d exceeds the largest supported index. Rebuild with "
+                                                "FEA_USE_64BIT_INDICES") % node).str());
+                }
+                return static_cast<NodeIndex>(node);
+            }
+
+            unsigned int toDof(std::uint32_t dof) const {
+                if (dof >= DOF::NUM_DOFS) {
+                    fail((boost::format("degree of freedom %d is out of range") % dof).str());
+                }
+                return dof;
+            }
+
+            void fail(const std::string &reason) const {
+                throw std::runtime_error(
+                        (boost::format("Cannot read binary job file %s because %s.") % filename % reason).str()
+                );
+            }
+
+        private:
+            const MappedFile &file;
+            const std::string &filename;
+            std::vector<SectionEntry> entries;
+        };
+
+        std::vector<Props> readProps(const InputSections &sections, SectionType type) {
+            size_t count;
+            const char *records = sections.find(type, 7 * sizeof(double), count);
+            std::vector<Props> props(count);
+            for (size_t i = 0; i < count; ++i) {
+                double row[7];
+                std::memcpy(row, records + i * sizeof(row), sizeof(row));
+                props[i].EA = row[0];
+                props[i].EIz = row[1];
+                props[i].EIy = row[2];
+                props[i].GJ = row[3];
+                props[i].normal_vec << row[4], row[5], row[6];
+            }
+            return props;
+        }
+
+        std::vector<Eigen::Vector3d> readVectors(const InputSections &sections, SectionType type) {
+            size_t count;
+            const char *records = sections.find(type, 3 * sizeof(double), count);
+            std::vector<Eigen::Vector3d> vecs(count);
+            if (count > 0) {
+                std::memcpy(vecs[0].data(), records, count * sizeof(Eigen::Vector3d));
+            }
+            return vecs;
+        }
+
+        std::vector<std::uint64_t> readOffsets(const InputSections &sections, SectionType type,
+                                               size_t num_values) {
+            size_t count;
+            const char *records = sections.find(type, sizeof(std::uint64_t), count);
+            std::vector<std::uint64_t> offsets(count);
+            for (size_t i = 0; i < count; ++i) {
+                offsets[i] = sections.read<std::uint64_t>(records, i);
+                if (offsets[i] > num_values || (i > 0 && offsets[i] < offsets[i - 1])) {
+                    sections.fail("its equation or rigid body offsets are inconsistent");
+                }
+            }
+            if (count > 0 && offsets.back() != num_values) {
+                sections.fail("its equation or rigid body offsets are inconsistent");
+            }
+            return offsets;
+        }
+    }
+
+    void writeBinaryJob(const std::string &filename, const Model &model) {
+        checkByteOrder();
+        if (model.element_stream) {
+            throw std::runtime_error("The elements of a model are streamed and cannot be written to a binary job "
+                                             "file.");
+        }
+        const Job &job = model.job;
+        std::vector<OutputSection> sections;
+
+        sections.push_back(vectorSection(NODES, job.nodes));
+
+        sections.push_back(OutputSection(ELEMS, 2 * sizeof(std::uint64_t), job.elems.size()));
+        for (size_t i = 0; i < job.elems.size(); ++i) {
+            const std::uint64_t row[2] = {static_cast<std::uint64_t>(job.elems[i](0)),
+                                          static_cast<std::uint64_t>(job.elems[i](1))};
+            sections.back().set(i, 0, row);
+        }
+
+        if (!job.props.empty()) {
+            sections.push_back(propsSection(PROPS, job.props));
+        }
+        else {
+            sections.push_back(propsSection(SECTIONS, job.sections));
+            sections.push_back(OutputSection(SECTION_IDS, sizeof(std::uint32_t), job.section_ids.size()));
+            if (!job.section_ids.empty()) {
+                std::memcpy(sections.back().bytes.data(), job.section_ids.data(), sections.back().bytes.size());
+            }
+            if (!job.orientations.empty()) {
+                sections.push_back(vectorSection(ORIENTATIONS, job.orientations));
+            }
+        }
+
+        sections.push_back(nodalValueSection(BCS, model.bcs.size()));
+        for (size_t i = 0; i < model.bcs.size(); ++i) {
+            setNodalValue(sections.back(), i, model.bcs[i].node, model.bcs[i].dof, model.bcs[i].value);
+        }
+
+        sections.push_back(nodalValueSection(FORCES, model.forces.size()));
+        for (size_t i = 0; i < model.forces.size(); ++i) {
+            setNodalValue(sections.back(), i, model.forces[i].node, model.forces[i].dof, model.forces[i].value);
+        }
+
+        sections.push_back(OutputSection(TIES, sizeof(TieRecord), model.ties.size()));
+        for (size_t i = 0; i < model.ties.size(); ++i) {
+            TieRecord record;
+            record.node_number_1 = model.ties[i].node_number_1;
+            record.node_number_2 = model.ties[i].node_number_2;
+            record.lmult = model.ties[i].lmult;
+            record.rmult = model.ties[i].rmult;
+            sections.back().set(i, 0, record);
+        }
+
+        // [equations and rigid bodies are stored as offsets into a flat array of terms or nodes
+        size_t num_terms = 0;
+        sections.push_back(OutputSection(EQUATION_OFFSETS, sizeof(std::uint64_t), model.equations.size() + 1));
+        for (size_t i = 0; i < model.equations.size(); ++i) {
+            sections.back().set(i, 0, static_cast<std::uint64_t>(num_terms));
+            num_terms += model.equations[i].terms.size();
+        }
+        sections.back().set(model.equations.size(), 0, static_cast<std::uint64_t>(num_terms));
+
+        sections.push_back(nodalValueSection(EQUATION_TERMS, num_terms));
+        size_t term = 0;
+        for (size_t i = 0; i < model.equations.size(); ++i) {
+            for (size_t j = 0; j < model.equations[i].terms.size(); ++j) {
+                const Equation::Term &t = model.equations[i].terms[j];
+                setNodalValue(sections.back(), term++, t.node_number, t.dof, t.coefficient);
+            }
+        }
+
+        size_t num_body_nodes = 0;
+        sections.push_back(OutputSection(RIGID_BODY_OFFSETS, sizeof(std::uint64_t), model.rigid_bodies.size() + 1));
+        for (size_t i = 0; i < model.rigid_bodies.size(); ++i) {
+            sections.back().set(i, 0, static_cast<std::uint64_t>(num_body_nodes));
+            num_body_nodes += 1 + model.rigid_bodies[i].slave_nodes.size();
+        }
+        sections.back().set(model.rigid_bodies.size(), 0, static_cast<std::uint64_t>(num_body_nodes));
+
+        sections.push_back(OutputSection(RIGID_BODY_NODES, sizeof(std::uint64_t), num_body_nodes));
+        size_t body_node = 0;
+        for (size_t i = 0; i < model.rigid_bodies.size(); ++i) {
+            sections.back().set(body_node++, 0, static_cast<std::uint64_t>(model.rigid_bodies[i].master_node));
+            for (size_t j = 0; j < model.rigid_bodies[i].slave_nodes.size(); ++j) {
+                sections.back().set(body_node++, 0,
+                                    static_cast<std::uint64_t>(model.rigid_bodies[i].slave_nodes[j]));
+            }
+        }
+        // ]
+
+        FileHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.byte_order_mark = BYTE_ORDER_MARK;
+        header.num_sections = static_cast<std::uint32_t>(sections.size());
+        header.reserved_0 = 0;
+        header.reserved_1 = 0;
+
+        std::vector<SectionEntry> entries(sections.size());
+        std::uint64_t offset = sizeof(header) + entries.size() * sizeof(SectionEntry);
+        for (size_t i = 0; i < sections.size(); ++i) {
+            offset = alignOffset(offset);
+            entries[i].type = sections[i].type;
+            entries[i].record_size = sections[i].record_size;
+            entries[i].offset = offset;
+            entries[i].count = sections[i].count;
+            offset += sections[i].bytes.size();
+        }
+
+        std::ofstream output_file(filename.c_str(), std::ios::binary);
+        if (!output_file.is_open()) {
+            throw std::runtime_error(
+                    (boost::format("Cannot open binary job file %s for writing.") % filename).str()
+            );
+        }
+        output_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        output_file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(SectionEntry));
+
+        std::uint64_t position = sizeof(header) + entries.size() * sizeof(SectionEntry);
+        const char padding[ALIGNMENT] = {};
+        for (size_t i = 0; i < sections.size(); ++i) {
+            output_file.write(padding, entries[i].offset - position);
+            output_file.write(sections[i].bytes.data(), sections[i].bytes.size());
+            position = entries[i].offset + sections[i].bytes.size();
+        }
+        if (!output_file) {
+            throw std::runtime_error(
+                    (boost::format("Error writing binary job file %s.") % filename).str()
+            );
+        }
+    }
+
+    Model readBinaryJob(const std::string &filename) {
+        checkByteOrder();
+        const MappedFile file(filename);
+        const InputSections sections(file, filename);
+
+        Model model;
+        Job &job = model.job;
+        size_t count;
+
+        job.nodes = readVectors(sections, NODES);
+
+        const char *records = sections.find(ELEMS, 2 * sizeof(std::uint64_t), count);
+        job.elems.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            job.elems[i] << sections.toNodeIndex(sections.read<std::uint64_t>(records, 2 * i)),
+                    sections.toNodeIndex(sections.read<std::uint64_t>(records, 2 * i + 1));
+        }
+
+        job.props = readProps(sections, PROPS);
+        job.sections = readProps(sections, SECTIONS);
+        records = sections.find(SECTION_IDS, sizeof(std::uint32_t), count);
+        job.section_ids.resize(count);
+        if (count > 0) {
+            std::memcpy(job.section_ids.data(), records, count * sizeof(std::uint32_t));
+        }
+        job.orientations = readVectors(sections, ORIENTATIONS);
+
+        if (job.props.empty()) {
+            if (job.section_ids.size() != job.elems.size() ||
+                (!job.orientations.empty() && job.orientations.size() != job.elems.size())) {
+                sections.fail("the number of section ids or orientations does not match the number of elements");
+            }
+            for (size_t i = 0; i < job.section_ids.size(); ++i) {
+                if (job.section_ids[i] >= job.sections.size()) {
+                    sections.fail((boost::format("element %d refers to section %d, but only %d sections are "
+                                                         "stored") % i % job.section_ids[i] %
+                                   job.sections.size()).str());
+                }
+            }
+        }
+        else if (job.props.size() != job.elems.size()) {
+            sections.fail("the number of element properties does not match the number of elements");
+        }
+
+        records = sections.find(BCS, sizeof(NodalValueRecord), count);
+        model.bcs.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const NodalValueRecord record = sections.read<NodalValueRecord>(records, i);
+            model.bcs[i] = BC(sections.toNodeIndex(record.node), sections.toDof(record.dof), record.value);
+        }
+
+        records = sections.find(FORCES, sizeof(NodalValueRecord), count);
+        model.forces.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const NodalValueRecord record = sections.read<NodalValueRecord>(records, i);
+            model.forces[i] = Force(sections.toNodeIndex(record.node), sections.toDof(record.dof), record.value);
+        }
+
+        records = sections.find(TIES, sizeof(TieRecord), count);
+        model.ties.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const TieRecord record = sections.read<TieRecord>(records, i);
+            model.ties[i] = Tie(sections.toNodeIndex(record.node_number_1), sections.toNodeIndex(record.node_number_2),
+                                record.lmult, record.rmult);
+        }
+
+        size_t num_terms;
+        const char *terms = sections.find(EQUATION_TERMS, sizeof(NodalValueRecord), num_terms);
+        const std::vector<std::uint64_t> eqn_offsets = readOffsets(sections, EQUATION_OFFSETS, num_terms);
+        model.equations.resize(eqn_offsets.empty() ? 0 : eqn_offsets.size() - 1);
+        for (size_t i = 0; i < model.equations.size(); ++i) {
+            model.equations[i].terms.reserve(eqn_offsets[i + 1] - eqn_offsets[i]);
+            for (size_t j = eqn_offsets[i]; j < eqn_offsets[i + 1]; ++j) {
+                const NodalValueRecord record = sections.read<NodalValueRecord>(terms, j);
+                model.equations[i].terms.push_back(
+                        Equation::Term(sections.toNodeIndex(record.node), sections.toDof(record.dof), record.value));
+            }
+        }
+
+        size_t num_body_nodes;
+        const char *body_nodes = sections.find(RIGID_BODY_NODES, sizeof(std::uint64_t), num_body_nodes);
+        const std::vector<std::uint64_t> body_offsets = readOffsets(sections, RIGID_BODY_OFFSETS, num_body_nodes);
+        model.rigid_bodies.resize(body_offsets.empty() ? 0 : body_offsets.size() - 1);
+        for (size_t i = 0; i < model.rigid_bodies.size(); ++i) {
+            if (body_offsets[i + 1] == body_offsets[i]) {
+                sections.fail((boost::format("rigid body %d has no master node") % i).str());
+            }
+            RigidBody &body = model.rigid_bodies[i];
+            body.master_node = sections.toNodeIndex(sections.read<std::uint64_t>(body_nodes, body_offsets[i]));
+            for (size_t j = body_offsets[i] + 1; j < body_offsets[i + 1]; ++j) {
+                body.slave_nodes.push_back(sections.toNodeIndex(sections.read<std::uint64_t>(body_nodes, j)));
+            }
+        }
+        return model;
+    }
+
+} // namespace fea
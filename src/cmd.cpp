@@ -29,31 +29,11 @@
 #include "setup.h"
 
 fea::Summary runAnalysis(const rapidjson::Document &config_doc) {
-    fea::Job job = fea::createJobFromJSON(config_doc);
-
-    std::vector<fea::Tie> ties;
-    if (config_doc.HasMember("ties")) {
-        ties = fea::createTieVecFromJSON(config_doc);
-    }
-
-    std::vector<fea::BC> bcs;
-    if (config_doc.HasMember("bcs")) {
-        bcs = fea::createBCVecFromJSON(config_doc);
-    }
-
-    std::vector<fea::Force> forces;
-    if (config_doc.HasMember("forces")) {
-        forces = fea::createForceVecFromJSON(config_doc);
-    }
-
-    std::vector<fea::Equation> equations;
-    if (config_doc.HasMember("equations")) {
-        equations = fea::createEquationVecFromJSON(config_doc);
-    }
-
+    fea::Summary load_summary;
+    fea::Model model = fea::createModelFromJSON(config_doc, load_summary);
     fea::Options options = fea::createOptionsFromJSON(config_doc);
 
-    return fea::solve(job, bcs, forces, ties, equations, options);
+    return fea::solve(model, options, load_summary);
 }
 
 int main(int argc, char *argv[]) {
@@ -75,12 +55,27 @@ int main(int argc, char *argv[]) {
                                                true,
                                                "config.json",
                                                "string");
+        TCLAP::ValueArg<std::string> convertArg("",
+                                                "convert",
+                                                "Instead of running the analysis, read the model described by the "
+                                                        "configuration file and save it to the given binary job file. "
+                                                        "Point the \"binary_job\" member variable of later configuration "
+                                                        "files to this file to skip parsing the csv files.",
+                                                false,
+                                                "",
+                                                "string");
         cmd.add(configArg);
+        cmd.add(convertArg);
         cmd.parse(argc, argv);
         std::string config_filename = configArg.getValue();
         rapidjson::Document config_doc = fea::parseJSONConfig(config_filename);
 
-        runAnalysis(config_doc);
+        if (convertArg.isSet()) {
+            fea::writeBinaryJob(convertArg.getValue(), fea::createModelFromJSON(config_doc));
+        }
+        else {
+            runAnalysis(config_doc);
+        }
     }
     catch (TCLAP::ArgException &e)  // catch any exceptions from parsing
     {
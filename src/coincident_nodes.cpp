@@ -0,0 +1,256 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <array>
+#include <boost/format.hpp>
+#include <cmath>
+#include <exception>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "coincident_nodes.h"
+
+namespace fea {
+
+namespace {
+typedef std::array<long long, 3> GridCell;
+
+size_t hashCell(const GridCell &cell) {
+  return static_cast<size_t>(cell[0]) * 73856093ULL ^
+         static_cast<size_t>(cell[1]) * 19349663ULL ^
+         static_cast<size_t>(cell[2]) * 83492791ULL;
+}
+
+// Returns the root of `i`, halving the path along the way.
+NodeIndex findRoot(std::vector<NodeIndex> &parents, NodeIndex i) {
+  while (parents[i] != i) {
+    parents[i] = parents[parents[i]];
+    i = parents[i];
+  }
+  return i;
+}
+} // namespace
+
+std::vector<NodeIndex> findCoincidentNodes(const std::vector<Node> &nodes,
+                                           double tolerance) {
+  if (!(tolerance > 0.0)) {
+    throw std::runtime_error(
+        (boost::format("Coincident node tolerance must be positive, got %g.") %
+         tolerance)
+            .str());
+  }
+
+  const long long num_nodes = nodes.size();
+
+  // use a power of 2 number of buckets of the order of the number of nodes
+  size_t num_buckets = 1;
+  while (num_buckets < nodes.size()) {
+    num_buckets <<= 1;
+  }
+  const size_t mask = num_buckets - 1;
+
+  // [bin the nodes into the grid
+  std::vector<GridCell> cells(nodes.size());
+  std::vector<size_t> buckets(nodes.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long long i = 0; i < num_nodes; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      cells[i][j] = static_cast<long long>(std::floor(nodes[i](j) / tolerance));
+    }
+    buckets[i] = hashCell(cells[i]) & mask;
+  }
+
+  // counting sort of the nodes by bucket
+  std::vector<size_t> bucket_start(num_buckets + 1, 0);
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    ++bucket_start[buckets[i] + 1];
+  }
+  for (size_t i = 0; i < num_buckets; ++i) {
+    bucket_start[i + 1] += bucket_start[i];
+  }
+  std::vector<NodeIndex> bucket_nodes(nodes.size());
+  std::vector<size_t> fill(bucket_start.begin(), bucket_start.end() - 1);
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    bucket_nodes[fill[buckets[i]]++] = i;
+  }
+  // ]
+
+  // [collect the pairs of coincident nodes from the same and adjacent cells.
+  // Only pairs with a lower index neighbor are kept, so each pair is found once.
+  std::vector<std::vector<std::pair<NodeIndex, NodeIndex>>> pairs(1);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+  {
+#ifdef _OPENMP
+#pragma omp single
+    pairs.resize(omp_get_num_threads());
+    std::vector<std::pair<NodeIndex, NodeIndex>> &thread_pairs =
+        pairs[omp_get_thread_num()];
+#else
+    std::vector<std::pair<NodeIndex, NodeIndex>> &thread_pairs = pairs[0];
+#endif
+    GridCell neighbor;
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (long long i = 0; i < num_nodes; ++i) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+          for (int dz = -1; dz <= 1; ++dz) {
+            neighbor[0] = cells[i][0] + dx;
+            neighbor[1] = cells[i][1] + dy;
+            neighbor[2] = cells[i][2] + dz;
+            const size_t bucket = hashCell(neighbor) & mask;
+            for (size_t k = bucket_start[bucket]; k < bucket_start[bucket + 1];
+                 ++k) {
+              const NodeIndex j = bucket_nodes[k];
+              if (static_cast<long long>(j) < i && cells[j] == neighbor &&
+                  (nodes[j] - nodes[i]).norm() <= tolerance) {
+                thread_pairs.push_back(std::make_pair(j, i));
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  // ]
+
+  // [join the pairs into groups rooted at their lowest node index
+  std::vector<NodeIndex> representatives(nodes.size());
+  for (size_t i = 0; i < representatives.size(); ++i) {
+    representatives[i] = i;
+  }
+  for (size_t t = 0; t < pairs.size(); ++t) {
+    for (size_t i = 0; i < pairs[t].size(); ++i) {
+      const NodeIndex root1 = findRoot(representatives, pairs[t][i].first);
+      const NodeIndex root2 = findRoot(representatives, pairs[t][i].second);
+      if (root1 < root2) {
+        representatives[root2] = root1;
+      } else {
+        representatives[root1] = root2;
+      }
+    }
+  }
+  for (size_t i = 0; i < representatives.size(); ++i) {
+    representatives[i] = findRoot(representatives, i);
+  }
+  // ]
+  return representatives;
+}
+
+std::vector<RigidBody>
+createCoincidentNodeRigidBodies(const std::vector<Node> &nodes,
+                                double tolerance,
+                                const std::vector<RigidBody> &existing) {
+  std::vector<NodeIndex> representatives =
+      findCoincidentNodes(nodes, tolerance);
+
+  // master node of the existing rigid body of each node
+  const NodeIndex none = nodes.size();
+  std::vector<NodeIndex> owner(nodes.size(), none);
+  for (size_t i = 0; i < existing.size(); ++i) {
+    const NodeIndex master = existing[i].master_node;
+    if (master >= nodes.size()) {
+      throw std::runtime_error(
+          (boost::format("Master node %d of rigid body %d does not exist.") %
+           master % i)
+              .str());
+    }
+    owner[master] = master;
+    for (size_t j = 0; j < existing[i].slave_nodes.size(); ++j) {
+      const NodeIndex slave = existing[i].slave_nodes[j];
+      if (slave >= nodes.size()) {
+        throw std::runtime_error(
+            (boost::format("Slave node %d of rigid body %d does not exist.") %
+             slave % i)
+                .str());
+      }
+      owner[slave] = master;
+    }
+  }
+
+  // the master of each group is the master of the first of its nodes that
+  // belongs to an existing rigid body, if any, and its first node otherwise
+  std::vector<NodeIndex> group_master(nodes.size(), none);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (owner[i] != none && group_master[representatives[i]] == none) {
+      group_master[representatives[i]] = owner[i];
+    }
+  }
+
+  // the remaining nodes become slaves of their group master
+  std::vector<NodeIndex> body_index(nodes.size(), none);
+  std::vector<RigidBody> bodies;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (owner[i] != none) {
+      continue;
+    }
+    const NodeIndex rep = representatives[i];
+    if (group_master[rep] == none) {
+      group_master[rep] = i;
+    }
+    const NodeIndex master = group_master[rep];
+    if (body_index[master] == none) {
+      body_index[master] = bodies.size();
+      bodies.push_back(RigidBody(master, std::vector<NodeIndex>()));
+    }
+    if (master != i) {
+      bodies[body_index[master]].slave_nodes.push_back(i);
+    }
+  }
+
+  // drop nodes without duplicates
+  std::vector<RigidBody> merged;
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    if (!bodies[i].slave_nodes.empty()) {
+      merged.push_back(bodies[i]);
+    }
+  }
+  return merged;
+}
+
+std::vector<Tie> createCoincidentNodeTies(const std::vector<Node> &nodes,
+                                          double tolerance, double lmult,
+                                          double rmult) {
+  std::vector<NodeIndex> representatives =
+      findCoincidentNodes(nodes, tolerance);
+
+  std::vector<Tie> ties;
+  for (size_t i = 0; i < representatives.size(); ++i) {
+    if (representatives[i] != i) {
+      ties.push_back(Tie(representatives[i], i, lmult, rmult));
+    }
+  }
+  return ties;
+}
+
+} // namespace fea
@@ -0,0 +1,353 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <boost/format.hpp>
+#include <exception>
+
+#include "analysis_types.h"
+#include "components.h"
+
+namespace fea {
+
+namespace {
+typedef Eigen::Matrix<double, 6, 1> ModeVector;
+typedef Eigen::Matrix<double, 6, 6> ModeMatrix;
+
+NodeIndex findRoot(std::vector<NodeIndex> &parents, NodeIndex i) {
+  while (parents[i] != i) {
+    parents[i] = parents[parents[i]];
+    i = parents[i];
+  }
+  return i;
+}
+
+void join(std::vector<NodeIndex> &parents, NodeIndex i, NodeIndex j) {
+  const NodeIndex root1 = findRoot(parents, i);
+  const NodeIndex root2 = findRoot(parents, j);
+  if (root1 < root2) {
+    parents[root2] = root1;
+  } else {
+    parents[root1] = root2;
+  }
+}
+
+void checkNode(NodeIndex node, size_t num_nodes, const char *variable,
+               size_t i) {
+  if (node >= num_nodes) {
+    throw std::runtime_error(
+        (boost::format("Entry %d of %s references node %d, which does not "
+                       "exist.") %
+         i % variable % node)
+            .str());
+  }
+}
+
+// Returns the position of `node` in the sorted node list of a component.
+NodeIndex localNode(const Component &component, NodeIndex node) {
+  return std::lower_bound(component.nodes.begin(), component.nodes.end(),
+                          node) -
+         component.nodes.begin();
+}
+
+// Value of a nodal DOF for each of the 6 rigid body modes, i.e. the
+// translations along and the rotations about the global axes through `ref`.
+// Rotations are scaled by `1 / length` to keep all values of the same order.
+ModeVector modeRow(const Node &node, unsigned int dof, const Node &ref,
+                   double length) {
+  ModeVector row = ModeVector::Zero();
+  if (dof < 3) {
+    const Eigen::Vector3d r = (node - ref) / length;
+    row(dof) = 1.0;
+    for (unsigned int k = 0; k < 3; ++k) {
+      row(3 + k) = Eigen::Vector3d::Unit(k).cross(r)(dof);
+    }
+  } else {
+    row(dof) = 1.0 / length;
+  }
+  return row;
+}
+
+void addNormalizedRow(const ModeVector &row, ModeMatrix &normal) {
+  const double norm = row.norm();
+  if (norm > 0.0) {
+    normal += (row / norm) * (row / norm).transpose();
+  }
+}
+
+unsigned int rank(const ModeMatrix &normal, const std::vector<int> &modes) {
+  Eigen::MatrixXd sub(modes.size(), modes.size());
+  for (size_t i = 0; i < modes.size(); ++i) {
+    for (size_t j = 0; j < modes.size(); ++j) {
+      sub(i, j) = normal(modes[i], modes[j]);
+    }
+  }
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(sub);
+  const Eigen::VectorXd eigenvalues = solver.eigenvalues();
+  const double tolerance = 1e-9 * eigenvalues.cwiseAbs().maxCoeff();
+  unsigned int r = 0;
+  for (int i = 0; i < eigenvalues.size(); ++i) {
+    if (eigenvalues(i) > tolerance) {
+      ++r;
+    }
+  }
+  return r;
+}
+} // namespace
+
+std::vector<Component> findComponents(const Job &job,
+                                      const std::vector<BC> &BCs,
+                                      const std::vector<Force> &forces,
+                                      const std::vector<Tie> &ties,
+                                      const std::vector<Equation> &equations,
+                                      const std::vector<RigidBody> &rigid_bodies) {
+  const size_t num_nodes = job.nodes.size();
+
+  // [join the nodes connected by elements and constraints
+  std::vector<NodeIndex> parents(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    parents[i] = i;
+  }
+  for (size_t i = 0; i < job.elems.size(); ++i) {
+    checkNode(job.elems[i][0], num_nodes, "elems", i);
+    checkNode(job.elems[i][1], num_nodes, "elems", i);
+    join(parents, job.elems[i][0], job.elems[i][1]);
+  }
+  for (size_t i = 0; i < ties.size(); ++i) {
+    checkNode(ties[i].node_number_1, num_nodes, "ties", i);
+    checkNode(ties[i].node_number_2, num_nodes, "ties", i);
+    join(parents, ties[i].node_number_1, ties[i].node_number_2);
+  }
+  for (size_t i = 0; i < equations.size(); ++i) {
+    for (size_t j = 0; j < equations[i].terms.size(); ++j) {
+      checkNode(equations[i].terms[j].node_number, num_nodes, "equations", i);
+      join(parents, equations[i].terms[0].node_number,
+           equations[i].terms[j].node_number);
+    }
+  }
+  for (size_t i = 0; i < rigid_bodies.size(); ++i) {
+    checkNode(rigid_bodies[i].master_node, num_nodes, "rigid_bodies", i);
+    for (size_t j = 0; j < rigid_bodies[i].slave_nodes.size(); ++j) {
+      checkNode(rigid_bodies[i].slave_nodes[j], num_nodes, "rigid_bodies", i);
+      join(parents, rigid_bodies[i].master_node,
+           rigid_bodies[i].slave_nodes[j]);
+    }
+  }
+  for (size_t i = 0; i < BCs.size(); ++i) {
+    checkNode(BCs[i].node, num_nodes, "bcs", i);
+  }
+  for (size_t i = 0; i < forces.size(); ++i) {
+    checkNode(forces[i].node, num_nodes, "forces", i);
+  }
+  // ]
+
+  // [number the components in the order of their lowest node
+  // `num_nodes` marks roots that have not been assigned a component yet
+  std::vector<size_t> component_of_root(num_nodes, num_nodes);
+  std::vector<size_t> component_of_node(num_nodes);
+  std::vector<Component> components;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    const NodeIndex root = findRoot(parents, i);
+    if (component_of_root[root] == num_nodes) {
+      component_of_root[root] = components.size();
+      components.push_back(Component());
+    }
+    component_of_node[i] = component_of_root[root];
+    components[component_of_node[i]].nodes.push_back(i);
+  }
+  // ]
+
+  for (size_t i = 0; i < job.elems.size(); ++i) {
+    components[component_of_node[job.elems[i][0]]].elems.push_back(i);
+  }
+  for (size_t i = 0; i < BCs.size(); ++i) {
+    components[component_of_node[BCs[i].node]].bcs.push_back(i);
+  }
+  for (size_t i = 0; i < forces.size(); ++i) {
+    components[component_of_node[forces[i].node]].forces.push_back(i);
+  }
+  for (size_t i = 0; i < ties.size(); ++i) {
+    components[component_of_node[ties[i].node_number_1]].ties.push_back(i);
+  }
+  for (size_t i = 0; i < equations.size(); ++i) {
+    // equations without terms do not belong to any node
+    const NodeIndex node = equations[i].terms.empty()
+                               ? 0
+                               : equations[i].terms[0].node_number;
+    if (!components.empty()) {
+      components[component_of_node[node]].equations.push_back(i);
+    }
+  }
+  for (size_t i = 0; i < rigid_bodies.size(); ++i) {
+    components[component_of_node[rigid_bodies[i].master_node]]
+        .rigid_bodies.push_back(i);
+  }
+  return components;
+}
+
+ComponentAnalysis
+extractComponent(const Component &component, const Job &job,
+                 const std::vector<BC> &BCs, const std::vector<Force> &forces,
+                 const std::vector<Tie> &ties,
+                 const std::vector<Equation> &equations,
+                 const std::vector<RigidBody> &rigid_bodies) {
+  ComponentAnalysis analysis;
+
+  // [nodes and elements
+  Job &sub_job = analysis.job;
+  sub_job.nodes.reserve(component.nodes.size());
+  for (size_t i = 0; i < component.nodes.size(); ++i) {
+    sub_job.nodes.push_back(job.nodes[component.nodes[i]]);
+  }
+  sub_job.elems.reserve(component.elems.size());
+  if (job.props.empty()) {
+    sub_job.sections = job.sections;
+  }
+  for (size_t i = 0; i < component.elems.size(); ++i) {
+    const size_t elem = component.elems[i];
+    sub_job.elems.push_back(
+        Connectivity(localNode(component, job.elems[elem][0]),
+                     localNode(component, job.elems[elem][1])));
+    if (!job.props.empty()) {
+      sub_job.props.push_back(job.props[elem]);
+    } else {
+      sub_job.section_ids.push_back(job.section_ids[elem]);
+      if (!job.orientations.empty()) {
+        sub_job.orientations.push_back(job.orientations[elem]);
+      }
+    }
+  }
+  // ]
+
+  // [constraints and loads
+  for (size_t i = 0; i < component.bcs.size(); ++i) {
+    BC bc = BCs[component.bcs[i]];
+    bc.node = localNode(component, bc.node);
+    analysis.bcs.push_back(bc);
+  }
+  for (size_t i = 0; i < component.forces.size(); ++i) {
+    Force force = forces[component.forces[i]];
+    force.node = localNode(component, force.node);
+    analysis.forces.push_back(force);
+  }
+  for (size_t i = 0; i < component.ties.size(); ++i) {
+    Tie tie = ties[component.ties[i]];
+    tie.node_number_1 = localNode(component, tie.node_number_1);
+    tie.node_number_2 = localNode(component, tie.node_number_2);
+    analysis.ties.push_back(tie);
+  }
+  for (size_t i = 0; i < component.equations.size(); ++i) {
+    Equation eqn = equations[component.equations[i]];
+    for (size_t j = 0; j < eqn.terms.size(); ++j) {
+      eqn.terms[j].node_number =
+          localNode(component, eqn.terms[j].node_number);
+    }
+    analysis.equations.push_back(eqn);
+  }
+  for (size_t i = 0; i < component.rigid_bodies.size(); ++i) {
+    RigidBody body = rigid_bodies[component.rigid_bodies[i]];
+    body.master_node = localNode(component, body.master_node);
+    for (size_t j = 0; j < body.slave_nodes.size(); ++j) {
+      body.slave_nodes[j] = localNode(component, body.slave_nodes[j]);
+    }
+    analysis.rigid_bodies.push_back(body);
+  }
+  // ]
+  return analysis;
+}
+
+template <typename Config>
+unsigned int countUnrestrainedModes(const Component &component, const Job &job,
+                                    const std::vector<BC> &BCs,
+                                    const std::vector<Equation> &equations) {
+  // planar analyses only have the in-plane rigid body modes
+  std::vector<int> modes;
+  if (Config::PLANAR) {
+    modes = {DOF::DISPLACEMENT_X, DOF::DISPLACEMENT_Y, DOF::ROTATION_Z};
+  } else {
+    modes = {DOF::DISPLACEMENT_X, DOF::DISPLACEMENT_Y, DOF::DISPLACEMENT_Z,
+             DOF::ROTATION_X,     DOF::ROTATION_Y,     DOF::ROTATION_Z};
+  }
+
+  const Node &ref = job.nodes[component.nodes[0]];
+  double length = 0.0;
+  for (size_t i = 0; i < component.nodes.size(); ++i) {
+    length = std::max(length, (job.nodes[component.nodes[i]] - ref).norm());
+  }
+  if (length == 0.0) {
+    length = 1.0;
+  }
+
+  // modes that move the DOFs of the component
+  ModeMatrix dof_modes = ModeMatrix::Zero();
+  for (size_t i = 0; i < component.nodes.size(); ++i) {
+    for (unsigned int j = 0; j < Config::NUM_DOFS; ++j) {
+      addNormalizedRow(
+          modeRow(job.nodes[component.nodes[i]], Config::dof(j), ref, length),
+          dof_modes);
+    }
+  }
+
+  // modes restrained by boundary conditions and equations
+  ModeMatrix restrained = ModeMatrix::Zero();
+  for (size_t i = 0; i < component.bcs.size(); ++i) {
+    const BC &bc = BCs[component.bcs[i]];
+    addNormalizedRow(modeRow(job.nodes[bc.node], bc.dof, ref, length),
+                     restrained);
+  }
+  for (size_t i = 0; i < component.equations.size(); ++i) {
+    const Equation &eqn = equations[component.equations[i]];
+    ModeVector row = ModeVector::Zero();
+    for (size_t j = 0; j < eqn.terms.size(); ++j) {
+      if (Config::activeIndex(eqn.terms[j].dof) >= 0) {
+        row += eqn.terms[j].coefficient *
+               modeRow(job.nodes[eqn.terms[j].node_number], eqn.terms[j].dof,
+                       ref, length);
+      }
+    }
+    addNormalizedRow(row, restrained);
+  }
+
+  const unsigned int num_modes = rank(dof_modes, modes);
+  const unsigned int num_restrained =
+      restrained.isZero() ? 0 : rank(restrained, modes);
+  return num_modes > num_restrained ? num_modes - num_restrained : 0;
+}
+
+template unsigned int countUnrestrainedModes<Frame3D>(
+    const Component &, const Job &, const std::vector<BC> &,
+    const std::vector<Equation> &);
+template unsigned int countUnrestrainedModes<Frame2D>(
+    const Component &, const Job &, const std::vector<BC> &,
+    const std::vector<Equation> &);
+template unsigned int countUnrestrainedModes<Truss3D>(
+    const Component &, const Job &, const std::vector<BC> &,
+    const std::vector<Equation> &);
+template unsigned int countUnrestrainedModes<Truss2D>(
+    const Component &, const Job &, const std::vector<BC> &,
+    const std::vector<Equation> &);
+
+} // namespace fea
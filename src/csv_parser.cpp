@@ -0,0 +1,127 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "csv_parser.h"
+
+namespace fea {
+
+    MappedFile::MappedFile(const std::string &filename) : begin(nullptr), length(0), mapped(false), released(0) {
+#ifndef _WIN32
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+                length = static_cast<size_t>(st.st_size);
+                if (length > 0) {
+                    void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (addr != MAP_FAILED) {
+                        madvise(addr, length, MADV_SEQUENTIAL);
+                        begin = static_cast<const char *>(addr);
+                        mapped = true;
+                    }
+                }
+                if (mapped || length == 0) {
+                    close(fd);
+                    return;
+                }
+            }
+            close(fd);
+        }
+#endif
+        // fall back to reading the whole file
+        std::ifstream input_file(filename.c_str(), std::ios::binary);
+        if (!input_file.is_open()) {
+            throw std::runtime_error(
+                    (boost::format("Error opening file %s.") % filename).str()
+            );
+        }
+        buffer.assign(std::istreambuf_iterator<char>(input_file), std::istreambuf_iterator<char>());
+        begin = buffer.data();
+        length = buffer.size();
+    }
+
+    MappedFile::~MappedFile() {
+#ifndef _WIN32
+        if (mapped) {
+            munmap(const_cast<char *>(begin), length);
+        }
+#endif
+    }
+
+    void MappedFile::release(size_t end) {
+#ifndef _WIN32
+        if (!mapped) {
+            return;
+        }
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t num_bytes = std::min(end, length) / page_size * page_size;
+        if (num_bytes < released) {
+            // the file is read again from an earlier offset
+            released = 0;
+        }
+        if (num_bytes > released) {
+            madvise(const_cast<char *>(begin) + released, num_bytes - released, MADV_DONTNEED);
+            released = num_bytes;
+        }
+#endif
+    }
+
+    std::vector<size_t> splitLines(const char *data, size_t size, size_t num_chunks) {
+        std::vector<size_t> bounds(1, 0);
+        if (num_chunks == 0) {
+            num_chunks = 1;
+        }
+        const size_t chunk_size = size / num_chunks + 1;
+        while (bounds.back() < size) {
+            size_t end = bounds.back() + chunk_size;
+            if (end >= size) {
+                end = size;
+            }
+            else {
+                // move the boundary past the end of the current line
+                const void *newline = std::memchr(data + end, '\n', size - end);
+                end = newline ? static_cast<const char *>(newline) - data + 1 : size;
+            }
+            bounds.push_back(end);
+        }
+        if (bounds.size() == 1) {
+            bounds.push_back(0);
+        }
+        return bounds;
+    }
+
+} // namespace fea
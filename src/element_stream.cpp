@@ -0,0 +1,178 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "element_stream.h"
+
+namespace fea {
+
+    namespace {
+        /**
+         * Returns the offset of the end of the `num_rows`th row of `data` that starts at `pos`, skipping blank
+         * lines, or `size` if there are fewer rows.
+         */
+        size_t findRowsEnd(const char *data, size_t size, size_t pos, size_t num_rows) {
+            size_t num_found = 0;
+            while (pos < size && num_found < num_rows) {
+                const void *newline = std::memchr(data + pos, '\n', size - pos);
+                const size_t end = newline ? static_cast<const char *>(newline) - data + 1 : size;
+                for (size_t c = pos; c < end; ++c) {
+                    if (data[c] != ',' && data[c] != ' ' && data[c] != '\t' && data[c] != '\r' && data[c] != '\n') {
+                        ++num_found;
+                        break;
+                    }
+                }
+                pos = end;
+            }
+            return pos;
+        }
+    } // namespace
+
+    ElementStream::ElementStream(const std::string &elems_filename, const std::string &props_filename,
+                                 size_t chunk_size)
+            : elemsFile(elems_filename), propsFile(new MappedFile(props_filename)),
+              chunkSize(chunk_size > 0 ? chunk_size : 1) {
+        rewind();
+    }
+
+    ElementStream::ElementStream(const std::string &elems_filename, std::vector<Props> sections,
+                                 size_t chunk_size)
+            : elemsFile(elems_filename), sections(std::move(sections)),
+              chunkSize(chunk_size > 0 ? chunk_size : 1) {
+        rewind();
+    }
+
+    void ElementStream::rewind() {
+        numRead = 0;
+        elemsPos = 0;
+        elemsLine = 0;
+        propsPos = 0;
+        propsLine = 0;
+    }
+
+    void ElementStream::readRows(MappedFile &file, const std::string &variable, size_t num_rows,
+                                 size_t &pos, size_t &line, std::vector<double> &data,
+                                 std::vector<size_t> &row_offsets) {
+        const size_t end = findRowsEnd(file.data(), file.size(), pos, num_rows);
+        const size_t failed_line = CSVParser::parseLines(file.data() + pos, file.data() + end, data, row_offsets);
+        if (failed_line != std::numeric_limits<size_t>::max()) {
+            throw std::runtime_error(
+                    (boost::format("Error when parsing %s.\nLine %d contains a value that is not a number.") %
+                     variable % (line + failed_line + 1)).str()
+            );
+        }
+        line += std::count(file.data() + pos, file.data() + end, '\n');
+        pos = end;
+        // the rows are not read again until the stream is rewound
+        file.release(pos);
+    }
+
+    bool ElementStream::next(ElementChunk &chunk) {
+        chunk.first = numRead;
+        chunk.elems.clear();
+        chunk.props.clear();
+
+        readRows(elemsFile, "elems", chunkSize, elemsPos, elemsLine, elemsData, elemsOffsets);
+        const size_t num_elems = elemsOffsets.size() - 1;
+        if (propsFile) {
+            readRows(*propsFile, "props", num_elems, propsPos, propsLine, propsData, propsOffsets);
+            const bool props_left = num_elems == 0 && findRowsEnd(propsFile->data(), propsFile->size(),
+                                                                  propsPos, 1) != propsPos;
+            if (propsOffsets.size() != elemsOffsets.size() || props_left) {
+                throw std::runtime_error("The number of rows in elems did not match props.");
+            }
+        }
+        if (num_elems == 0) {
+            return false;
+        }
+
+        chunk.elems.resize(num_elems);
+        chunk.props.resize(num_elems);
+        for (size_t i = 0; i < num_elems; ++i) {
+            const size_t num_cols = elemsOffsets[i + 1] - elemsOffsets[i];
+            const double *row = &elemsData[elemsOffsets[i]];
+            const size_t elem = numRead + i;
+            if (propsFile) {
+                if (num_cols != 2) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in elems does not specify 2 nodal indices [nn1,nn2].") %
+                             elem).str()
+                    );
+                }
+                if (propsOffsets[i + 1] - propsOffsets[i] != 7) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d  in props does not specify the 7 property values "
+                                                   "[EA, EIz, EIy, GJ, nx, ny, nz]") % elem).str()
+                    );
+                }
+                const double *prop_row = &propsData[propsOffsets[i]];
+                Props &props = chunk.props[i];
+                props.EA = prop_row[0];
+                props.EIz = prop_row[1];
+                props.EIy = prop_row[2];
+                props.GJ = prop_row[3];
+                props.normal_vec << prop_row[4], prop_row[5], prop_row[6];
+            }
+            else {
+                if (num_cols != 3 && num_cols != 6) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in elems does not specify [nn1,nn2,section] "
+                                                   "or [nn1,nn2,section,nx,ny,nz].") % elem).str()
+                    );
+                }
+                unsigned int section_id = 0;
+                if (!CSVParser::toInteger(row[2], section_id) || section_id >= sections.size()) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in elems refers to section %g, but only %d sections "
+                                                   "were provided.") % elem % row[2] % sections.size()).str()
+                    );
+                }
+                chunk.props[i] = sections[section_id];
+                if (num_cols == 6) {
+                    chunk.props[i].normal_vec << row[3], row[4], row[5];
+                }
+            }
+            NodeIndex nodes[2] = {};
+            for (int j = 0; j < 2; ++j) {
+                if (!CSVParser::toInteger(row[j], nodes[j])) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in elems refers to node %g, which is not a valid node index.") %
+                             elem % row[j]).str()
+                    );
+                }
+            }
+            chunk.elems[i] << nodes[0], nodes[1];
+        }
+        numRead += num_elems;
+        return true;
+    }
+
+} // namespace fea
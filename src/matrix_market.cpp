@@ -0,0 +1,124 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <boost/format.hpp>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "matrix_market.h"
+
+namespace fea {
+
+    namespace {
+        /**
+         * Buffers text output and writes it to the file in chunks of about 1MB.
+         */
+        class ChunkedTextWriter {
+        public:
+            ChunkedTextWriter(const std::string &_filename) : filename(_filename), output_file(_filename.c_str()) {
+                if (!output_file.is_open()) {
+                    throw std::runtime_error(
+                            (boost::format("Error opening file %s") % filename).str()
+                    );
+                }
+                buffer.reserve(1 << 20);
+            }
+
+            void append(const char *text, int length) {
+                buffer.append(text, length);
+                if (buffer.size() >= (1 << 20)) {
+                    output_file.write(buffer.data(), buffer.size());
+                    buffer.clear();
+                }
+            }
+
+            void close() {
+                output_file.write(buffer.data(), buffer.size());
+                buffer.clear();
+                output_file.close();
+                if (!output_file) {
+                    throw std::runtime_error(
+                            (boost::format("Error writing file %s") % filename).str()
+                    );
+                }
+            }
+
+        private:
+            std::string filename;
+            std::ofstream output_file;
+            std::string buffer;
+        };
+    }
+
+    void writeMatrixMarket(const std::string &filename, const SparseMat &matrix, StorageIndex num_rows,
+                           StorageIndex num_cols) {
+        // the header holds the number of nonzeros of the block, so they are counted first
+        long long num_nonzeros = 0;
+        for (StorageIndex j = 0; j < num_cols; ++j) {
+            for (SparseMat::InnerIterator it(matrix, j); it; ++it) {
+                if (it.row() < num_rows) {
+                    ++num_nonzeros;
+                }
+            }
+        }
+
+        ChunkedTextWriter writer(filename);
+        char line[96];
+        int length = std::snprintf(line, sizeof(line), "%%%%MatrixMarket matrix coordinate real general\n"
+                "%lld %lld %lld\n", static_cast<long long>(num_rows), static_cast<long long>(num_cols),
+                                   num_nonzeros);
+        writer.append(line, length);
+        for (StorageIndex j = 0; j < num_cols; ++j) {
+            for (SparseMat::InnerIterator it(matrix, j); it; ++it) {
+                if (it.row() < num_rows) {
+                    length = std::snprintf(line, sizeof(line), "%lld %lld %.17g\n",
+                                           static_cast<long long>(it.row()) + 1, static_cast<long long>(j) + 1,
+                                           it.value());
+                    writer.append(line, length);
+                }
+            }
+        }
+        writer.close();
+    }
+
+    void writeMatrixMarket(const std::string &filename, const SparseMat &matrix) {
+        writeMatrixMarket(filename, matrix, matrix.rows(), matrix.cols());
+    }
+
+    void writeMatrixMarket(const std::string &filename, const ForceVector &vector) {
+        ChunkedTextWriter writer(filename);
+        char line[64];
+        int length = std::snprintf(line, sizeof(line), "%%%%MatrixMarket matrix array real general\n%lld 1\n",
+                                   static_cast<long long>(vector.size()));
+        writer.append(line, length);
+        for (Eigen::Index i = 0; i < vector.size(); ++i) {
+            length = std::snprintf(line, sizeof(line), "%.17g\n", vector(i));
+            writer.append(line, length);
+        }
+        writer.close();
+    }
+
+} // namespace fea
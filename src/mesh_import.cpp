@@ -0,0 +1,814 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <algorithm>
+#include <array>
+#include <boost/format.hpp>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "csv_parser.h"
+#include "mesh_import.h"
+
+namespace fea {
+
+    namespace {
+        const double PI = 3.14159265358979323846;
+
+        /**
+         * A field of a line as a range of characters.
+         */
+        typedef std::pair<const char *, const char *> Field;
+
+        /**
+         * Iterates over the lines of a file and splits them into fields.
+         */
+        class LineReader {
+        public:
+            LineReader(const std::string &_filename)
+                    : filename(_filename), file(_filename), pos(0), line_number(0) { };
+
+            /**
+             * Moves to the next line. Returns `false` at the end of the file.
+             */
+            bool next() {
+                if (pos >= file.size()) {
+                    return false;
+                }
+                const char *data = file.data();
+                const void *newline = std::memchr(data + pos, '\n', file.size() - pos);
+                const size_t end = newline ? static_cast<const char *>(newline) - data : file.size();
+                first = data + pos;
+                last = data + end;
+                while (last != first && (last[-1] == '\r' || last[-1] == ' ' || last[-1] == '\t')) {
+                    --last;
+                }
+                while (first != last && (*first == ' ' || *first == '\t')) {
+                    ++first;
+                }
+                pos = end + 1;
+                ++line_number;
+                return true;
+            }
+
+            /**
+             * Moves to the next line and throws if the file ends.
+             */
+            void require(const std::string &what) {
+                if (!next()) {
+                    fail((boost::format("the file ends before %s") % what).str());
+                }
+            }
+
+            bool empty() const { return first == last; }
+
+            bool startsWith(const char *prefix) const {
+                const size_t length = std::strlen(prefix);
+                return static_cast<size_t>(last - first) >= length && std::memcmp(first, prefix, length) == 0;
+            }
+
+            std::string line() const { return std::string(first, last); }
+
+            /**
+             * Splits the line at whitespace, and also at commas if `commas` is true.
+             */
+            const std::vector<Field> &split(bool commas) {
+                fields.clear();
+                const char *c = first;
+                while (c != last) {
+                    while (c != last && isSeparator(*c, commas)) {
+                        ++c;
+                    }
+                    const char *field = c;
+                    while (c != last && !isSeparator(*c, commas)) {
+                        ++c;
+                    }
+                    if (field != c) {
+                        fields.push_back(Field(field, c));
+                    }
+                }
+                return fields;
+            }
+
+            double toDouble(const Field &field) const {
+                char token[64];
+                const size_t length = field.second - field.first;
+                char *end = token;
+                if (length < sizeof(token)) {
+                    std::memcpy(token, field.first, length);
+                    token[length] = '\0';
+                    const double value = std::strtod(token, &end);
+                    if (end == token + length) {
+                        return value;
+                    }
+                }
+                fail((boost::format("\"%s\" is not a number") % std::string(field.first, field.second)).str());
+                return 0;
+            }
+
+            long long toInteger(const Field &field) const {
+                const double value = toDouble(field);
+                if (value != std::floor(value)) {
+                    fail((boost::format("\"%s\" is not an integer") % std::string(field.first, field.second)).str());
+                }
+                return static_cast<long long>(value);
+            }
+
+            void fail(const std::string &message) const {
+                throw std::runtime_error(
+                        (boost::format("Error when parsing %s.\nLine %d: %s.") % filename % line_number %
+                         message).str()
+                );
+            }
+
+        private:
+            static bool isSeparator(char c, bool commas) {
+                return c == ' ' || c == '\t' || (commas && c == ',');
+            }
+
+            std::string filename;
+            MappedFile file;
+            size_t pos; /**<Offset of the next line.*/
+            size_t line_number; /**<1-based number of the current line.*/
+            const char *first; /**<First character of the current line.*/
+            const char *last; /**<One past the last character of the current line.*/
+            std::vector<Field> fields; /**<Fields of the last call to `split`.*/
+        };
+
+        /**
+         * Maps the tags of a file to consecutive node indices.
+         */
+        class NodeMap {
+        public:
+            void add(long long tag, const Node &node, const LineReader &reader, std::vector<Node> &nodes) {
+                if (!indices.emplace(tag, static_cast<NodeIndex>(nodes.size())).second) {
+                    reader.fail((boost::format("node %d is defined more than once") % tag).str());
+                }
+                nodes.push_back(node);
+            }
+
+            /**
+             * Returns the index of node `tag` or throws naming `what`.
+             */
+            NodeIndex find(long long tag, const std::string &what) const {
+                auto found = indices.find(tag);
+                if (found == indices.end()) {
+                    throw std::runtime_error(
+                            (boost::format("%s refers to node %d, which does not exist.") % what % tag).str()
+                    );
+                }
+                return found->second;
+            }
+
+            void reserve(size_t num_nodes) { indices.reserve(num_nodes); }
+
+        private:
+            std::unordered_map<long long, NodeIndex> indices;
+        };
+
+        /**
+         * Adds a line element of physical group `physical_tag` to `job`.
+         */
+        void addGmshLine(long long tag, long long n1, long long n2, long long physical_tag, size_t num_sections,
+                         std::vector<std::pair<long long, long long> > &lines,
+                         std::vector<unsigned int> &section_ids, const LineReader &reader) {
+            unsigned int section_id = 0;
+            if (num_sections > 1) {
+                if (physical_tag < 1 || static_cast<size_t>(physical_tag) > num_sections) {
+                    reader.fail((boost::format("line %d belongs to physical group %d, but only %d sections were "
+                                                       "provided") % tag % physical_tag % num_sections).str());
+                }
+                section_id = static_cast<unsigned int>(physical_tag - 1);
+            }
+            lines.push_back(std::make_pair(n1, n2));
+            section_ids.push_back(section_id);
+        }
+
+        /**
+         * Skips the lines up to and including the line starting with `end_marker`.
+         */
+        void skipSection(LineReader &reader, const char *end_marker) {
+            do {
+                reader.require(end_marker);
+            } while (!reader.startsWith(end_marker));
+        }
+
+        std::string toUpper(const std::string &text) {
+            std::string upper(text);
+            std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) {
+                return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            });
+            return upper;
+        }
+
+        /**
+         * Keyword and parameters of an Abaqus keyword line, converted to upper case.
+         */
+        struct Keyword {
+            std::string name;
+            std::map<std::string, std::string> parameters;
+
+            bool has(const std::string &parameter) const { return parameters.count(parameter) > 0; }
+
+            std::string get(const std::string &parameter) const {
+                auto found = parameters.find(parameter);
+                return found == parameters.end() ? std::string() : found->second;
+            }
+        };
+
+        Keyword parseKeyword(const std::string &line) {
+            Keyword keyword;
+            size_t start = 1;
+            bool first = true;
+            while (start <= line.size()) {
+                size_t end = line.find(',', start);
+                if (end == std::string::npos) {
+                    end = line.size();
+                }
+                std::string field = line.substr(start, end - start);
+                field.erase(std::remove_if(field.begin(), field.end(), [](char c) {
+                    return c == ' ' || c == '\t';
+                }), field.end());
+                field = toUpper(field);
+                if (first) {
+                    keyword.name = field;
+                    first = false;
+                }
+                else if (!field.empty()) {
+                    const size_t equals = field.find('=');
+                    if (equals == std::string::npos) {
+                        keyword.parameters[field] = "";
+                    }
+                    else {
+                        keyword.parameters[field.substr(0, equals)] = field.substr(equals + 1);
+                    }
+                }
+                start = end + 1;
+            }
+            return keyword;
+        }
+
+        /**
+         * Beam section of an Abaqus file waiting for its data lines.
+         */
+        struct AbaqusSection {
+            AbaqusSection() : general(false), num_data_lines(0), normal_vec(0, 0, -1), E(0), G(0) {
+                dims.fill(0);
+            }
+
+            bool general; /**<Whether the section is a *BEAM GENERAL SECTION.*/
+            std::string elset;
+            std::string material;
+            std::string shape;
+            size_t num_data_lines;
+            std::array<double, 5> dims; /**<Dimensions, or [A, I11, I12, I22, J] of a general section.*/
+            Eigen::Vector3d normal_vec;
+            double E;
+            double G;
+        };
+
+        /**
+         * Constraint or load of an Abaqus file whose target is resolved at the end of the file.
+         */
+        struct AbaqusNodalValue {
+            std::string target;
+            unsigned int first_dof;
+            unsigned int last_dof;
+            double value;
+            size_t line_number;
+        };
+
+        /**
+         * Returns the properties of `section` given the elastic constants [E, nu] of each material.
+         */
+        Props createSectionProps(const AbaqusSection &section,
+                                 const std::map<std::string, std::pair<double, double> > &materials,
+                                 const std::string &filename) {
+            double E = section.E;
+            double G = section.G;
+            if (!section.general) {
+                auto material = materials.find(section.material);
+                if (material == materials.end()) {
+                    throw std::runtime_error(
+                            (boost::format("Error when parsing %s.\nThe beam section of elset %s refers to "
+                                                   "material %s, which has no *ELASTIC constants.") % filename %
+                             section.elset % section.material).str()
+                    );
+                }
+                E = material->second.first;
+                G = E / (2 * (1 + material->second.second));
+            }
+
+            double A, I11, I22, J;
+            const std::array<double, 5> &d = section.dims;
+            if (section.general) {
+                A = d[0];
+                I11 = d[1];
+                I22 = d[3];
+                J = d[4];
+            }
+            else if (section.shape == "RECT") {
+                A = d[0] * d[1];
+                I11 = d[0] * d[1] * d[1] * d[1] / 12;
+                I22 = d[1] * d[0] * d[0] * d[0] / 12;
+                const double a = std::max(d[0], d[1]);
+                const double b = std::min(d[0], d[1]);
+                J = a * b * b * b * (1.0 / 3 - 0.21 * b / a * (1 - b * b * b * b / (12 * a * a * a * a)));
+            }
+            else if (section.shape == "CIRC") {
+                A = PI * d[0] * d[0];
+                I11 = I22 = PI * d[0] * d[0] * d[0] * d[0] / 4;
+                J = 2 * I11;
+            }
+            else {
+                const double ri = d[0] - d[1];
+                A = PI * (d[0] * d[0] - ri * ri);
+                I11 = I22 = PI * (d[0] * d[0] * d[0] * d[0] - ri * ri * ri * ri) / 4;
+                J = 2 * I11;
+            }
+            Props props;
+            props.EA = E * A;
+            props.EIy = E * I11;
+            props.EIz = E * I22;
+            props.GJ = G * J;
+            props.normal_vec = section.normal_vec;
+            return props;
+        }
+
+        /**
+         * Appends the members of a *NSET or *ELSET data line to `set`.
+         */
+        void addSetMembers(const LineReader &reader, const std::vector<Field> &fields, bool generate,
+                           std::vector<long long> &set) {
+            if (generate) {
+                if (fields.size() < 2) {
+                    reader.fail("GENERATE expects first, last and increment");
+                }
+                const long long first = reader.toInteger(fields[0]);
+                const long long last = reader.toInteger(fields[1]);
+                const long long increment = fields.size() > 2 ? reader.toInteger(fields[2]) : 1;
+                if (increment <= 0) {
+                    reader.fail("the increment of GENERATE must be positive");
+                }
+                for (long long member = first; member <= last; member += increment) {
+                    set.push_back(member);
+                }
+            }
+            else {
+                for (size_t i = 0; i < fields.size(); ++i) {
+                    set.push_back(reader.toInteger(fields[i]));
+                }
+            }
+        }
+    }
+
+    Model readGmsh(const std::string &filename, const std::vector<Props> &sections) {
+        if (sections.empty()) {
+            throw std::runtime_error(
+                    (boost::format("No sections were provided for the lines of %s.") % filename).str()
+            );
+        }
+        LineReader reader(filename);
+        Model model;
+        NodeMap node_map;
+        std::vector<std::pair<long long, long long> > lines;
+        std::vector<unsigned int> section_ids;
+        std::unordered_map<long long, long long> curve_physical_tags;
+        int major_version = 0;
+
+        while (reader.next()) {
+            if (reader.startsWith("$MeshFormat")) {
+                reader.require("the mesh format");
+                const std::vector<Field> &fields = reader.split(false);
+                if (fields.size() < 2) {
+                    reader.fail("expected the version and file type");
+                }
+                const double version = reader.toDouble(fields[0]);
+                major_version = static_cast<int>(version);
+                if ((major_version != 2 && major_version != 4) || (major_version == 4 && version < 4.1)) {
+                    reader.fail((boost::format("version %s is not supported, save the mesh as version 2.2 or "
+                                                       "4.1") % std::string(fields[0].first, fields[0].second)).str());
+                }
+                if (reader.toInteger(fields[1]) != 0) {
+                    reader.fail("binary files are not supported, save the mesh as ASCII");
+                }
+                skipSection(reader, "$EndMeshFormat");
+            }
+            else if (reader.startsWith("$Entities")) {
+                reader.require("the entities");
+                const std::vector<Field> &counts = reader.split(false);
+                if (counts.size() < 4) {
+                    reader.fail("expected the number of points, curves, surfaces and volumes");
+                }
+                const long long num_points = reader.toInteger(counts[0]);
+                const long long num_curves = reader.toInteger(counts[1]);
+                for (long long i = 0; i < num_points; ++i) {
+                    reader.require("the points");
+                }
+                for (long long i = 0; i < num_curves; ++i) {
+                    reader.require("the curves");
+                    const std::vector<Field> &fields = reader.split(false);
+                    // tag, bounding box, number of physical tags, physical tags, ...
+                    if (fields.size() < 8) {
+                        reader.fail("expected the tag, bounding box and physical tags of a curve");
+                    }
+                    if (reader.toInteger(fields[7]) > 0 && fields.size() > 8) {
+                        curve_physical_tags[reader.toInteger(fields[0])] = reader.toInteger(fields[8]);
+                    }
+                }
+                skipSection(reader, "$EndEntities");
+            }
+            else if (reader.startsWith("$Nodes")) {
+                reader.require("the nodes");
+                const std::vector<Field> &header = reader.split(false);
+                if (major_version == 2) {
+                    const long long num_nodes = reader.toInteger(header[0]);
+                    model.job.nodes.reserve(num_nodes);
+                    node_map.reserve(num_nodes);
+                    for (long long i = 0; i < num_nodes; ++i) {
+                        reader.require("the nodes");
+                        const std::vector<Field> &fields = reader.split(false);
+                        if (fields.size() < 4) {
+                            reader.fail("expected the tag and coordinates of a node");
+                        }
+                        node_map.add(reader.toInteger(fields[0]), Node(reader.toDouble(fields[1]),
+                                                                      reader.toDouble(fields[2]),
+                                                                      reader.toDouble(fields[3])),
+                                     reader, model.job.nodes);
+                    }
+                }
+                else {
+                    if (header.size() < 2) {
+                        reader.fail("expected the number of entity blocks and nodes");
+                    }
+                    const long long num_blocks = reader.toInteger(header[0]);
+                    const long long num_nodes = reader.toInteger(header[1]);
+                    model.job.nodes.reserve(num_nodes);
+                    node_map.reserve(num_nodes);
+                    std::vector<long long> tags;
+                    for (long long b = 0; b < num_blocks; ++b) {
+                        reader.require("the node blocks");
+                        const std::vector<Field> &block = reader.split(false);
+                        if (block.size() < 4) {
+                            reader.fail("expected the header of a node block");
+                        }
+                        const long long num_block_nodes = reader.toInteger(block[3]);
+                        tags.resize(num_block_nodes);
+                        for (long long i = 0; i < num_block_nodes; ++i) {
+                            reader.require("the node tags");
+                            tags[i] = reader.toInteger(reader.split(false).at(0));
+                        }
+                        for (long long i = 0; i < num_block_nodes; ++i) {
+                            reader.require("the node coordinates");
+                            const std::vector<Field> &fields = reader.split(false);
+                            if (fields.size() < 3) {
+                                reader.fail("expected the coordinates of a node");
+                            }
+                            node_map.add(tags[i], Node(reader.toDouble(fields[0]), reader.toDouble(fields[1]),
+                                                       reader.toDouble(fields[2])), reader, model.job.nodes);
+                        }
+                    }
+                }
+                skipSection(reader, "$EndNodes");
+            }
+            else if (reader.startsWith("$Elements")) {
+                reader.require("the elements");
+                const std::vector<Field> &header = reader.split(false);
+                if (major_version == 2) {
+                    const long long num_elems = reader.toInteger(header[0]);
+                    for (long long i = 0; i < num_elems; ++i) {
+                        reader.require("the elements");
+                        const std::vector<Field> &fields = reader.split(false);
+                        if (fields.size() < 3) {
+                            reader.fail("expected the tag, type and tags of an element");
+                        }
+                        if (reader.toInteger(fields[1]) != 1) {
+                            continue;
+                        }
+                        const size_t num_tags = reader.toInteger(fields[2]);
+                        if (fields.size() < 5 + num_tags) {
+                            reader.fail("expected the 2 nodes of a line");
+                        }
+                        const long long physical_tag = num_tags > 0 ? reader.toInteger(fields[3]) : 0;
+                        addGmshLine(reader.toInteger(fields[0]), reader.toInteger(fields[3 + num_tags]),
+                                    reader.toInteger(fields[4 + num_tags]), physical_tag, sections.size(),
+                                    lines, section_ids, reader);
+                    }
+                }
+                else {
+                    const long long num_blocks = reader.toInteger(header[0]);
+                    for (long long b = 0; b < num_blocks; ++b) {
+                        reader.require("the element blocks");
+                        const std::vector<Field> &block = reader.split(false);
+                        if (block.size() < 4) {
+                            reader.fail("expected the header of an element block");
+                        }
+                        const long long entity_tag = reader.toInteger(block[1]);
+                        const bool is_line = reader.toInteger(block[0]) == 1 && reader.toInteger(block[2]) == 1;
+                        const long long num_block_elems = reader.toInteger(block[3]);
+                        auto physical = curve_physical_tags.find(entity_tag);
+                        const long long physical_tag = physical == curve_physical_tags.end() ? 0
+                                                                                             : physical->second;
+                        for (long long i = 0; i < num_block_elems; ++i) {
+                            reader.require("the elements");
+                            if (!is_line) {
+                                continue;
+                            }
+                            const std::vector<Field> &fields = reader.split(false);
+                            if (fields.size() < 3) {
+                                reader.fail("expected the tag and 2 nodes of a line");
+                            }
+                            addGmshLine(reader.toInteger(fields[0]), reader.toInteger(fields[1]),
+                                        reader.toInteger(fields[2]), physical_tag, sections.size(), lines,
+                                        section_ids, reader);
+                        }
+                    }
+                }
+                skipSection(reader, "$EndElements");
+            }
+        }
+        if (major_version == 0) {
+            throw std::runtime_error(
+                    (boost::format("%s is not a Gmsh mesh file.") % filename).str()
+            );
+        }
+
+        std::vector<Connectivity> elems(lines.size());
+        for (size_t i = 0; i < lines.size(); ++i) {
+            const std::string what = (boost::format("Line %d of %s") % i % filename).str();
+            elems[i] << node_map.find(lines[i].first, what), node_map.find(lines[i].second, what);
+        }
+        model.job = Job(std::move(model.job.nodes), std::move(elems), sections, std::move(section_ids));
+        return model;
+    }
+
+    Model readAbaqus(const std::string &filename) {
+        LineReader reader(filename);
+        Model model;
+        NodeMap node_map;
+        std::vector<long long> elem_labels;
+        std::vector<std::pair<long long, long long> > elem_nodes;
+        std::map<std::string, std::vector<long long> > nsets;
+        std::map<std::string, std::vector<long long> > elsets;
+        std::map<std::string, std::pair<double, double> > materials;
+        std::vector<AbaqusSection> sections;
+        std::vector<AbaqusNodalValue> boundaries;
+        std::vector<AbaqusNodalValue> loads;
+
+        Keyword keyword;
+        std::string material;
+        while (reader.next()) {
+            if (reader.empty() || reader.startsWith("**")) {
+                continue;
+            }
+            if (reader.startsWith("*")) {
+                keyword = parseKeyword(reader.line());
+                if (keyword.name == "MATERIAL") {
+                    material = keyword.get("NAME");
+                }
+                else if (keyword.name == "ELEMENT") {
+                    const std::string type = keyword.get("TYPE");
+                    if (type != "B31" && type != "B33") {
+                        reader.fail((boost::format("element type %s is not supported, only B31 and B33 beams "
+                                                           "are") % type).str());
+                    }
+                }
+                else if (keyword.name == "BEAMSECTION" || keyword.name == "BEAMGENERALSECTION") {
+                    AbaqusSection section;
+                    section.general = keyword.name == "BEAMGENERALSECTION";
+                    section.elset = keyword.get("ELSET");
+                    section.material = keyword.get("MATERIAL");
+                    section.shape = keyword.has("SECTION") ? keyword.get("SECTION") : "GENERAL";
+                    const bool supported = section.general ? section.shape == "GENERAL"
+                                                           : section.shape == "RECT" || section.shape == "CIRC" ||
+                                                             section.shape == "PIPE";
+                    if (!supported) {
+                        reader.fail((boost::format("beam section %s is not supported") % section.shape).str());
+                    }
+                    sections.push_back(section);
+                }
+                continue;
+            }
+
+            // data line of the current keyword
+            const std::vector<Field> &fields = reader.split(true);
+            if (keyword.name == "NODE") {
+                if (fields.size() < 3) {
+                    reader.fail("expected the label and coordinates of a node");
+                }
+                const long long label = reader.toInteger(fields[0]);
+                node_map.add(label, Node(reader.toDouble(fields[1]), reader.toDouble(fields[2]),
+                                         fields.size() > 3 ? reader.toDouble(fields[3]) : 0.0),
+                             reader, model.job.nodes);
+                if (keyword.has("NSET")) {
+                    nsets[keyword.get("NSET")].push_back(label);
+                }
+            }
+            else if (keyword.name == "ELEMENT") {
+                if (fields.size() != 3) {
+                    reader.fail("expected the label and 2 nodes of a beam element");
+                }
+                const long long label = reader.toInteger(fields[0]);
+                elem_labels.push_back(label);
+                elem_nodes.push_back(std::make_pair(reader.toInteger(fields[1]), reader.toInteger(fields[2])));
+                if (keyword.has("ELSET")) {
+                    elsets[keyword.get("ELSET")].push_back(label);
+                }
+            }
+            else if (keyword.name == "NSET") {
+                addSetMembers(reader, fields, keyword.has("GENERATE"), nsets[keyword.get("NSET")]);
+            }
+            else if (keyword.name == "ELSET") {
+                addSetMembers(reader, fields, keyword.has("GENERATE"), elsets[keyword.get("ELSET")]);
+            }
+            else if (keyword.name == "ELASTIC") {
+                if (fields.size() < 2) {
+                    reader.fail("expected Young's modulus and Poisson's ratio");
+                }
+                materials[material] = std::make_pair(reader.toDouble(fields[0]), reader.toDouble(fields[1]));
+            }
+            else if (keyword.name == "BEAMSECTION" || keyword.name == "BEAMGENERALSECTION") {
+                AbaqusSection &section = sections.back();
+                const size_t num_dims = section.general ? 5 : (section.shape == "CIRC" ? 1 : 2);
+                if (section.num_data_lines == 0) {
+                    if (fields.size() < num_dims) {
+                        reader.fail((boost::format("expected %d section dimensions") % num_dims).str());
+                    }
+                    for (size_t i = 0; i < num_dims; ++i) {
+                        section.dims[i] = reader.toDouble(fields[i]);
+                    }
+                }
+                else if (section.num_data_lines == 1) {
+                    if (fields.size() < 3) {
+                        reader.fail("expected the 1-direction of the section");
+                    }
+                    section.normal_vec << reader.toDouble(fields[0]), reader.toDouble(fields[1]),
+                            reader.toDouble(fields[2]);
+                }
+                else if (section.num_data_lines == 2 && section.general) {
+                    if (fields.size() < 2) {
+                        reader.fail("expected Young's modulus and the shear modulus");
+                    }
+                    section.E = reader.toDouble(fields[0]);
+                    section.G = reader.toDouble(fields[1]);
+                }
+                ++section.num_data_lines;
+            }
+            else if (keyword.name == "BOUNDARY" || keyword.name == "CLOAD") {
+                if (fields.size() < 2) {
+                    reader.fail("expected a node or node set and a degree of freedom");
+                }
+                AbaqusNodalValue nodal_value;
+                nodal_value.target = toUpper(std::string(fields[0].first, fields[0].second));
+                nodal_value.value = 0;
+                nodal_value.line_number = 0;
+                const std::string type = toUpper(std::string(fields[1].first, fields[1].second));
+                if (keyword.name == "BOUNDARY" && (type == "ENCASTRE" || type == "PINNED")) {
+                    nodal_value.first_dof = 1;
+                    nodal_value.last_dof = type == "ENCASTRE" ? 6 : 3;
+                }
+                else {
+                    nodal_value.first_dof = static_cast<unsigned int>(reader.toInteger(fields[1]));
+                    if (keyword.name == "BOUNDARY") {
+                        nodal_value.last_dof = fields.size() > 2 ? static_cast<unsigned int>(
+                                reader.toInteger(fields[2])) : nodal_value.first_dof;
+                        nodal_value.value = fields.size() > 3 ? reader.toDouble(fields[3]) : 0.0;
+                    }
+                    else {
+                        if (fields.size() < 3) {
+                            reader.fail("expected the magnitude of the load");
+                        }
+                        nodal_value.last_dof = nodal_value.first_dof;
+                        nodal_value.value = reader.toDouble(fields[2]);
+                    }
+                }
+                if (nodal_value.first_dof < 1 || nodal_value.last_dof > DOF::NUM_DOFS ||
+                    nodal_value.first_dof > nodal_value.last_dof) {
+                    reader.fail("degrees of freedom must lie between 1 and 6");
+                }
+                (keyword.name == "BOUNDARY" ? boundaries : loads).push_back(nodal_value);
+            }
+        }
+
+        // [resolve labels and sets now that the whole file has been read
+        std::unordered_map<long long, size_t> elem_indices;
+        elem_indices.reserve(elem_labels.size());
+        std::vector<Connectivity> elems(elem_labels.size());
+        for (size_t i = 0; i < elem_labels.size(); ++i) {
+            if (!elem_indices.emplace(elem_labels[i], i).second) {
+                throw std::runtime_error(
+                        (boost::format("Error when parsing %s.\nElement %d is defined more than once.") %
+                         filename % elem_labels[i]).str()
+                );
+            }
+            const std::string what = (boost::format("Element %d of %s") % elem_labels[i] % filename).str();
+            elems[i] << node_map.find(elem_nodes[i].first, what), node_map.find(elem_nodes[i].second, what);
+        }
+
+        const unsigned int no_section = std::numeric_limits<unsigned int>::max();
+        std::vector<unsigned int> section_ids(elems.size(), no_section);
+        std::vector<Props> section_props;
+        for (size_t s = 0; s < sections.size(); ++s) {
+            section_props.push_back(createSectionProps(sections[s], materials, filename));
+            const std::vector<long long> &elset = elsets[sections[s].elset];
+            for (size_t i = 0; i < elset.size(); ++i) {
+                auto found = elem_indices.find(elset[i]);
+                if (found != elem_indices.end()) {
+                    section_ids[found->second] = static_cast<unsigned int>(s);
+                }
+            }
+        }
+        for (size_t i = 0; i < section_ids.size(); ++i) {
+            if (section_ids[i] == no_section) {
+                throw std::runtime_error(
+                        (boost::format("Error when parsing %s.\nElement %d is not assigned a beam section.") %
+                         filename % elem_labels[i]).str()
+                );
+            }
+        }
+
+        auto forEachNode = [&](const AbaqusNodalValue &nodal_value, const std::function<void(NodeIndex)> &add) {
+            auto nset = nsets.find(nodal_value.target);
+            const std::string what = (boost::format("A constraint or load of %s") % filename).str();
+            if (nset != nsets.end()) {
+                for (size_t i = 0; i < nset->second.size(); ++i) {
+                    add(node_map.find(nset->second[i], what));
+                }
+                return;
+            }
+            char *end;
+            const long long label = std::strtoll(nodal_value.target.c_str(), &end, 10);
+            if (*end != '\0' || nodal_value.target.empty()) {
+                throw std::runtime_error(
+                        (boost::format("Error when parsing %s.\nNode set %s does not exist.") % filename %
+                         nodal_value.target).str()
+                );
+            }
+            add(node_map.find(label, what));
+        };
+        for (size_t i = 0; i < boundaries.size(); ++i) {
+            const AbaqusNodalValue &boundary = boundaries[i];
+            forEachNode(boundary, [&model, &boundary](NodeIndex node) {
+                for (unsigned int dof = boundary.first_dof; dof <= boundary.last_dof; ++dof) {
+                    model.bcs.push_back(BC(node, dof - 1, boundary.value));
+                }
+            });
+        }
+        for (size_t i = 0; i < loads.size(); ++i) {
+            const AbaqusNodalValue &load = loads[i];
+            forEachNode(load, [&model, &load](NodeIndex node) {
+                model.forces.push_back(Force(node, load.first_dof - 1, load.value));
+            });
+        }
+        // ]
+
+        model.job = Job(std::move(model.job.nodes), std::move(elems), std::move(section_props),
+                        std::move(section_ids));
+        return model;
+    }
+
+    Model readMesh(const std::string &filename, const std::vector<Props> &sections) {
+        const std::string extension = filename.size() >= 4 ? toUpper(filename.substr(filename.size() - 4)) : "";
+        if (extension == ".MSH") {
+            return readGmsh(filename, sections);
+        }
+        if (extension == ".INP") {
+            return readAbaqus(filename);
+        }
+        throw std::runtime_error(
+                (boost::format("Cannot read mesh %s: only Gmsh .msh and Abaqus .inp files are supported.") %
+                 filename).str()
+        );
+    }
+
+} // namespace fea
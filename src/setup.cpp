@@ -25,36 +25,379 @@
 
 
 #include "boost/format.hpp"
+#include <chrono>
 #include <exception>
+#include <functional>
+#include <limits>
+#include <rapidjson/error/en.h>
+#include <type_traits>
+#include "binary_io.h"
+#include "element_stream.h"
+#include "mesh_import.h"
 #include "setup.h"
 
 namespace fea {
 
     namespace {
         template<typename T>
-        void createVectorFromJSON(const rapidjson::Document &config_doc,
-                                  const std::string &variable,
-                                  std::vector< std::vector<T> > &data) {
+        bool getInlineNumber(const rapidjson::Value &value, T &out, std::true_type) {
+            out = static_cast<T>(value.GetDouble());
+            return true;
+        }
+
+        template<typename T>
+        bool getInlineNumber(const rapidjson::Value &value, T &out, std::false_type) {
+            // values written as floating point numbers must still be integers as in the csv parser
+            if (value.IsUint64() && value.GetUint64() <= std::numeric_limits<T>::max()) {
+                out = static_cast<T>(value.GetUint64());
+                return true;
+            }
+            return CSVParser::toInteger(value.GetDouble(), out);
+        }
+
+        /**
+         * Appends `value`, found in row `i` of the inline array `variable`, to `data`.
+         */
+        template<typename T>
+        void appendInlineNumber(const rapidjson::Value &value, rapidjson::SizeType i, const std::string &variable,
+                                std::vector<T> &data) {
+            if (!value.IsNumber()) {
+                throw std::runtime_error(
+                        (boost::format("Row %d of the inline array %s contains a value that is not a "
+                                               "number.") % i % variable).str()
+                );
+            }
+            T number = T();
+            if (!getInlineNumber(value, number, std::is_floating_point<T>())) {
+                throw std::runtime_error(
+                        (boost::format("Row %d of the inline array %s contains %g, which is not a valid index.") %
+                         i % variable % value.GetDouble()).str()
+                );
+            }
+            data.push_back(number);
+        }
+
+        /**
+         * Returns `value`, read from row `i` of `variable`, as an index such as a node number or a DOF. Throws if it
+         * is fractional or negative.
+         */
+        template<typename T>
+        T toIndex(double value, size_t i, const std::string &variable) {
+            T index = 0;
+            if (!CSVParser::toInteger(value, index)) {
+                throw std::runtime_error(
+                        (boost::format("Row %d in %s refers to %g, which is not a valid index.") %
+                         i % variable % value).str()
+                );
+            }
+            return index;
+        }
+
+        /**
+         * Copies an inline array of the configuration document into a flat array. Each element of `array` is
+         * either an array holding the values of one row, or a number forming a row on its own.
+         */
+        template<typename T>
+        void parseInlineArray(const rapidjson::Value &array,
+                              const std::string &variable,
+                              std::vector<T> &data,
+                              std::vector<size_t> &row_offsets) {
+            size_t num_values = 0;
+            for (rapidjson::SizeType i = 0; i < array.Size(); ++i) {
+                num_values += array[i].IsArray() ? array[i].Size() : 1;
+            }
+            data.clear();
+            data.reserve(num_values);
+            row_offsets.resize(array.Size() + 1);
+            row_offsets[0] = 0;
+
+            for (rapidjson::SizeType i = 0; i < array.Size(); ++i) {
+                const rapidjson::Value &row = array[i];
+                if (row.IsNumber()) {
+                    appendInlineNumber(row, i, variable, data);
+                }
+                else if (row.IsArray()) {
+                    for (rapidjson::SizeType j = 0; j < row.Size(); ++j) {
+                        appendInlineNumber(row[j], i, variable, data);
+                    }
+                }
+                else {
+                    throw std::runtime_error(
+                            (boost::format("Row %d of the inline array %s is neither a number nor an array.") %
+                             i % variable).str()
+                    );
+                }
+                row_offsets[i + 1] = data.size();
+            }
+        }
+
+        template<typename T>
+        void createArrayFromJSON(const rapidjson::Document &config_doc,
+                                 const std::string &variable,
+                                 std::vector<T> &data,
+                                 std::vector<size_t> &row_offsets) {
             if (!config_doc.HasMember(variable.c_str())) {
                 throw std::runtime_error(
                         (boost::format("Configuration file does not have requested member variable %s.") %
                          variable).str()
                 );
             }
-            if (!config_doc[variable.c_str()].IsString()) {
+            const rapidjson::Value &value = config_doc[variable.c_str()];
+            if (value.IsArray()) {
+                parseInlineArray(value, variable, data, row_offsets);
+            }
+            else if (!value.IsString()) {
                 throw std::runtime_error(
-                        (boost::format("Value associated with variable %s is not a string.") % variable).str()
+                        (boost::format("Value associated with variable %s is not a string or an array.") %
+                         variable).str()
                 );
             }
-            CSVParser csv;
-            std::string filename(config_doc[variable.c_str()].GetString());
-            csv.parseToVector(filename, data);
-            if (data.size() == 0) {
+            else {
+                std::string filename(value.GetString());
+                const std::string extension = filename.size() >= 4 ? filename.substr(filename.size() - 4) : "";
+                if (extension == ".npy" || extension == ".npz") {
+                    readNumpyArray(filename, variable, data, row_offsets);
+                }
+                else {
+                    CSVParser csv;
+                    csv.parseToArray(filename, data, row_offsets);
+                }
+            }
+            if (row_offsets.size() < 2) {
                 throw std::runtime_error(
                         (boost::format("No data was loaded for variable %s.") % variable).str()
                 );
             }
         }
+
+        /**
+         * Throws if any row of a flat array does not have `num_cols` values.
+         */
+        void checkNumCols(const std::vector<size_t> &row_offsets, size_t num_cols, const std::string &message) {
+            for (size_t i = 0; i + 1 < row_offsets.size(); ++i) {
+                if (row_offsets[i + 1] - row_offsets[i] != num_cols) {
+                    throw std::runtime_error((boost::format(message) % i).str());
+                }
+            }
+        }
+
+        Props createPropsFromRow(const double *row, size_t num_cols, size_t i, const std::string &variable) {
+            if (num_cols != 7) {
+                throw std::runtime_error(
+                        (boost::format("Row %d  in %s does not specify the 7 property values "
+                                               "[EA, EIz, EIy, GJ, nx, ny, nz]") % i % variable).str()
+                );
+            }
+            Props p;
+            p.EA = row[0];
+            p.EIz = row[1];
+            p.EIy = row[2];
+            p.GJ = row[3];
+            p.normal_vec << row[4], row[5], row[6];
+            return p;
+        }
+
+        void createSectionElems(const std::vector<double> &elems_flat,
+                                const std::vector<size_t> &row_offsets,
+                                const std::vector<Props> &sections,
+                                std::vector<Connectivity> &elems,
+                                std::vector<unsigned int> &section_ids,
+                                std::vector<Eigen::Vector3d> &orientations) {
+            const size_t num_elems = row_offsets.size() - 1;
+            elems.resize(num_elems);
+            section_ids.resize(num_elems);
+            orientations.clear();
+
+            for (size_t i = 0; i < num_elems; ++i) {
+                const size_t num_cols = row_offsets[i + 1] - row_offsets[i];
+                const double *row = &elems_flat[row_offsets[i]];
+                if (num_cols != 3 && num_cols != 6) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in elems does not specify [nn1,nn2,section] "
+                                                   "or [nn1,nn2,section,nx,ny,nz].") % i).str()
+                    );
+                }
+                const unsigned int section_id = toIndex<unsigned int>(row[2], i, "elems");
+                if (section_id >= sections.size()) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in elems refers to section %d, but only %d sections "
+                                                   "were provided.") % i % section_id % sections.size()).str()
+                    );
+                }
+                elems[i] << toIndex<NodeIndex>(row[0], i, "elems"), toIndex<NodeIndex>(row[1], i, "elems");
+                section_ids[i] = section_id;
+
+                if (num_cols == 6) {
+                    // switch to per-element orientations the first time one is given
+                    if (orientations.empty()) {
+                        orientations.resize(num_elems);
+                        for (size_t j = 0; j < i; ++j) {
+                            orientations[j] = sections[section_ids[j]].normal_vec;
+                        }
+                    }
+                    orientations[i] << row[3], row[4], row[5];
+                }
+                else if (!orientations.empty()) {
+                    orientations[i] = sections[section_id].normal_vec;
+                }
+            }
+        }
+
+        void createSectionElemsFromJSON(const rapidjson::Document &config_doc,
+                                        const std::vector<Props> &sections,
+                                        std::vector<Connectivity> &elems,
+                                        std::vector<unsigned int> &section_ids,
+                                        std::vector<Eigen::Vector3d> &orientations) {
+            std::vector<double> elems_flat;
+            std::vector<size_t> row_offsets;
+            fea::createArrayFromJSON(config_doc, "elems", elems_flat, row_offsets);
+            createSectionElems(elems_flat, row_offsets, sections, elems, section_ids, orientations);
+        }
+
+        /**
+         * Fills the connectivity and properties of each element from the flat "elems" and "props" arrays.
+         */
+        void createElems(const std::vector<NodeIndex> &elems_flat,
+                         const std::vector<size_t> &elem_offsets,
+                         const std::vector<double> &props_flat,
+                         const std::vector<size_t> &prop_offsets,
+                         std::vector<Connectivity> &elems,
+                         std::vector<Props> &props) {
+            if (elem_offsets.size() != prop_offsets.size()) {
+                throw std::runtime_error("The number of rows in elems did not match props.");
+            }
+            checkNumCols(elem_offsets, 2, "Row %d in elems does not specify 2 nodal indices [nn1,nn2].");
+            checkNumCols(prop_offsets, 7, "Row %d  in props does not specify the 7 property values "
+                    "[EA, EIz, EIy, GJ, nx, ny, nz]");
+
+            const size_t num_elems = elem_offsets.size() - 1;
+            elems.resize(num_elems);
+            props.resize(num_elems);
+            for (size_t i = 0; i < num_elems; ++i) {
+                const double *row = &props_flat[7 * i];
+                props[i].EA = row[0];
+                props[i].EIz = row[1];
+                props[i].EIy = row[2];
+                props[i].GJ = row[3];
+                props[i].normal_vec << row[4], row[5], row[6];
+                elems[i] << elems_flat[2 * i], elems_flat[2 * i + 1];
+            }
+        }
+
+        /**
+         * Arrays of the job read by separate load tasks.
+         */
+        struct JobArrays {
+            std::vector<Node> nodes;
+            std::vector<Props> sections;
+            std::vector<double> section_elems_flat;
+            std::vector<NodeIndex> elems_flat;
+            std::vector<double> props_flat;
+            std::vector<size_t> elem_offsets;
+            std::vector<size_t> prop_offsets;
+        };
+
+        /**
+         * Returns the value of "element_chunk_size", or 0 if the elements are not streamed.
+         */
+        size_t getElementChunkSize(const rapidjson::Document &config_doc) {
+            if (!config_doc.HasMember("element_chunk_size")) {
+                return 0;
+            }
+            if (!config_doc["element_chunk_size"].IsUint64() || config_doc["element_chunk_size"].GetUint64() == 0) {
+                throw std::runtime_error("Value associated with variable element_chunk_size is not a positive "
+                                                 "integer.");
+            }
+            return static_cast<size_t>(config_doc["element_chunk_size"].GetUint64());
+        }
+
+        /**
+         * Returns the csv file named by `variable`. Streamed elements can only be read from csv files.
+         */
+        std::string getStreamedFilename(const rapidjson::Document &config_doc, const std::string &variable) {
+            if (!config_doc.HasMember(variable.c_str())) {
+                throw std::runtime_error(
+                        (boost::format("Configuration file does not have requested member variable %s.") %
+                         variable).str()
+                );
+            }
+            const rapidjson::Value &value = config_doc[variable.c_str()];
+            const std::string filename = value.IsString() ? value.GetString() : "";
+            const std::string extension = filename.size() >= 4 ? filename.substr(filename.size() - 4) : "";
+            if (!value.IsString() || extension == ".npy" || extension == ".npz") {
+                throw std::runtime_error(
+                        (boost::format("Value associated with variable %s must name a csv file when "
+                                               "element_chunk_size is given.") % variable).str()
+                );
+            }
+            return filename;
+        }
+
+        /**
+         * Reads the mesh file named by "mesh". The optional "sections" are the properties of the Gmsh physical
+         * groups.
+         */
+        Model readMeshFromJSON(const rapidjson::Document &config_doc) {
+            if (!config_doc["mesh"].IsString()) {
+                throw std::runtime_error("Value associated with variable mesh is not a string.");
+            }
+            std::vector<Props> sections;
+            if (config_doc.HasMember("sections")) {
+                sections = createSectionVecFromJSON(config_doc);
+            }
+            return readMesh(config_doc["mesh"].GetString(), sections);
+        }
+
+        /**
+         * Adds the tasks that load the arrays of the job. Only the nodes and sections are loaded if the elements
+         * are streamed.
+         */
+        void addJobLoadTasks(const rapidjson::Document &config_doc, bool stream_elements, JobArrays &arrays,
+                             std::vector<LoadTask> &tasks) {
+            tasks.push_back(LoadTask("nodes", [&config_doc, &arrays]() {
+                arrays.nodes = createNodeVecFromJSON(config_doc);
+            }));
+            if (config_doc.HasMember("sections")) {
+                tasks.push_back(LoadTask("sections", [&config_doc, &arrays]() {
+                    arrays.sections = createSectionVecFromJSON(config_doc);
+                }));
+            }
+            if (stream_elements) {
+                return;
+            }
+            if (config_doc.HasMember("sections")) {
+                tasks.push_back(LoadTask("elems", [&config_doc, &arrays]() {
+                    fea::createArrayFromJSON(config_doc, "elems", arrays.section_elems_flat, arrays.elem_offsets);
+                }));
+            }
+            else {
+                tasks.push_back(LoadTask("elems", [&config_doc, &arrays]() {
+                    fea::createArrayFromJSON(config_doc, "elems", arrays.elems_flat, arrays.elem_offsets);
+                }));
+                tasks.push_back(LoadTask("props", [&config_doc, &arrays]() {
+                    fea::createArrayFromJSON(config_doc, "props", arrays.props_flat, arrays.prop_offsets);
+                }));
+            }
+        }
+
+        Job createJobFromArrays(const rapidjson::Document &config_doc, JobArrays &arrays) {
+            Job job;
+            job.nodes.swap(arrays.nodes);
+            if (arrays.elem_offsets.empty()) {
+                // the elements are streamed
+                return job;
+            }
+            if (config_doc.HasMember("sections")) {
+                createSectionElems(arrays.section_elems_flat, arrays.elem_offsets, arrays.sections, job.elems,
+                                   job.section_ids, job.orientations);
+                job.sections.swap(arrays.sections);
+            }
+            else {
+                createElems(arrays.elems_flat, arrays.elem_offsets, arrays.props_flat, arrays.prop_offsets,
+                            job.elems, job.props);
+            }
+            return job;
+        }
     }
 
     rapidjson::Document parseJSONConfig(const std::string &config_filename) {
@@ -71,146 +414,318 @@ namespace fea {
         rapidjson::FileReadStream config_stream(config_file_ptr, readBuffer, sizeof(readBuffer));
         config_doc.ParseStream(config_stream);
         fclose(config_file_ptr);
+        if (config_doc.HasParseError()) {
+            throw std::runtime_error(
+                    (boost::format("Error parsing configuration input file %s at offset %d: %s") % config_filename %
+                     config_doc.GetErrorOffset() % rapidjson::GetParseError_En(config_doc.GetParseError())).str()
+            );
+        }
         return config_doc;
     }
 
-    std::vector<Node> createNodeVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > nodes_vec;
-        fea::createVectorFromJSON(config_doc, "nodes", nodes_vec);
-
-        std::vector<Node> nodes_out(nodes_vec.size());
-        Node n;
+    void runLoadTasks(const std::vector<LoadTask> &tasks,
+                      std::vector<std::pair<std::string, long long> > &load_times) {
+        const long long num_tasks = tasks.size();
+        std::vector<long long> times(num_tasks, 0);
+        std::vector<std::string> errors(num_tasks);
 
-        for (size_t i = 0; i < nodes_vec.size(); ++i) {
+        // one thread creates a task per file, the other threads of the team run them and the chunks of the
+        // files parsed by `fea::CSVParser::parseToArray`
+#ifdef _OPENMP
+#pragma omp parallel
+#pragma omp single
+#endif
+        for (long long i = 0; i < num_tasks; ++i) {
+#ifdef _OPENMP
+#pragma omp task
+#endif
+            {
+                auto start_time = std::chrono::high_resolution_clock::now();
+                try {
+                    tasks[i].load();
+                }
+                catch (const std::exception &e) {
+                    errors[i] = e.what();
+                }
+                catch (...) {
+                    errors[i] = (boost::format("Unknown error when loading %s.") % tasks[i].name).str();
+                }
+                auto end_time = std::chrono::high_resolution_clock::now();
+                times[i] = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            }
+        }
 
-            if (nodes_vec[i].size() != 3) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in nodes does not specify x, y and z coordinates.") % i).str()
-                );
+        for (long long i = 0; i < num_tasks; ++i) {
+            if (!errors[i].empty()) {
+                throw std::runtime_error(errors[i]);
             }
-            n << nodes_vec[i][0], nodes_vec[i][1], nodes_vec[i][2];
-            nodes_out[i] = n;
+        }
+        load_times.clear();
+        for (long long i = 0; i < num_tasks; ++i) {
+            load_times.push_back(std::make_pair(tasks[i].name, times[i]));
+        }
+    }
+
+    std::vector<Node> createNodeVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<double> nodes_flat;
+        std::vector<size_t> row_offsets;
+        fea::createArrayFromJSON(config_doc, "nodes", nodes_flat, row_offsets);
+        checkNumCols(row_offsets, 3, "Row %d in nodes does not specify x, y and z coordinates.");
+
+        std::vector<Node> nodes_out(row_offsets.size() - 1);
+        for (size_t i = 0; i < nodes_out.size(); ++i) {
+            nodes_out[i] << nodes_flat[3 * i], nodes_flat[3 * i + 1], nodes_flat[3 * i + 2];
         }
         return nodes_out;
     }
 
-    std::vector<Elem> createElemVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<unsigned int> > elems_vec;
-        std::vector< std::vector<double> > props_vec;
-        fea::createVectorFromJSON(config_doc, "elems", elems_vec);
-        fea::createVectorFromJSON(config_doc, "props", props_vec);
+    std::vector<Props> createSectionVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<double> sections_flat;
+        std::vector<size_t> row_offsets;
+        fea::createArrayFromJSON(config_doc, "sections", sections_flat, row_offsets);
 
-        if (elems_vec.size() != props_vec.size()) {
-            throw std::runtime_error("The number of rows in elems did not match props.");
+        std::vector<Props> sections_out(row_offsets.size() - 1);
+        for (size_t i = 0; i < sections_out.size(); ++i) {
+            sections_out[i] = createPropsFromRow(&sections_flat[row_offsets[i]], row_offsets[i + 1] - row_offsets[i],
+                                                 i, "sections");
         }
+        return sections_out;
+    }
 
-        std::vector<Elem> elems_out(elems_vec.size());
-        Props p;
-        for (size_t i = 0; i < elems_vec.size(); ++i) {
-            if (elems_vec[i].size() != 2) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in elems does not specify 2 nodal indices [nn1,nn2].") % i).str()
-                );
-            }
-            if (props_vec[i].size() != 7) {
-                throw std::runtime_error(
-                        (boost::format("Row %d  in props does not specify the 7 property values "
-                                               "[EA, EIz, EIy, GJ, nx, ny, nz]") % i).str()
-                );
+    std::vector<Elem> createElemVecFromJSON(const rapidjson::Document &config_doc) {
+        if (config_doc.HasMember("sections")) {
+            // expand the section table into per-element properties
+            std::vector<Props> sections = createSectionVecFromJSON(config_doc);
+            std::vector<Connectivity> elems;
+            std::vector<unsigned int> section_ids;
+            std::vector<Eigen::Vector3d> orientations;
+            createSectionElemsFromJSON(config_doc, sections, elems, section_ids, orientations);
+
+            std::vector<Elem> elems_out(elems.size());
+            for (size_t i = 0; i < elems.size(); ++i) {
+                Props p = sections[section_ids[i]];
+                if (!orientations.empty()) {
+                    p.normal_vec = orientations[i];
+                }
+                elems_out[i] = Elem(elems[i][0], elems[i][1], p);
             }
-            p.EA = props_vec[i][0];
-            p.EIz = props_vec[i][1];
-            p.EIy = props_vec[i][2];
-            p.GJ = props_vec[i][3];
-            p.normal_vec << props_vec[i][4], props_vec[i][5], props_vec[i][6];
-            elems_out[i] = Elem(elems_vec[i][0], elems_vec[i][1], p);
+            return elems_out;
+        }
+
+        std::vector<NodeIndex> elems_flat;
+        std::vector<double> props_flat;
+        std::vector<size_t> elem_offsets, prop_offsets;
+        fea::createArrayFromJSON(config_doc, "elems", elems_flat, elem_offsets);
+        fea::createArrayFromJSON(config_doc, "props", props_flat, prop_offsets);
+
+        std::vector<Connectivity> elems;
+        std::vector<Props> props;
+        createElems(elems_flat, elem_offsets, props_flat, prop_offsets, elems, props);
+
+        std::vector<Elem> elems_out(elems.size());
+        for (size_t i = 0; i < elems.size(); ++i) {
+            elems_out[i].node_numbers = elems[i];
+            elems_out[i].props = props[i];
         }
         return elems_out;
     }
 
     std::vector<BC> createBCVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > bcs_vec;
-        fea::createVectorFromJSON(config_doc, "bcs", bcs_vec);
+        std::vector<double> bcs_flat;
+        std::vector<size_t> row_offsets;
+        fea::createArrayFromJSON(config_doc, "bcs", bcs_flat, row_offsets);
+        checkNumCols(row_offsets, 3, "Row %d in bcs does not specify [node number,DOF,value].");
 
-        std::vector<BC> bcs_out(bcs_vec.size());
-
-        for (size_t i = 0; i < bcs_vec.size(); ++i) {
-            if (bcs_vec[i].size() != 3) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in bcs does not specify [node number,DOF,value].") % i).str()
-                );
-            }
-            bcs_out[i] = BC((unsigned int) bcs_vec[i][0], (unsigned int) bcs_vec[i][1], bcs_vec[i][2]);
+        std::vector<BC> bcs_out(row_offsets.size() - 1);
+        for (size_t i = 0; i < bcs_out.size(); ++i) {
+            const double *row = &bcs_flat[3 * i];
+            bcs_out[i] = BC(toIndex<NodeIndex>(row[0], i, "bcs"), toIndex<unsigned int>(row[1], i, "bcs"), row[2]);
         }
         return bcs_out;
     }
 
     std::vector<Force> createForceVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > forces_vec;
-        fea::createVectorFromJSON(config_doc, "forces", forces_vec);
-
-        std::vector<Force> forces_out(forces_vec.size());
+        std::vector<double> forces_flat;
+        std::vector<size_t> row_offsets;
+        fea::createArrayFromJSON(config_doc, "forces", forces_flat, row_offsets);
+        checkNumCols(row_offsets, 3, "Row %d in forces does not specify [node number,DOF,value].");
 
-        for (size_t i = 0; i < forces_vec.size(); ++i) {
-            if (forces_vec[i].size() != 3) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in forces does not specify [node number,DOF,value].") % i).str()
-                );
-            }
-            forces_out[i] = Force((unsigned int) forces_vec[i][0], (unsigned int) forces_vec[i][1], forces_vec[i][2]);
+        std::vector<Force> forces_out(row_offsets.size() - 1);
+        for (size_t i = 0; i < forces_out.size(); ++i) {
+            const double *row = &forces_flat[3 * i];
+            forces_out[i] = Force(toIndex<NodeIndex>(row[0], i, "forces"), toIndex<unsigned int>(row[1], i, "forces"),
+                                  row[2]);
         }
         return forces_out;
     }
 
     std::vector<Tie> createTieVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > ties_vec;
-        fea::createVectorFromJSON(config_doc, "ties", ties_vec);
-
-        std::vector<Tie> ties_out(ties_vec.size());
+        std::vector<double> ties_flat;
+        std::vector<size_t> row_offsets;
+        fea::createArrayFromJSON(config_doc, "ties", ties_flat, row_offsets);
+        checkNumCols(row_offsets, 4, "Row %d in ties does not specify [node number 1,node number 2,lmult,rmult].");
 
-        for (size_t i = 0; i < ties_vec.size(); ++i) {
-            if (ties_vec[i].size() != 4) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in ties does not specify [node number 1,node number 2,lmult,rmult].") %
-                         i).str()
-                );
-            }
-            ties_out[i] = Tie((unsigned int) ties_vec[i][0], (unsigned int) ties_vec[i][1], ties_vec[i][2],
-                              ties_vec[i][3]);
+        std::vector<Tie> ties_out(row_offsets.size() - 1);
+        for (size_t i = 0; i < ties_out.size(); ++i) {
+            const double *row = &ties_flat[4 * i];
+            ties_out[i] = Tie(toIndex<NodeIndex>(row[0], i, "ties"), toIndex<NodeIndex>(row[1], i, "ties"), row[2],
+                               row[3]);
         }
         return ties_out;
     }
 
     std::vector<Equation> createEquationVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > eqns_vec;
-        fea::createVectorFromJSON(config_doc, "equations", eqns_vec);
-
-        std::vector<Equation> eqns_out(eqns_vec.size());
+        std::vector<double> eqns_flat;
+        std::vector<size_t> row_offsets;
+        fea::createArrayFromJSON(config_doc, "equations", eqns_flat, row_offsets);
 
-        for (size_t i = 0; i < eqns_vec.size(); ++i) {
-            if (eqns_vec[i].size() % 3 != 0) {
+        std::vector<Equation> eqns_out(row_offsets.size() - 1);
+        for (size_t i = 0; i < eqns_out.size(); ++i) {
+            const double *row = &eqns_flat[row_offsets[i]];
+            const size_t num_cols = row_offsets[i + 1] - row_offsets[i];
+            if (num_cols % 3 != 0) {
                 throw std::runtime_error(
                         (boost::format("Row %d in equations does not specify [node number,dof,coefficient,...] for each term.") %
                          i).str()
                 );
             }
 
-            Equation eqn;
-            for (size_t j = 0; j < eqns_vec[i].size() / 3; ++j) {
-                eqn.terms.push_back(Equation::Term(
-                    (unsigned int) eqns_vec[i][3 * j],
-                    (unsigned int) eqns_vec[i][3 * j + 1],
-                    eqns_vec[i][3 * j + 2]));
+            eqns_out[i].terms.reserve(num_cols / 3);
+            for (size_t j = 0; j < num_cols / 3; ++j) {
+                eqns_out[i].terms.push_back(Equation::Term(
+                    toIndex<NodeIndex>(row[3 * j], i, "equations"),
+                    toIndex<unsigned int>(row[3 * j + 1], i, "equations"),
+                    row[3 * j + 2]));
             }
-            eqns_out[i] = eqn;
         }
         return eqns_out;
     }
 
+    std::vector<RigidBody> createRigidBodyVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<double> bodies_flat;
+        std::vector<size_t> row_offsets;
+        fea::createArrayFromJSON(config_doc, "rigid_bodies", bodies_flat, row_offsets);
+
+        std::vector<RigidBody> bodies_out(row_offsets.size() - 1);
+        for (size_t i = 0; i < bodies_out.size(); ++i) {
+            const double *row = &bodies_flat[row_offsets[i]];
+            const size_t num_cols = row_offsets[i + 1] - row_offsets[i];
+            if (num_cols < 2) {
+                throw std::runtime_error(
+                        (boost::format("Row %d in rigid_bodies does not specify [master node,slave node,...].") %
+                         i).str()
+                );
+            }
+            bodies_out[i].master_node = toIndex<NodeIndex>(row[0], i, "rigid_bodies");
+            bodies_out[i].slave_nodes.reserve(num_cols - 1);
+            for (size_t j = 1; j < num_cols; ++j) {
+                bodies_out[i].slave_nodes.push_back(toIndex<NodeIndex>(row[j], i, "rigid_bodies"));
+            }
+        }
+        return bodies_out;
+    }
+
     Job createJobFromJSON(const rapidjson::Document &config_doc) {
-        std::vector<Node> nodes = createNodeVecFromJSON(config_doc);
-        std::vector<Elem> elems = createElemVecFromJSON(config_doc);
-        return Job(nodes, elems);
+        if (config_doc.HasMember("mesh")) {
+            return readMeshFromJSON(config_doc).job;
+        }
+        JobArrays arrays;
+        std::vector<LoadTask> tasks;
+        addJobLoadTasks(config_doc, false, arrays, tasks);
+
+        std::vector<std::pair<std::string, long long> > load_times;
+        runLoadTasks(tasks, load_times);
+        return createJobFromArrays(config_doc, arrays);
+    }
+
+    Model createModelFromJSON(const rapidjson::Document &config_doc) {
+        Summary load_summary;
+        return createModelFromJSON(config_doc, load_summary);
+    }
+
+    Model createModelFromJSON(const rapidjson::Document &config_doc, Summary &load_summary) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        Model model;
+        Model mesh_model;
+        std::vector<LoadTask> tasks;
+        JobArrays arrays;
+        const size_t chunk_size = getElementChunkSize(config_doc);
+        const bool has_mesh = !config_doc.HasMember("binary_job") && config_doc.HasMember("mesh");
+
+        if (config_doc.HasMember("binary_job")) {
+            if (!config_doc["binary_job"].IsString()) {
+                throw std::runtime_error("Value associated with variable binary_job is not a string.");
+            }
+            tasks.push_back(LoadTask("binary_job", [&config_doc, &model]() {
+                model = readBinaryJob(config_doc["binary_job"].GetString());
+            }));
+        }
+        else {
+            if (has_mesh) {
+                if (chunk_size > 0) {
+                    throw std::runtime_error("Elements read from a mesh file cannot be streamed, remove "
+                                                     "element_chunk_size.");
+                }
+                tasks.push_back(LoadTask("mesh", [&config_doc, &mesh_model]() {
+                    mesh_model = readMeshFromJSON(config_doc);
+                }));
+            }
+            else {
+                addJobLoadTasks(config_doc, chunk_size > 0, arrays, tasks);
+            }
+            if (config_doc.HasMember("bcs")) {
+                tasks.push_back(LoadTask("bcs", [&config_doc, &model]() {
+                    model.bcs = createBCVecFromJSON(config_doc);
+                }));
+            }
+            if (config_doc.HasMember("forces")) {
+                tasks.push_back(LoadTask("forces", [&config_doc, &model]() {
+                    model.forces = createForceVecFromJSON(config_doc);
+                }));
+            }
+            if (config_doc.HasMember("ties")) {
+                tasks.push_back(LoadTask("ties", [&config_doc, &model]() {
+                    model.ties = createTieVecFromJSON(config_doc);
+                }));
+            }
+            if (config_doc.HasMember("equations")) {
+                tasks.push_back(LoadTask("equations", [&config_doc, &model]() {
+                    model.equations = createEquationVecFromJSON(config_doc);
+                }));
+            }
+            if (config_doc.HasMember("rigid_bodies")) {
+                tasks.push_back(LoadTask("rigid_bodies", [&config_doc, &model]() {
+                    model.rigid_bodies = createRigidBodyVecFromJSON(config_doc);
+                }));
+            }
+        }
+
+        runLoadTasks(tasks, load_summary.file_load_times_in_ms);
+        if (has_mesh) {
+            // constraints and loads of the mesh file come before those of the configuration
+            model.job = std::move(mesh_model.job);
+            model.bcs.insert(model.bcs.begin(), mesh_model.bcs.begin(), mesh_model.bcs.end());
+            model.forces.insert(model.forces.begin(), mesh_model.forces.begin(), mesh_model.forces.end());
+        }
+        else if (!config_doc.HasMember("binary_job")) {
+            model.job = createJobFromArrays(config_doc, arrays);
+            if (chunk_size > 0) {
+                const std::string elems_filename = getStreamedFilename(config_doc, "elems");
+                if (config_doc.HasMember("sections")) {
+                    model.element_stream = std::make_shared<ElementStream>(elems_filename, arrays.sections,
+                                                                           chunk_size);
+                }
+                else {
+                    model.element_stream = std::make_shared<ElementStream>(
+                            elems_filename, getStreamedFilename(config_doc, "props"), chunk_size);
+                }
+            }
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        load_summary.input_load_time_in_ms =
+                std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        return model;
     }
 
     Options createOptionsFromJSON(const rapidjson::Document &config_doc) {
@@ -254,6 +769,30 @@ namespace fea {
                 }
                 options.save_tie_forces = config_doc["options"]["save_tie_forces"].GetBool();
             }
+            if (config_doc["options"].HasMember("save_elemental_forces")) {
+                if (!config_doc["options"]["save_elemental_forces"].IsBool()) {
+                    throw std::runtime_error("save_elemental_forces provided in options configuration is not a bool.");
+                }
+                options.save_elemental_forces = config_doc["options"]["save_elemental_forces"].GetBool();
+            }
+            if (config_doc["options"].HasMember("compute_nodal_forces")) {
+                if (!config_doc["options"]["compute_nodal_forces"].IsBool()) {
+                    throw std::runtime_error("compute_nodal_forces provided in options configuration is not a bool.");
+                }
+                options.compute_nodal_forces = config_doc["options"]["compute_nodal_forces"].GetBool();
+            }
+            if (config_doc["options"].HasMember("compute_tie_forces")) {
+                if (!config_doc["options"]["compute_tie_forces"].IsBool()) {
+                    throw std::runtime_error("compute_tie_forces provided in options configuration is not a bool.");
+                }
+                options.compute_tie_forces = config_doc["options"]["compute_tie_forces"].GetBool();
+            }
+            if (config_doc["options"].HasMember("compute_element_forces")) {
+                if (!config_doc["options"]["compute_element_forces"].IsBool()) {
+                    throw std::runtime_error("compute_element_forces provided in options configuration is not a bool.");
+                }
+                options.compute_element_forces = config_doc["options"]["compute_element_forces"].GetBool();
+            }
             if (config_doc["options"].HasMember("verbose")) {
                 if (!config_doc["options"]["verbose"].IsBool()) {
                     throw std::runtime_error("verbose provided in options configuration is not a bool.");
@@ -266,6 +805,91 @@ namespace fea {
                 }
                 options.save_report = config_doc["options"]["save_report"].GetBool();
             }
+            if (config_doc["options"].HasMember("save_vtu")) {
+                if (!config_doc["options"]["save_vtu"].IsBool()) {
+                    throw std::runtime_error("save_vtu provided in options configuration is not a bool.");
+                }
+                options.save_vtu = config_doc["options"]["save_vtu"].GetBool();
+            }
+            if (config_doc["options"].HasMember("save_global_system")) {
+                if (!config_doc["options"]["save_global_system"].IsBool()) {
+                    throw std::runtime_error("save_global_system provided in options configuration is not a bool.");
+                }
+                options.save_global_system = config_doc["options"]["save_global_system"].GetBool();
+            }
+            if (config_doc["options"].HasMember("result_format")) {
+                if (!config_doc["options"]["result_format"].IsString()) {
+                    throw std::runtime_error("result_format provided in options configuration is not a string.");
+                }
+                std::string result_format = config_doc["options"]["result_format"].GetString();
+                if (result_format == "csv") {
+                    options.result_format = CSV_RESULTS;
+                }
+                else if (result_format == "binary") {
+                    options.result_format = RAW_BINARY_RESULTS;
+                }
+                else if (result_format == "npy") {
+                    options.result_format = NPY_RESULTS;
+                }
+                else {
+                    throw std::runtime_error(
+                            (boost::format("Unknown result_format %s provided in options configuration. Expected "
+                                                   "csv, binary or npy.") % result_format).str()
+                    );
+                }
+            }
+            if (config_doc["options"].HasMember("analysis_type")) {
+                if (!config_doc["options"]["analysis_type"].IsString()) {
+                    throw std::runtime_error("analysis_type provided in options configuration is not a string.");
+                }
+                std::string analysis_type = config_doc["options"]["analysis_type"].GetString();
+                if (analysis_type == "frame_3d") {
+                    options.analysis_type = FRAME_3D;
+                }
+                else if (analysis_type == "frame_2d") {
+                    options.analysis_type = FRAME_2D;
+                }
+                else if (analysis_type == "truss_3d") {
+                    options.analysis_type = TRUSS_3D;
+                }
+                else if (analysis_type == "truss_2d") {
+                    options.analysis_type = TRUSS_2D;
+                }
+                else {
+                    throw std::runtime_error(
+                            (boost::format("Unknown analysis_type %s provided in options configuration. Expected "
+                                                   "frame_3d, frame_2d, truss_3d or truss_2d.") % analysis_type).str()
+                    );
+                }
+            }
+            if (config_doc["options"].HasMember("cache_element_matrices")) {
+                if (!config_doc["options"]["cache_element_matrices"].IsBool()) {
+                    throw std::runtime_error(
+                            "cache_element_matrices provided in options configuration is not a bool.");
+                }
+                options.cache_element_matrices = config_doc["options"]["cache_element_matrices"].GetBool();
+            }
+            if (config_doc["options"].HasMember("element_cache_tolerance")) {
+                if (!config_doc["options"]["element_cache_tolerance"].IsNumber()) {
+                    throw std::runtime_error(
+                            "element_cache_tolerance provided in options configuration is not a number.");
+                }
+                options.element_cache_tolerance = config_doc["options"]["element_cache_tolerance"].GetDouble();
+            }
+            if (config_doc["options"].HasMember("merge_coincident_nodes")) {
+                if (!config_doc["options"]["merge_coincident_nodes"].IsBool()) {
+                    throw std::runtime_error(
+                            "merge_coincident_nodes provided in options configuration is not a bool.");
+                }
+                options.merge_coincident_nodes = config_doc["options"]["merge_coincident_nodes"].GetBool();
+            }
+            if (config_doc["options"].HasMember("coincident_node_tolerance")) {
+                if (!config_doc["options"]["coincident_node_tolerance"].IsNumber()) {
+                    throw std::runtime_error(
+                            "coincident_node_tolerance provided in options configuration is not a number.");
+                }
+                options.coincident_node_tolerance = config_doc["options"]["coincident_node_tolerance"].GetDouble();
+            }
             if (config_doc["options"].HasMember("nodal_displacements_filename")) {
                 if (!config_doc["options"]["nodal_displacements_filename"].IsString()) {
                     throw std::runtime_error(
@@ -286,12 +910,32 @@ namespace fea {
                 }
                 options.tie_forces_filename = config_doc["options"]["tie_forces_filename"].GetString();
             }
+            if (config_doc["options"].HasMember("elemental_forces_filename")) {
+                if (!config_doc["options"]["elemental_forces_filename"].IsString()) {
+                    throw std::runtime_error(
+                            "elemental_forces_filename provided in options configuration is not a string.");
+                }
+                options.elemental_forces_filename = config_doc["options"]["elemental_forces_filename"].GetString();
+            }
             if (config_doc["options"].HasMember("report_filename")) {
                 if (!config_doc["options"]["report_filename"].IsString()) {
                     throw std::runtime_error("report_filename provided in options configuration is not a string.");
                 }
                 options.report_filename = config_doc["options"]["report_filename"].GetString();
             }
+            if (config_doc["options"].HasMember("vtu_filename")) {
+                if (!config_doc["options"]["vtu_filename"].IsString()) {
+                    throw std::runtime_error("vtu_filename provided in options configuration is not a string.");
+                }
+                options.vtu_filename = config_doc["options"]["vtu_filename"].GetString();
+            }
+            if (config_doc["options"].HasMember("global_system_prefix")) {
+                if (!config_doc["options"]["global_system_prefix"].IsString()) {
+                    throw std::runtime_error("global_system_prefix provided in options configuration is not a "
+                                                     "string.");
+                }
+                options.global_system_prefix = config_doc["options"]["global_system_prefix"].GetString();
+            }
         }
         return options;
     }
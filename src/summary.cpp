@@ -33,7 +33,7 @@ namespace fea {
 
     namespace {
 
-        typedef std::pair<std::string, unsigned int> fe_param_pair;
+        typedef std::pair<std::string, unsigned long long> fe_param_pair;
         typedef std::pair<std::string, long long> timing_param_pair;
 
         struct Location2D {
@@ -45,25 +45,22 @@ namespace fea {
             size_t col;
         };
 
-        template<typename T>
-        std::pair<Location2D, Location2D> findMinMax2D(std::vector<std::vector<T>> input) {
+        std::pair<Location2D, Location2D> findMinMax2D(const NodalResults &input) {
             Location2D min_elem, max_elem;
-            T min_val = std::numeric_limits<T>::max();
-            T max_val = -std::numeric_limits<T>::max();
+            double min_val = std::numeric_limits<double>::max();
+            double max_val = -std::numeric_limits<double>::max();
 
-            const size_t num_cols = input[0].size();
-
-            for (size_t i = 0; i < input.size(); ++i) {
-                for (size_t j = 0; j < num_cols; ++j) {
-                    if (input[i][j] > max_val) {
+            for (Eigen::Index i = 0; i < input.rows(); ++i) {
+                for (Eigen::Index j = 0; j < input.cols(); ++j) {
+                    if (input(i, j) > max_val) {
                         max_elem.row = i;
                         max_elem.col = j;
-                        max_val = input[i][j];
+                        max_val = input(i, j);
                     }
-                    if (input[i][j] < min_val) {
+                    if (input(i, j) < min_val) {
                         min_elem.row = i;
                         min_elem.col = j;
-                        min_val = input[i][j];
+                        min_val = input(i, j);
                     }
                 }
             }
@@ -84,6 +81,7 @@ namespace fea {
 
     Summary::Summary()
             : total_time_in_ms(0),
+              input_load_time_in_ms(0),
               assembly_time_in_ms(0),
               preprocessing_time_in_ms(0),
               factorization_time_in_ms(0),
@@ -97,9 +95,7 @@ namespace fea {
               num_forces(0),
               num_ties(0),
               num_eqns(0),
-              nodal_displacements(0),
-              nodal_forces(0),
-              tie_forces(0) {
+              num_components(0) {
 
     }
 
@@ -107,13 +103,14 @@ namespace fea {
         std::string report = std::string("\nFinite Element Analysis Summary\n\nModel parameters\n");
         boost::format fe_params_fmt = boost::format("\t%s : %d\n");
 
-        std::vector<fe_param_pair> fe_params(6);
+        std::vector<fe_param_pair> fe_params(7);
         fe_params[0] = fe_param_pair("Nodes", num_nodes);
         fe_params[1] = fe_param_pair("Elements", num_elems);
         fe_params[2] = fe_param_pair("BCs", num_bcs);
         fe_params[3] = fe_param_pair("Ties", num_ties);
         fe_params[4] = fe_param_pair("Forces ", num_forces);
         fe_params[5] = fe_param_pair("Equations ", num_eqns);
+        fe_params[6] = fe_param_pair("Components", num_components);
 
         // get the maximum number of digits in the model parameters for formatting
         int max_digits = 1;
@@ -140,7 +137,14 @@ namespace fea {
 
         // define timing data to write to report
         std::vector<timing_param_pair> timing_params;
-        timing_params.reserve(7);
+        timing_params.reserve(8 + file_load_times_in_ms.size());
+        if (!file_load_times_in_ms.empty()) {
+            timing_params.push_back(timing_param_pair("Input load time", input_load_time_in_ms));
+            for (size_t i = 0; i < file_load_times_in_ms.size(); ++i) {
+                timing_params.push_back(timing_param_pair("  Load " + file_load_times_in_ms[i].first,
+                                                          file_load_times_in_ms[i].second));
+            }
+        }
         timing_params.push_back(timing_param_pair("Assembly time", assembly_time_in_ms));
         timing_params.push_back(timing_param_pair("Preprocessesing time", preprocessing_time_in_ms));
         timing_params.push_back(timing_param_pair("Factorization time", factorization_time_in_ms));
@@ -170,33 +174,39 @@ namespace fea {
             );
         }
 
-        auto minmax = findMinMax2D(nodal_displacements);
+        std::pair<Location2D, Location2D> minmax;
+        if (nodal_displacements.rows() > 0) {
+            minmax = findMinMax2D(nodal_displacements);
 
-        report.append(
-                (boost::format(
-                        "\nNodal displacements\n\tMinimum : Node %d\tDOF %d\tValue %.3f\n\tMaximum : Node %d\tDOF %d\tValue %.3f\n")
-                 % minmax.first.row % minmax.first.col % nodal_displacements[minmax.first.row][minmax.first.col]
-                 % minmax.second.row % minmax.second.col %
-                 nodal_displacements[minmax.second.row][minmax.second.col]).str()
-        );
+            report.append(
+                    (boost::format(
+                            "\nNodal displacements\n\tMinimum : Node %d\tDOF %d\tValue %.3f\n\tMaximum : Node %d\tDOF %d\tValue %.3f\n")
+                     % minmax.first.row % minmax.first.col % nodal_displacements(minmax.first.row, minmax.first.col)
+                     % minmax.second.row % minmax.second.col %
+                     nodal_displacements(minmax.second.row, minmax.second.col)).str()
+            );
+        }
 
-        minmax = findMinMax2D(nodal_forces);
+        // nodal and tie forces are only present if they were requested in the options of the analysis
+        if (nodal_forces.rows() > 0) {
+            minmax = findMinMax2D(nodal_forces);
 
-        report.append(
-                (boost::format(
-                        "\nNodal Forces\n\tMinimum : Node %d\tDOF %d\tValue %.3f\n\tMaximum : Node %d\tDOF %d\tValue %.3f\n")
-                 % minmax.first.row % minmax.first.col % nodal_forces[minmax.first.row][minmax.first.col]
-                 % minmax.second.row % minmax.second.col % nodal_forces[minmax.second.row][minmax.second.col]).str()
-        );
+            report.append(
+                    (boost::format(
+                            "\nNodal Forces\n\tMinimum : Node %d\tDOF %d\tValue %.3f\n\tMaximum : Node %d\tDOF %d\tValue %.3f\n")
+                     % minmax.first.row % minmax.first.col % nodal_forces(minmax.first.row, minmax.first.col)
+                     % minmax.second.row % minmax.second.col % nodal_forces(minmax.second.row, minmax.second.col)).str()
+            );
+        }
 
-        if (num_ties > 0) {
+        if (tie_forces.rows() > 0) {
             minmax = findMinMax2D(tie_forces);
 
             report.append(
                     (boost::format(
                             "\nTie Forces\n\tMinimum : Tie %d\tDOF %d\tValue %.3f\n\tMaximum : Tie %d\tDOF %d\tValue %.3f\n")
-                     % minmax.first.row % minmax.first.col % tie_forces[minmax.first.row][minmax.first.col]
-                     % minmax.second.row % minmax.second.col % tie_forces[minmax.second.row][minmax.second.col]).str()
+                     % minmax.first.row % minmax.first.col % tie_forces(minmax.first.row, minmax.first.col)
+                     % minmax.second.row % minmax.second.col % tie_forces(minmax.second.row, minmax.second.col)).str()
             );
         }
         return report;
@@ -24,16 +24,24 @@
 // Author: ryan.latture@gmail.com (Ryan Latture)
 
 #include <Eigen/LU>
+#include <algorithm>
 #include <boost/format.hpp>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <map>
 
+#include "binary_io.h"
+#include "coincident_nodes.h"
+#include "components.h"
+#include "matrix_market.h"
 #include "threed_beam_fea.h"
+#include "vtu_writer.h"
 
 namespace fea {
 
@@ -49,26 +57,242 @@ void writeStringToTxt(std::string filename, std::string data) {
   output_file << data;
   output_file.close();
 }
+
+// Throws if the global stiffness matrix would have more coefficients than its
+// `StorageIndex` can count while it is formed.
+void checkNumCoefficients(size_t num_coefficients) {
+  if (num_coefficients >
+      static_cast<size_t>(std::numeric_limits<StorageIndex>::max())) {
+    throw std::runtime_error(
+        (boost::format("The global stiffness matrix has %d coefficients, which "
+                       "exceeds the range of its %d-bit indices. Rebuild with "
+                       "FEA_USE_64BIT_INDICES.") %
+         num_coefficients % (8 * sizeof(StorageIndex)))
+            .str());
+  }
+}
+
+// Counts the distinct coefficients of `triplets` towards the sizes of the
+// columns of the global matrix. Coefficients that couple the unknowns of a
+// single node are shared by every element at the node, so they are recorded
+// in the `num_node_dofs` x `num_node_dofs` bit pattern of the node and added
+// to `column_sizes` by `addNodePatterns` once all elements were counted.
+void countCoefficients(std::vector<Triplet> &triplets, size_t num_dofs,
+                       unsigned int num_node_dofs,
+                       std::vector<std::uint64_t> &node_patterns,
+                       std::vector<StorageIndex> &column_sizes) {
+  std::sort(triplets.begin(), triplets.end(),
+            [](const Triplet &a, const Triplet &b) {
+              return a.col() < b.col() ||
+                     (a.col() == b.col() && a.row() < b.row());
+            });
+  for (size_t i = 0; i < triplets.size(); ++i) {
+    if (i > 0 && triplets[i - 1].row() == triplets[i].row() &&
+        triplets[i - 1].col() == triplets[i].col()) {
+      continue;
+    }
+    const size_t row = triplets[i].row();
+    const size_t col = triplets[i].col();
+    if (row < num_dofs && col < num_dofs &&
+        row / num_node_dofs == col / num_node_dofs) {
+      node_patterns[col / num_node_dofs] |=
+          std::uint64_t(1) << (row % num_node_dofs * num_node_dofs +
+                               col % num_node_dofs);
+    } else {
+      ++column_sizes[col];
+    }
+  }
+}
+
+// Adds the coefficients recorded in the bit patterns of the nodes by
+// `countCoefficients` to `column_sizes`.
+void addNodePatterns(const std::vector<std::uint64_t> &node_patterns,
+                     unsigned int num_node_dofs,
+                     std::vector<StorageIndex> &column_sizes) {
+  for (size_t i = 0; i < node_patterns.size(); ++i) {
+    for (unsigned int j = 0; j < num_node_dofs; ++j) {
+      for (unsigned int k = 0; k < num_node_dofs; ++k) {
+        if (node_patterns[i] >> (k * num_node_dofs + j) & 1) {
+          ++column_sizes[num_node_dofs * i + j];
+        }
+      }
+    }
+  }
+}
+
+// Quantizes `value` relative to its magnitude. The binary exponent and the
+// mantissa rounded to `tolerance` are stored in consecutive key slots.
+void quantizeRelative(double value, double tolerance, ElemMatrixKey &key,
+                      size_t &pos) {
+  int exponent = 0;
+  const double mantissa = std::frexp(value, &exponent);
+  key[pos++] = exponent;
+  key[pos++] = std::llround(mantissa / tolerance);
+}
+
+// Quantizes the components of a unit vector to `tolerance`.
+void quantizeUnitVector(const Eigen::Vector3d &vec, double tolerance,
+                        ElemMatrixKey &key, size_t &pos) {
+  for (int i = 0; i < 3; ++i) {
+    key[pos++] = std::llround(vec(i) / tolerance);
+  }
+}
 } // namespace
 
+size_t ElemMatrixKeyHash::operator()(const ElemMatrixKey &key) const {
+  // FNV-1a over the quantized values
+  size_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < key.size(); ++i) {
+    hash ^= static_cast<size_t>(key[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+ElemMatrixKey makeElemMatrixKey(size_t i, const Job &job, double tolerance) {
+  const Node &n1 = job.nodes[job.elems[i][0]];
+  const Node &n2 = job.nodes[job.elems[i][1]];
+  const Props &props = job.getProps(i);
+
+  ElemMatrixKey key;
+  size_t pos = 0;
+  quantizeRelative((n2 - n1).norm(), tolerance, key, pos);
+  quantizeUnitVector((n2 - n1).normalized(), tolerance, key, pos);
+  quantizeUnitVector(job.getNormalVec(i).normalized(), tolerance, key, pos);
+  quantizeRelative(props.EA, tolerance, key, pos);
+  quantizeRelative(props.EIz, tolerance, key, pos);
+  quantizeRelative(props.EIy, tolerance, key, pos);
+  quantizeRelative(props.GJ, tolerance, key, pos);
+  return key;
+}
+
 inline double norm(const Node &n1, const Node &n2) {
   const Node dn = n2 - n1;
   return dn.norm();
 }
 
-void GlobalStiffAssembler::calcKelem(unsigned int i, const Job &job) {
-  // extract element properties
-  const double EA = job.props[i].EA;   // Young's modulus * cross area
-  const double EIz = job.props[i].EIz; // Young's modulus* I3
-  const double EIy = job.props[i].EIy; // Young's modulus* I2
-  const double GJ = job.props[i].GJ;
+template <typename Config>
+DofMap<Config>::DofMap(const Job &job,
+                       const std::vector<RigidBody> &rigid_bodies)
+    : numDofNodes(job.nodes.size()) {
+  if (rigid_bodies.empty()) {
+    return;
+  }
+
+  const NodeIndex num_nodes = job.nodes.size();
+  masterNodes.resize(num_nodes);
+  for (NodeIndex i = 0; i < num_nodes; ++i) {
+    masterNodes[i] = i;
+  }
+
+  for (size_t i = 0; i < rigid_bodies.size(); ++i) {
+    const NodeIndex master = rigid_bodies[i].master_node;
+    if (master >= num_nodes) {
+      throw std::runtime_error(
+          (boost::format("Master node %d of rigid body %d does not exist.") %
+           master % i)
+              .str());
+    }
+    for (size_t j = 0; j < rigid_bodies[i].slave_nodes.size(); ++j) {
+      const NodeIndex slave = rigid_bodies[i].slave_nodes[j];
+      if (slave >= num_nodes) {
+        throw std::runtime_error(
+            (boost::format("Slave node %d of rigid body %d does not exist.") %
+             slave % i)
+                .str());
+      }
+      if (slave == master || masterNodes[slave] != slave) {
+        throw std::runtime_error(
+            (boost::format("Node %d is the slave of more than one rigid body or "
+                           "of itself.") %
+             slave)
+                .str());
+      }
+      masterNodes[slave] = master;
+    }
+  }
+
+  for (size_t i = 0; i < rigid_bodies.size(); ++i) {
+    const NodeIndex master = rigid_bodies[i].master_node;
+    if (masterNodes[master] != master) {
+      throw std::runtime_error(
+          (boost::format("Master node %d of rigid body %d is the slave of "
+                         "another rigid body.") %
+           master % i)
+              .str());
+    }
+  }
+
+  // number the nodes that own unknowns, then point slave nodes to the
+  // unknowns of their master nodes
+  dofNodes.resize(num_nodes);
+  offsets.resize(num_nodes, Eigen::Vector3d::Zero());
+  numDofNodes = 0;
+  for (NodeIndex i = 0; i < num_nodes; ++i) {
+    if (masterNodes[i] == i) {
+      dofNodes[i] = numDofNodes++;
+    }
+  }
+  for (NodeIndex i = 0; i < num_nodes; ++i) {
+    if (masterNodes[i] != i) {
+      dofNodes[i] = dofNodes[masterNodes[i]];
+      offsets[i] = job.nodes[i] - job.nodes[masterNodes[i]];
+    }
+  }
+};
 
-  // store node indices of current element
-  const int nn1 = job.elems[i][0];
-  const int nn2 = job.elems[i][1];
+template <typename Config>
+unsigned int DofMap<Config>::expand(NodeIndex node, unsigned int dof,
+                                    StorageIndex *indices,
+                                    double *coefficients) const {
+  const StorageIndex first_idx = getDofIndex(node);
+  unsigned int num_terms = 0;
+
+  const int active_dof = Config::activeIndex(dof);
+  if (active_dof < 0) {
+    return 0;
+  }
+  indices[num_terms] = first_idx + active_dof;
+  coefficients[num_terms++] = 1.0;
+
+  if (dof < 3 && !offsets.empty()) {
+    // translation of a slave due to the rotation of its master, i.e. the
+    // component `dof` of (theta x offset). Both are zero for other nodes.
+    const Eigen::Vector3d &offset = offsets[node];
+    const unsigned int a = (dof + 1) % 3;
+    const unsigned int b = (dof + 2) % 3;
+    const int rot_a = Config::activeIndex(DOF::ROTATION_X + a);
+    const int rot_b = Config::activeIndex(DOF::ROTATION_X + b);
+    if (rot_a >= 0 && offset(b) != 0.0) {
+      indices[num_terms] = first_idx + rot_a;
+      coefficients[num_terms++] = offset(b);
+    }
+    if (rot_b >= 0 && offset(a) != 0.0) {
+      indices[num_terms] = first_idx + rot_b;
+      coefficients[num_terms++] = -offset(a);
+    }
+  }
+  return num_terms;
+};
+
+template <typename Config>
+void BasicGlobalStiffAssembler<Config>::calcKelem(size_t i, const Job &job) {
+  calcKelem(job.nodes[job.elems[i][0]], job.nodes[job.elems[i][1]],
+            job.getProps(i), job.getNormalVec(i));
+};
+
+template <typename Config>
+void BasicGlobalStiffAssembler<Config>::calcKelem(
+    const Node &n1, const Node &n2, const Props &props,
+    const Eigen::Vector3d &normal_vec) {
+  // extract element properties
+  const double EA = props.EA;   // Young's modulus * cross area
+  const double EIz = props.EIz; // Young's modulus* I3
+  const double EIy = props.EIy; // Young's modulus* I2
+  const double GJ = props.GJ;
 
   // calculate the length of the element
-  const double length = norm(job.nodes[nn1], job.nodes[nn2]);
+  const double length = norm(n1, n2);
 
   // store the entries in the (local) elemental stiffness matrix as temporary
   // values to avoid recalculation
@@ -84,51 +308,67 @@ void GlobalStiffAssembler::calcKelem(unsigned int i, const Job &job) {
   const double tmp1y = EIy / length;
 
   // update local elemental stiffness matrix
-  Klocal(0, 0) = tmpEA;
-  Klocal(0, 6) = -tmpEA;
-  Klocal(1, 1) = tmp12z;
-  Klocal(1, 5) = tmp6z;
-  Klocal(1, 7) = -tmp12z;
-  Klocal(1, 11) = tmp6z;
-  Klocal(2, 2) = tmp12y;
-  Klocal(2, 4) = -tmp6y;
-  Klocal(2, 8) = -tmp12y;
-  Klocal(2, 10) = -tmp6y;
-  Klocal(3, 3) = tmpGJ;
-  Klocal(3, 9) = -tmpGJ;
-  Klocal(4, 2) = -tmp6y;
-  Klocal(4, 4) = 4.0 * tmp1y;
-  Klocal(4, 8) = tmp6y;
-  Klocal(4, 10) = 2.0 * tmp1y;
-  Klocal(5, 1) = tmp6z;
-  Klocal(5, 5) = 4.0 * tmp1z;
-  Klocal(5, 7) = -tmp6z;
-  Klocal(5, 11) = 2.0 * tmp1z;
-  Klocal(6, 0) = -tmpEA;
-  Klocal(6, 6) = tmpEA;
-  Klocal(7, 1) = -tmp12z;
-  Klocal(7, 5) = -tmp6z;
-  Klocal(7, 7) = tmp12z;
-  Klocal(7, 11) = -tmp6z;
-  Klocal(8, 2) = -tmp12y;
-  Klocal(8, 4) = tmp6y;
-  Klocal(8, 8) = tmp12y;
-  Klocal(8, 10) = tmp6y;
-  Klocal(9, 3) = -tmpGJ;
-  Klocal(9, 9) = tmpGJ;
-  Klocal(10, 2) = -tmp6y;
-  Klocal(10, 4) = 2.0 * tmp1y;
-  Klocal(10, 8) = tmp6y;
-  Klocal(10, 10) = 4.0 * tmp1y;
-  Klocal(11, 1) = tmp6z;
-  Klocal(11, 5) = 2.0 * tmp1z;
-  Klocal(11, 7) = -tmp6z;
-  Klocal(11, 11) = 4.0 * tmp1z;
+  if (Config::TRUSS) {
+    // pin-jointed elements only carry axial load
+    Klocal(0, 0) = tmpEA;
+    Klocal(0, 6) = -tmpEA;
+    Klocal(6, 0) = -tmpEA;
+    Klocal(6, 6) = tmpEA;
+  } else {
+    Klocal(0, 0) = tmpEA;
+    Klocal(0, 6) = -tmpEA;
+    Klocal(1, 1) = tmp12z;
+    Klocal(1, 5) = tmp6z;
+    Klocal(1, 7) = -tmp12z;
+    Klocal(1, 11) = tmp6z;
+    Klocal(2, 2) = tmp12y;
+    Klocal(2, 4) = -tmp6y;
+    Klocal(2, 8) = -tmp12y;
+    Klocal(2, 10) = -tmp6y;
+    Klocal(3, 3) = tmpGJ;
+    Klocal(3, 9) = -tmpGJ;
+    Klocal(4, 2) = -tmp6y;
+    Klocal(4, 4) = 4.0 * tmp1y;
+    Klocal(4, 8) = tmp6y;
+    Klocal(4, 10) = 2.0 * tmp1y;
+    Klocal(5, 1) = tmp6z;
+    Klocal(5, 5) = 4.0 * tmp1z;
+    Klocal(5, 7) = -tmp6z;
+    Klocal(5, 11) = 2.0 * tmp1z;
+    Klocal(6, 0) = -tmpEA;
+    Klocal(6, 6) = tmpEA;
+    Klocal(7, 1) = -tmp12z;
+    Klocal(7, 5) = -tmp6z;
+    Klocal(7, 7) = tmp12z;
+    Klocal(7, 11) = -tmp6z;
+    Klocal(8, 2) = -tmp12y;
+    Klocal(8, 4) = tmp6y;
+    Klocal(8, 8) = tmp12y;
+    Klocal(8, 10) = tmp6y;
+    Klocal(9, 3) = -tmpGJ;
+    Klocal(9, 9) = tmpGJ;
+    Klocal(10, 2) = -tmp6y;
+    Klocal(10, 4) = 2.0 * tmp1y;
+    Klocal(10, 8) = tmp6y;
+    Klocal(10, 10) = 4.0 * tmp1y;
+    Klocal(11, 1) = tmp6z;
+    Klocal(11, 5) = 2.0 * tmp1z;
+    Klocal(11, 7) = -tmp6z;
+    Klocal(11, 11) = 4.0 * tmp1z;
+  }
 
   // calculate unit normal vector along local x-direction
-  const Eigen::Vector3d nx = (job.nodes[nn2] - job.nodes[nn1]).normalized();
-  // calculate unit normal vector along y-direction
-  const Eigen::Vector3d ny = job.props[i].normal_vec.normalized();
+  const Eigen::Vector3d nx = (n2 - n1).normalized();
+  // calculate unit normal vector along y-direction. Planar elements bend about
+  // the global z-axis and the orientation of truss elements is arbitrary.
+  Eigen::Vector3d ny;
+  if (Config::PLANAR) {
+    ny = Eigen::Vector3d::UnitZ().cross(nx).normalized();
+  } else if (Config::TRUSS) {
+    ny = nx.unitOrthogonal();
+  } else {
+    ny = normal_vec.normalized();
+  }
   // calculate the unit normal vector in local z direction
   const Eigen::Vector3d nz = nx.cross(ny).normalized();
   RotationMatrix r;
@@ -139,14 +379,13 @@ void GlobalStiffAssembler::calcKelem(unsigned int i, const Job &job) {
   calcAelem(r);
   AelemT = Aelem.transpose();
 
-  // update Kelem
-  Kelem = AelemT * Klocal * Aelem;
-  LocalMatrix KlocalAelem;
+  // update Kelem and the force operator
   KlocalAelem = Klocal * Aelem;
-  perElemKlocalAelem[i] = KlocalAelem;
+  Kelem = AelemT * KlocalAelem;
 };
 
-void GlobalStiffAssembler::calcAelem(const RotationMatrix &r) {
+template <typename Config>
+void BasicGlobalStiffAssembler<Config>::calcAelem(const RotationMatrix &r) {
   // update rotation matrix
   Aelem.block<3, 3>(0, 0) = r;
   Aelem.block<3, 3>(3, 3) = r;
@@ -154,121 +393,285 @@ void GlobalStiffAssembler::calcAelem(const RotationMatrix &r) {
   Aelem.block<3, 3>(9, 9) = r;
 }
 
-std::vector<LocalMatrix> GlobalStiffAssembler::getPerElemKlocalAelem() const {
+template <typename Config>
+std::vector<LocalMatrix>
+BasicGlobalStiffAssembler<Config>::getPerElemKlocalAelem() const {
+  std::vector<LocalMatrix> perElemKlocalAelem;
+  perElemKlocalAelem.reserve(perElemKlocalAelemIdx.size());
+  for (size_t i = 0; i < perElemKlocalAelemIdx.size(); ++i) {
+    perElemKlocalAelem.push_back(uniqueKlocalAelem[perElemKlocalAelemIdx[i]]);
+  }
   return perElemKlocalAelem;
 };
 
-void GlobalStiffAssembler::operator()(SparseMat &Kg, const Job &job,
-                                      const std::vector<Tie> &ties) {
-  int nn1, nn2;
-  unsigned int row, col;
-  const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+template <typename Config>
+void BasicGlobalStiffAssembler<Config>::operator()(
+    SparseMat &Kg, const Job &job, const std::vector<Tie> &ties) {
+  (*this)(Kg, job, ties, DofMap<Config>(job.nodes.size()));
+};
+
+template <typename Config>
+void BasicGlobalStiffAssembler<Config>::operator()(
+    SparseMat &Kg, const Job &job, const std::vector<Tie> &ties,
+    const DofMap<Config> &dof_map) {
+  ForceVector force_vec = ForceVector::Zero(Kg.rows());
+  (*this)(Kg, force_vec, job, ties, std::vector<BC>(), std::vector<Equation>(),
+          dof_map);
+};
+
+template <typename Config>
+void BasicGlobalStiffAssembler<Config>::operator()(
+    SparseMat &Kg, ForceVector &force_vec, const Job &job,
+    const std::vector<Tie> &ties, const std::vector<BC> &BCs,
+    const std::vector<Equation> &equations, const DofMap<Config> &dof_map) {
+  const unsigned int dofs_per_elem = Config::NUM_DOFS;
 
   // form vector to hold triplets that will be used to assemble global stiffness
   // matrix
-  std::vector<Eigen::Triplet<double>> triplets;
-  triplets.reserve(40 * job.elems.size() + 4 * dofs_per_elem * ties.size());
-
-  perElemKlocalAelem.resize(job.elems.size());
-  for (unsigned int i = 0; i < job.elems.size(); ++i) {
-    // update Kelem with current elemental stiffness matrix
-    calcKelem(i, job); // 12x12 matrix
-
-    // get sparse representation of the current elemental stiffness matrix
-    SparseKelem = Kelem.sparseView();
-
-    // pull out current node indices
-    nn1 = job.elems[i][0];
-    nn2 = job.elems[i][1];
-
-    for (unsigned int j = 0; j < SparseKelem.outerSize(); ++j) {
-      for (SparseMat::InnerIterator it(SparseKelem, j); it; ++it) {
-        row = it.row();
-        col = it.col();
-
-        // check position in local matrix and update corresponding global
-        // position
-        if (row < 6) {
-          // top left
-          if (col < 6) {
-            triplets.push_back(Eigen::Triplet<double>(dofs_per_elem * nn1 + row,
-                                                      dofs_per_elem * nn1 + col,
-                                                      it.value()));
-          }
-          // top right
-          else {
-            triplets.push_back(Eigen::Triplet<double>(
-                dofs_per_elem * nn1 + row, dofs_per_elem * (nn2 - 1) + col,
-                it.value())); // I: Giati nn2-1 kai oxi nn2?
-          }
-        } else {
-          // bottom left
-          if (col < 6) {
-            triplets.push_back(Eigen::Triplet<double>(
-                dofs_per_elem * (nn2 - 1) + row, dofs_per_elem * nn1 + col,
-                it.value())); // I: Giati nn2-1 kai oxi nn2? Epeidi ta nn2 ston
-                              // Kelem exoun idi offset 6
-          }
-          // bottom right
-          else {
-            triplets.push_back(Eigen::Triplet<double>(
-                dofs_per_elem * (nn2 - 1) + row,
-                dofs_per_elem * (nn2 - 1) + col, it.value()));
-          }
-        }
+  size_t num_eqn_terms = 0;
+  for (size_t i = 0; i < equations.size(); ++i) {
+    num_eqn_terms += equations[i].terms.size();
+  }
+  std::vector<Triplet> triplets;
+  triplets.reserve(40 * job.elems.size() + 4 * dofs_per_elem * ties.size() +
+                   2 * BCs.size() + 2 * num_eqn_terms);
+
+  uniqueKlocalAelem.clear();
+  uniqueKelem.clear();
+  const bool keep_operators = cacheElemMatrices || keepForceOperators;
+  perElemKlocalAelemIdx.resize(keep_operators ? job.elems.size() : 0);
+  std::unordered_map<ElemMatrixKey, ElemMatrixIndex, ElemMatrixKeyHash> cache;
+  if (!cacheElemMatrices && keepForceOperators) {
+    uniqueKlocalAelem.reserve(job.elems.size());
+  }
+
+  for (size_t i = 0; i < job.elems.size(); ++i) {
+    if (cacheElemMatrices) {
+      // reuse the matrices of a previously computed, identical element
+      const ElemMatrixKey key = makeElemMatrixKey(i, job, cacheTolerance);
+      auto found = cache.find(key);
+      if (found != cache.end()) {
+        Kelem = uniqueKelem[found->second];
+        perElemKlocalAelemIdx[i] = found->second;
+      } else {
+        calcKelem(i, job); // 12x12 matrix
+        cache.emplace(key, uniqueKlocalAelem.size());
+        perElemKlocalAelemIdx[i] = uniqueKlocalAelem.size();
+        uniqueKlocalAelem.push_back(KlocalAelem);
+        uniqueKelem.push_back(Kelem);
+      }
+    } else {
+      // update Kelem with current elemental stiffness matrix
+      calcKelem(i, job); // 12x12 matrix
+      if (keepForceOperators) {
+        perElemKlocalAelemIdx[i] = uniqueKlocalAelem.size();
+        uniqueKlocalAelem.push_back(KlocalAelem);
       }
     }
+
+    scatterKelem(triplets, job.elems[i][0], job.elems[i][1], dof_map);
   }
 
-  loadTies(triplets, ties);
+  loadTies<Config>(triplets, ties, dof_map);
+
+  // the Lagrange multipliers of boundary conditions and equations border the
+  // stiffness matrix, so the whole system is formed in a single pass
+  loadBCs<Config>(triplets, force_vec, BCs, dof_map);
+  loadEquations<Config>(triplets, equations, dof_map, BCs.size());
 
+  checkNumCoefficients(triplets.size());
   Kg.setFromTriplets(triplets.begin(), triplets.end());
 };
 
-void loadBCs(SparseMat &Kg, SparseMat &force_vec, const std::vector<BC> &BCs,
-             unsigned int num_nodes) {
-  unsigned int bc_idx;
-  const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+template <typename Config>
+void BasicGlobalStiffAssembler<Config>::operator()(
+    SparseMat &Kg, ForceVector &force_vec, const std::vector<Node> &nodes,
+    ElementStream &elements, const std::vector<Tie> &ties,
+    const std::vector<BC> &BCs, const std::vector<Equation> &equations,
+    const DofMap<Config> &dof_map) {
+  uniqueKlocalAelem.clear();
+  uniqueKelem.clear();
+  perElemKlocalAelemIdx.clear();
+
+  // [count the coefficients of each column in a first pass over the elements,
+  // so the matrix is allocated once and filled in place. The coefficients of
+  // the ties and the Lagrange multipliers of boundary conditions and
+  // equations do not depend on the elements.
+  const size_t num_dofs = dof_map.getNumDofs();
+  std::vector<std::uint64_t> node_patterns(num_dofs / Config::NUM_DOFS, 0);
+  std::vector<StorageIndex> column_sizes(Kg.cols(), 0);
+  std::vector<Triplet> constraint_triplets;
+  loadTies<Config>(constraint_triplets, ties, dof_map);
+  loadBCs<Config>(constraint_triplets, force_vec, BCs, dof_map);
+  loadEquations<Config>(constraint_triplets, equations, dof_map, BCs.size());
+  countCoefficients(constraint_triplets, num_dofs, Config::NUM_DOFS,
+                    node_patterns, column_sizes);
+
+  std::vector<Triplet> triplets;
+  triplets.reserve(40 * elements.getChunkSize());
+  ElementChunk chunk;
+  elements.rewind();
+  while (elements.next(chunk)) {
+    for (size_t i = 0; i < chunk.elems.size(); ++i) {
+      const NodeIndex nn1 = chunk.elems[i][0];
+      const NodeIndex nn2 = chunk.elems[i][1];
+      if (nn1 >= nodes.size() || nn2 >= nodes.size()) {
+        throw std::runtime_error(
+            (boost::format("Element %d refers to node %d, but only %d nodes "
+                           "were provided.") %
+             (chunk.first + i) % std::max(nn1, nn2) % nodes.size())
+                .str());
+      }
+      calcKelem(nodes[nn1], nodes[nn2], chunk.props[i],
+                chunk.props[i].normal_vec);
+      triplets.clear();
+      scatterKelem(triplets, nn1, nn2, dof_map);
+      countCoefficients(triplets, num_dofs, Config::NUM_DOFS, node_patterns,
+                        column_sizes);
+    }
+  }
+  addNodePatterns(node_patterns, Config::NUM_DOFS, column_sizes);
+  std::vector<std::uint64_t>().swap(node_patterns);
+
+  size_t num_coefficients = 0;
+  for (size_t i = 0; i < column_sizes.size(); ++i) {
+    num_coefficients += column_sizes[i];
+  }
+  checkNumCoefficients(num_coefficients);
+  Kg.setZero();
+  Kg.reserve(column_sizes);
+  // ]
+
+  // add the coefficients of each chunk to the reserved columns before reading
+  // the next, so only the matrix and one chunk are held in memory
+  for (size_t i = 0; i < constraint_triplets.size(); ++i) {
+    Kg.coeffRef(constraint_triplets[i].row(), constraint_triplets[i].col()) +=
+        constraint_triplets[i].value();
+  }
+  elements.rewind();
+  while (elements.next(chunk)) {
+    triplets.clear();
+    for (size_t i = 0; i < chunk.elems.size(); ++i) {
+      calcKelem(nodes[chunk.elems[i][0]], nodes[chunk.elems[i][1]],
+                chunk.props[i], chunk.props[i].normal_vec);
+      scatterKelem(triplets, chunk.elems[i][0], chunk.elems[i][1], dof_map);
+    }
+    for (size_t i = 0; i < triplets.size(); ++i) {
+      Kg.coeffRef(triplets[i].row(), triplets[i].col()) += triplets[i].value();
+    }
+  }
+  Kg.makeCompressed();
+};
+
+template <typename Config>
+void BasicGlobalStiffAssembler<Config>::scatterKelem(
+    std::vector<Triplet> &triplets, NodeIndex nn1, NodeIndex nn2,
+    const DofMap<Config> &dof_map) {
+  NodeIndex row_node, col_node;
+  unsigned int row, col, num_row_terms, num_col_terms;
+  StorageIndex row_idx[DofMap<Config>::MAX_TERMS] = {},
+      col_idx[DofMap<Config>::MAX_TERMS] = {};
+  double row_coeff[DofMap<Config>::MAX_TERMS] = {},
+      col_coeff[DofMap<Config>::MAX_TERMS] = {};
+
+  // get sparse representation of the current elemental stiffness matrix
+  SparseKelem = Kelem.sparseView();
+
+  for (StorageIndex j = 0; j < SparseKelem.outerSize(); ++j) {
+    for (SparseMat::InnerIterator it(SparseKelem, j); it; ++it) {
+      row = it.row();
+      col = it.col();
+
+      // the first 6 rows and columns of the local matrix belong to the
+      // first node, the last 6 to the second node. DOFs that are not part
+      // of the global system expand to no terms, DOFs of slave nodes to the
+      // unknowns of their master node.
+      row_node = row < DOF::NUM_DOFS ? nn1 : nn2;
+      col_node = col < DOF::NUM_DOFS ? nn1 : nn2;
+      num_row_terms = dof_map.expand(row_node, row % DOF::NUM_DOFS, row_idx,
+                                     row_coeff);
+      num_col_terms = dof_map.expand(col_node, col % DOF::NUM_DOFS, col_idx,
+                                     col_coeff);
+
+      for (unsigned int k = 0; k < num_row_terms; ++k) {
+        for (unsigned int l = 0; l < num_col_terms; ++l) {
+          triplets.push_back(Triplet(row_idx[k], col_idx[l],
+                                     row_coeff[k] * col_coeff[l] * it.value()));
+        }
+      }
+    }
+  }
+};
+
+template <typename Config>
+void loadBCs(std::vector<Triplet> &triplets, ForceVector &force_vec,
+             const std::vector<BC> &BCs, const DofMap<Config> &dof_map) {
+  unsigned int num_terms;
+  StorageIndex bc_idx[DofMap<Config>::MAX_TERMS] = {};
+  double coeff[DofMap<Config>::MAX_TERMS] = {};
   // calculate the index that marks beginning of Lagrange multiplier
   // coefficients
-  const unsigned int global_add_idx = dofs_per_elem * num_nodes;
+  const StorageIndex global_add_idx = dof_map.getNumDofs();
 
   for (size_t i = 0; i < BCs.size(); ++i) {
-    bc_idx = dofs_per_elem * BCs[i].node + BCs[i].dof;
-
-    // update global stiffness matrix
-    Kg.insert(bc_idx, global_add_idx + i) = 1;
-    Kg.insert(global_add_idx + i, bc_idx) = 1;
+    num_terms = dof_map.expand(BCs[i].node, BCs[i].dof, bc_idx, coeff);
+    if (num_terms == 0) {
+      throw std::runtime_error(
+          (boost::format("Boundary condition %d constrains DOF %d, which is "
+                         "not part of the analysis type.") %
+           i % BCs[i].dof)
+              .str());
+    }
 
-    // update force vector. All values are already zero. Only update if BC if
-    // non-zero.
-    if (std::abs(BCs[i].value) > std::numeric_limits<double>::epsilon()) {
-      force_vec.insert(global_add_idx + i, 0) = BCs[i].value;
+    // add the border coefficients of the global stiffness matrix
+    for (unsigned int k = 0; k < num_terms; ++k) {
+      triplets.push_back(Triplet(bc_idx[k], global_add_idx + i, coeff[k]));
+      triplets.push_back(Triplet(global_add_idx + i, bc_idx[k], coeff[k]));
     }
+
+    // update force vector
+    force_vec(global_add_idx + i) = BCs[i].value;
   }
 };
 
-void loadEquations(SparseMat &Kg, const std::vector<Equation> &equations,
-                   unsigned int num_nodes, unsigned int num_bcs) {
-  size_t row_idx, col_idx;
-  const unsigned int dofs_per_elem = DOF::NUM_DOFS;
-  const unsigned int global_add_idx = dofs_per_elem * num_nodes + num_bcs;
+template <typename Config>
+void loadEquations(std::vector<Triplet> &triplets,
+                   const std::vector<Equation> &equations,
+                   const DofMap<Config> &dof_map, size_t num_bcs) {
+  StorageIndex row_idx;
+  unsigned int num_terms;
+  StorageIndex col_idx[DofMap<Config>::MAX_TERMS] = {};
+  double coeff[DofMap<Config>::MAX_TERMS] = {};
+  const StorageIndex global_add_idx = dof_map.getNumDofs() + num_bcs;
 
   for (size_t i = 0; i < equations.size(); ++i) {
     row_idx = global_add_idx + i;
     for (size_t j = 0; j < equations[i].terms.size(); ++j) {
-      col_idx = dofs_per_elem * equations[i].terms[j].node_number +
-                equations[i].terms[j].dof;
-      Kg.insert(row_idx, col_idx) = equations[i].terms[j].coefficient;
-      Kg.insert(col_idx, row_idx) = equations[i].terms[j].coefficient;
+      // DOFs that are not part of the analysis type are identically zero, so
+      // their terms do not contribute to the equation. Terms on slave nodes
+      // may share unknowns with other terms, the duplicate triplets are
+      // summed.
+      const Equation::Term &term = equations[i].terms[j];
+      num_terms = dof_map.expand(term.node_number, term.dof, col_idx, coeff);
+      for (unsigned int k = 0; k < num_terms; ++k) {
+        triplets.push_back(
+            Triplet(row_idx, col_idx[k], coeff[k] * term.coefficient));
+        triplets.push_back(
+            Triplet(col_idx[k], row_idx, coeff[k] * term.coefficient));
+      }
     }
   }
 };
 
-void loadTies(std::vector<Eigen::Triplet<double>> &triplets,
-              const std::vector<Tie> &ties) {
-  const unsigned int dofs_per_elem = DOF::NUM_DOFS;
-  unsigned int nn1, nn2;
+template <typename Config>
+void loadTies(std::vector<Triplet> &triplets, const std::vector<Tie> &ties,
+              const DofMap<Config> &dof_map) {
+  const unsigned int dofs_per_elem = Config::NUM_DOFS;
+  NodeIndex nn1, nn2;
+  unsigned int num_terms;
+  // the spring acts on the difference of the DOF of both nodes
+  StorageIndex idx[2 * DofMap<Config>::MAX_TERMS];
+  double coeff[2 * DofMap<Config>::MAX_TERMS];
   double lmult, rmult, spring_constant;
 
   for (size_t i = 0; i < ties.size(); ++i) {
@@ -280,32 +683,33 @@ void loadTies(std::vector<Eigen::Triplet<double>> &triplets,
     for (unsigned int j = 0; j < dofs_per_elem; ++j) {
       // first 3 DOFs are linear DOFs, second 2 are rotational, last is
       // torsional
-      spring_constant = j < 3 ? lmult : rmult;
-
-      triplets.push_back(Eigen::Triplet<double>(
-          dofs_per_elem * nn1 + j, dofs_per_elem * nn1 + j, spring_constant));
-
-      triplets.push_back(Eigen::Triplet<double>(
-          dofs_per_elem * nn2 + j, dofs_per_elem * nn2 + j, spring_constant));
-
-      triplets.push_back(Eigen::Triplet<double>(
-          dofs_per_elem * nn1 + j, dofs_per_elem * nn2 + j, -spring_constant));
+      spring_constant = Config::dof(j) < 3 ? lmult : rmult;
+
+      num_terms = dof_map.expand(nn1, Config::dof(j), idx, coeff);
+      const unsigned int num_terms_1 = num_terms;
+      num_terms += dof_map.expand(nn2, Config::dof(j), idx + num_terms,
+                                  coeff + num_terms);
+      for (unsigned int k = num_terms_1; k < num_terms; ++k) {
+        coeff[k] = -coeff[k];
+      }
 
-      triplets.push_back(Eigen::Triplet<double>(
-          dofs_per_elem * nn2 + j, dofs_per_elem * nn1 + j, -spring_constant));
+      for (unsigned int k = 0; k < num_terms; ++k) {
+        for (unsigned int l = 0; l < num_terms; ++l) {
+          triplets.push_back(
+              Triplet(idx[k], idx[l], coeff[k] * coeff[l] * spring_constant));
+        }
+      }
     }
   }
 };
 
-std::vector<std::vector<double>>
-computeTieForces(const std::vector<Tie> &ties,
-                 const std::vector<std::vector<double>> &nodal_displacements) {
+NodalResults computeTieForces(const std::vector<Tie> &ties,
+                              const NodalResults &nodal_displacements) {
   const unsigned int dofs_per_elem = DOF::NUM_DOFS;
-  unsigned int nn1, nn2;
+  NodeIndex nn1, nn2;
   double lmult, rmult, spring_constant, delta1, delta2;
 
-  std::vector<std::vector<double>> tie_forces(
-      ties.size(), std::vector<double>(dofs_per_elem));
+  NodalResults tie_forces(ties.size(), dofs_per_elem);
 
   for (size_t i = 0; i < ties.size(); ++i) {
     nn1 = ties[i].node_number_1;
@@ -317,50 +721,408 @@ computeTieForces(const std::vector<Tie> &ties,
       // first 3 DOFs are linear DOFs, second 2 are rotational, last is
       // torsional
       spring_constant = j < 3 ? lmult : rmult;
-      delta1 = nodal_displacements[nn1][j];
-      delta2 = nodal_displacements[nn2][j];
-      tie_forces[i][j] = spring_constant * (delta2 - delta1);
+      delta1 = nodal_displacements(nn1, j);
+      delta2 = nodal_displacements(nn2, j);
+      tie_forces(i, j) = spring_constant * (delta2 - delta1);
     }
   }
   return tie_forces;
 }
 
-void loadForces(SparseMat &force_vec, const std::vector<Force> &forces) {
-  const unsigned int dofs_per_elem = DOF::NUM_DOFS;
-  unsigned int idx;
+template <typename Config>
+void loadForces(ForceVector &force_vec, const std::vector<Force> &forces,
+                const DofMap<Config> &dof_map) {
+  unsigned int num_terms;
+  StorageIndex idx[DofMap<Config>::MAX_TERMS] = {};
+  double coeff[DofMap<Config>::MAX_TERMS] = {};
 
   for (size_t i = 0; i < forces.size(); ++i) {
-    idx = dofs_per_elem * forces[i].node + forces[i].dof;
-    force_vec.insert(idx, 0) = forces[i].value;
+    num_terms = dof_map.expand(forces[i].node, forces[i].dof, idx, coeff);
+    if (num_terms == 0) {
+      if (std::abs(forces[i].value) > std::numeric_limits<double>::epsilon()) {
+        throw std::runtime_error(
+            (boost::format("Force %d acts on DOF %d, which is not part of the "
+                           "analysis type.") %
+             i % forces[i].dof)
+                .str());
+      }
+      continue;
+    }
+    // forces on slave nodes also exert a moment about the master node.
+    // Several forces on the same DOF add up.
+    for (unsigned int k = 0; k < num_terms; ++k) {
+      force_vec(idx[k]) += coeff[k] * forces[i].value;
+    }
   }
 };
 
-Summary solve(const Job &job, const std::vector<BC> &BCs,
-              const std::vector<Force> &forces, const std::vector<Tie> &ties,
-              const std::vector<Equation> &equations, const Options &options) {
-  auto initial_start_time = std::chrono::high_resolution_clock::now();
+namespace {
+// Saves the contiguous results `data` to `filename` in the result format
+// selected in `options`.
+template <typename Results>
+void saveResults(const std::string &filename, const Results &data,
+                 const Options &options) {
+  switch (options.result_format) {
+  case RAW_BINARY_RESULTS:
+    writeRawBinary(filename, data.data(), data.rows(), data.cols());
+    break;
+  case NPY_RESULTS:
+    writeNpy(filename, data.data(), data.rows(), data.cols());
+    break;
+  default:
+    CSVParser csv;
+    csv.write(filename, data.data(), data.rows(), data.cols(),
+              options.csv_precision, options.csv_delimiter);
+  }
+}
 
-  Summary summary;
-  summary.num_nodes = job.nodes.size();
-  summary.num_elems = job.elems.size();
-  summary.num_bcs = BCs.size();
-  summary.num_ties = ties.size();
+// Return whether the nodal, tie and elemental forces are requested by
+// `options`, either to be returned in the summary or to be saved.
+bool needsNodalForces(const Options &options) {
+  return options.compute_nodal_forces || options.save_nodal_forces;
+}
 
-  const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+bool needsTieForces(const Options &options) {
+  return options.compute_tie_forces || options.save_tie_forces;
+}
+
+bool needsElementForces(const Options &options) {
+  return options.compute_element_forces || options.save_elemental_forces;
+}
+
+// Returns the product of the leading `num_dofs` x `num_dofs` block of `Kg`
+// with the first `num_dofs` entries of `disp` without copying the block. The
+// block holds the element and tie stiffnesses and is symmetric, so the row of
+// each result is gathered from the matching column of the column-major matrix
+// and the columns are processed concurrently if OpenMP is enabled.
+Eigen::VectorXd multiplyStiffnessBlock(const SparseMat &Kg,
+                                       const Eigen::VectorXd &disp,
+                                       StorageIndex num_dofs) {
+  Eigen::VectorXd product(num_dofs);
+  const long long num_cols = num_dofs;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long long j = 0; j < num_cols; ++j) {
+    double sum = 0.0;
+    // the row indices of a compressed column are sorted
+    for (SparseMat::InnerIterator it(Kg, j); it && it.row() < num_dofs; ++it) {
+      sum += it.value() * disp(it.row());
+    }
+    product(j) = sum;
+  }
+  return product;
+}
+
+// Returns the boundary conditions that act on DOFs of the analysis type. DOFs
+// outside of the analysis type are identically zero, so boundary conditions
+// holding them at zero are dropped.
+template <typename Config>
+std::vector<BC> activeBCs(const std::vector<BC> &BCs) {
+  std::vector<BC> active_bcs;
+  active_bcs.reserve(BCs.size());
+  for (size_t i = 0; i < BCs.size(); ++i) {
+    if (Config::activeIndex(BCs[i].dof) >= 0) {
+      active_bcs.push_back(BCs[i]);
+    } else if (std::abs(BCs[i].value) >
+               std::numeric_limits<double>::epsilon()) {
+      throw std::runtime_error(
+          (boost::format("Boundary condition %d prescribes a non-zero value "
+                         "on DOF %d, which is not part of the analysis type.") %
+           i % BCs[i].dof)
+              .str());
+    }
+  }
+  return active_bcs;
+}
+
+// Returns `BCs` without the boundary conditions whose constraint is a linear
+// combination of the ones before it. This happens when several nodes of a
+// rigid body, e.g. merged coincident nodes, carry boundary conditions, since
+// their DOFs are expanded into the DOFs of the same master node. Repeating
+// such a constraint would make the bordered system structurally singular.
+// Throws if a dropped boundary condition contradicts the values prescribed by
+// the others. `node_ids` maps the nodes of `dof_map` to the node numbers
+// reported in the error message and is empty if they are the same.
+template <typename Config>
+std::vector<BC> independentBCs(const std::vector<BC> &BCs,
+                               const DofMap<Config> &dof_map,
+                               const std::vector<NodeIndex> &node_ids) {
+  typedef Eigen::Matrix<double, Config::NUM_DOFS + 1, 1, Eigen::DontAlign>
+      ConstraintRow;
+  struct ReducedRow {
+    unsigned int pivot;
+    ConstraintRow row;
+  };
+  unsigned int num_terms;
+  StorageIndex idx[DofMap<Config>::MAX_TERMS] = {};
+  double coeff[DofMap<Config>::MAX_TERMS] = {};
+
+  // rows of the kept boundary conditions of each master node, reduced to
+  // echelon form. The last entry of a row is the prescribed value.
+  std::map<size_t, std::vector<ReducedRow>> reduced_rows;
+  std::vector<BC> independent_bcs;
+  independent_bcs.reserve(BCs.size());
+  for (size_t i = 0; i < BCs.size(); ++i) {
+    num_terms = dof_map.expand(BCs[i].node, BCs[i].dof, idx, coeff);
+    if (num_terms == 0) {
+      // reported by loadBCs
+      independent_bcs.push_back(BCs[i]);
+      continue;
+    }
+    const size_t first_idx = dof_map.getDofIndex(BCs[i].node);
+    ConstraintRow row = ConstraintRow::Zero();
+    for (unsigned int k = 0; k < num_terms; ++k) {
+      row(idx[k] - first_idx) += coeff[k];
+    }
+    row(Config::NUM_DOFS) = BCs[i].value;
+    const double scale =
+        row.template head<Config::NUM_DOFS>().cwiseAbs().maxCoeff();
+    double value_scale = std::abs(BCs[i].value);
+
+    std::vector<ReducedRow> &rows = reduced_rows[first_idx];
+    for (size_t j = 0; j < rows.size(); ++j) {
+      value_scale = std::max(value_scale,
+                             std::abs(rows[j].row(Config::NUM_DOFS)));
+      row -= row(rows[j].pivot) * rows[j].row;
+    }
+    unsigned int pivot;
+    const double max_coeff =
+        row.template head<Config::NUM_DOFS>().cwiseAbs().maxCoeff(&pivot);
+    if (max_coeff > 1e-10 * scale) {
+      rows.push_back({pivot, row / row(pivot)});
+      independent_bcs.push_back(BCs[i]);
+    } else if (std::abs(row(Config::NUM_DOFS)) > 1e-9 * value_scale) {
+      throw std::runtime_error(
+          (boost::format("Boundary condition %d on DOF %d of node %d "
+                         "contradicts the boundary conditions before it, "
+                         "which already determine this DOF through a rigid "
+                         "body or merged coincident nodes.") %
+           i % BCs[i].dof %
+           (node_ids.empty() ? BCs[i].node : node_ids[BCs[i].node]))
+              .str());
+    }
+  }
+  return independent_bcs;
+}
+
+// Throws if a node of a planar analysis lies out of the x-y plane. The
+// out-of-plane DOFs are not part of the global system, so such nodes would
+// otherwise be projected onto the plane without notice.
+template <typename Config> void checkPlanarNodes(const Job &job) {
+  if (!Config::PLANAR) {
+    return;
+  }
+  double scale = 1.0;
+  for (size_t i = 0; i < job.nodes.size(); ++i) {
+    scale = std::max(scale, job.nodes[i].cwiseAbs().maxCoeff());
+  }
+  const double tolerance = 1e-12 * scale;
+  for (size_t i = 0; i < job.nodes.size(); ++i) {
+    if (std::abs(job.nodes[i](2)) > tolerance) {
+      throw std::runtime_error(
+          (boost::format("Node %d has z-coordinate %g, but planar analyses "
+                         "require every node to lie in the x-y plane.") %
+           i % job.nodes[i](2))
+              .str());
+    }
+  }
+}
+
+// Throws if a DOF of the global system has no stiffness and is neither
+// constrained by a boundary condition nor by an equation. `node_ids` maps the
+// nodes of `job` to the node numbers reported in the error message and is
+// empty if they are the same.
+template <typename Config>
+void checkFreeDofs(const SparseMat &Kg, const Job &job,
+                   const std::vector<BC> &BCs,
+                   const std::vector<Equation> &equations,
+                   const DofMap<Config> &dof_map,
+                   const std::vector<NodeIndex> &node_ids) {
+  unsigned int num_terms;
+  StorageIndex idx[DofMap<Config>::MAX_TERMS] = {};
+  double coeff[DofMap<Config>::MAX_TERMS] = {};
+
+  std::vector<bool> constrained(dof_map.getNumDofs(), false);
+  for (size_t i = 0; i < BCs.size(); ++i) {
+    num_terms = dof_map.expand(BCs[i].node, BCs[i].dof, idx, coeff);
+    for (unsigned int k = 0; k < num_terms; ++k) {
+      constrained[idx[k]] = true;
+    }
+  }
+  for (size_t i = 0; i < equations.size(); ++i) {
+    for (size_t j = 0; j < equations[i].terms.size(); ++j) {
+      num_terms = dof_map.expand(equations[i].terms[j].node_number,
+                                 equations[i].terms[j].dof, idx, coeff);
+      for (unsigned int k = 0; k < num_terms; ++k) {
+        constrained[idx[k]] = true;
+      }
+    }
+  }
+
+  const Eigen::VectorXd diagonal = Kg.diagonal();
+  std::string free_dofs;
+  unsigned int num_free_dofs = 0;
+  for (size_t i = 0; i < job.nodes.size(); ++i) {
+    if (dof_map.isSlave(i)) {
+      continue;
+    }
+    const size_t first_idx = dof_map.getDofIndex(i);
+    for (unsigned int j = 0; j < Config::NUM_DOFS; ++j) {
+      if (diagonal(first_idx + j) != 0.0 || constrained[first_idx + j]) {
+        continue;
+      }
+      if (++num_free_dofs <= 10) {
+        free_dofs.append((boost::format("\n\tNode %d DOF %d") %
+                          (node_ids.empty() ? i : node_ids[i]) %
+                          Config::dof(j))
+                             .str());
+      }
+    }
+  }
+  if (num_free_dofs > 0) {
+    throw std::runtime_error(
+        (boost::format("%d DOFs have no stiffness and are not constrained:%s%s") %
+         num_free_dofs % free_dofs % (num_free_dofs > 10 ? "\n\t..." : ""))
+            .str());
+  }
+}
+
+// Displacements or end forces of several elements, one element per column.
+typedef Eigen::Matrix<double, 2 * DOF::NUM_DOFS, Eigen::Dynamic> ElemMatrix;
+
+// Number of elements whose forces are recovered together.
+const size_t ELEM_FORCE_BATCH_SIZE = 256;
+
+// Copies the displacements of the nodes of `elems[first, first + count)` into
+// the leading columns of `elem_disps`.
+void gatherElemDisps(const NodalResults &disp,
+                     const std::vector<Connectivity> &elems, size_t first,
+                     size_t count, ElemMatrix &elem_disps) {
+  for (size_t i = 0; i < count; ++i) {
+    const Connectivity &elem = elems[first + i];
+    elem_disps.col(i).head<DOF::NUM_DOFS>() = disp.row(elem(0)).transpose();
+    elem_disps.col(i).tail<DOF::NUM_DOFS>() = disp.row(elem(1)).transpose();
+  }
+}
+
+// Stores the local end forces `elem_forces` of an element in row `row` of
+// `forces`.
+template <typename Derived>
+void storeElemForces(const Eigen::MatrixBase<Derived> &elem_forces,
+                     ElementResults &forces, size_t row) {
+  forces.row(row).head<DOF::NUM_DOFS>() =
+      -elem_forces.template head<DOF::NUM_DOFS>().transpose();
+  // meaning of sign = reference to first node:
+  // + = compression for axial, - traction
+  forces.row(row).tail<DOF::NUM_DOFS>() =
+      elem_forces.template tail<DOF::NUM_DOFS>().transpose();
+}
+
+// Computes the end forces of every element of `elems` from the force
+// operators kept by `assembler`. The elements are processed in batches,
+// concurrently if OpenMP is enabled. Within a batch, consecutive elements that
+// share a force operator are multiplied as one matrix product, so the
+// arithmetic is vectorized across elements when element matrices are cached.
+template <typename Config>
+void recoverElemForces(const BasicGlobalStiffAssembler<Config> &assembler,
+                       const std::vector<Connectivity> &elems,
+                       const NodalResults &disp,
+                       ElementResults &element_forces) {
+  element_forces.resize(elems.size(), Eigen::NoChange);
+  const long long num_batches =
+      (elems.size() + ELEM_FORCE_BATCH_SIZE - 1) / ELEM_FORCE_BATCH_SIZE;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+  {
+    ElemMatrix elem_disps(2 * DOF::NUM_DOFS, ELEM_FORCE_BATCH_SIZE);
+    ElemMatrix elem_forces(2 * DOF::NUM_DOFS, ELEM_FORCE_BATCH_SIZE);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (long long b = 0; b < num_batches; ++b) {
+      const size_t first = b * ELEM_FORCE_BATCH_SIZE;
+      const size_t count =
+          std::min(ELEM_FORCE_BATCH_SIZE, elems.size() - first);
+      gatherElemDisps(disp, elems, first, count, elem_disps);
+
+      size_t start = 0;
+      while (start < count) {
+        const LocalMatrix &KlocalAelem =
+            assembler.getKlocalAelem(first + start);
+        size_t end = start + 1;
+        while (end < count &&
+               &assembler.getKlocalAelem(first + end) == &KlocalAelem) {
+          ++end;
+        }
+        elem_forces.middleCols(start, end - start).noalias() =
+            KlocalAelem * elem_disps.middleCols(start, end - start);
+        start = end;
+      }
+
+      for (size_t i = 0; i < count; ++i) {
+        storeElemForces(elem_forces.col(i), element_forces, first + i);
+      }
+    }
+  }
+}
+
+// Assembles and solves the global system of `job` and stores the nodal
+// displacements, nodal forces, tie forces, element forces and the time taken
+// by each step in `summary`. `node_ids` is passed to `checkFreeDofs`. If
+// `element_stream` is not null the elements are read from it instead of
+// `job`, once to assemble the system and once to recover the element forces.
+template <typename Config>
+void solveSystem(const Job &job, const std::vector<BC> &active_BCs,
+                 const std::vector<Force> &forces, const std::vector<Tie> &ties,
+                 const std::vector<Equation> &equations,
+                 const std::vector<RigidBody> &rigid_bodies,
+                 const Options &options,
+                 const std::vector<NodeIndex> &node_ids, Summary &summary,
+                 ElementStream *element_stream = nullptr) {
+  const unsigned int dofs_per_elem = Config::NUM_DOFS;
+
+  // condense the DOFs of slave nodes into their master nodes
+  const DofMap<Config> dof_map(job, rigid_bodies);
+
+  // drop the boundary conditions that repeat constraints of rigid bodies
+  const std::vector<BC> BCs = independentBCs(active_BCs, dof_map, node_ids);
+  if (options.verbose && BCs.size() < active_BCs.size()) {
+    std::cout << "Dropped " << active_BCs.size() - BCs.size()
+              << " redundant boundary conditions." << std::endl;
+  }
 
   // calculate size of global stiffness matrix and force vector
-  const unsigned long size =
-      dofs_per_elem * job.nodes.size() + BCs.size() + equations.size();
+  const size_t num_unknowns =
+      dof_map.getNumDofs() + BCs.size() + equations.size();
+  if (num_unknowns >
+      static_cast<size_t>(std::numeric_limits<StorageIndex>::max())) {
+    throw std::runtime_error(
+        (boost::format("The global system has %d unknowns, which exceeds the "
+                       "range of its %d-bit indices. Rebuild with "
+                       "FEA_USE_64BIT_INDICES.") %
+         num_unknowns % (8 * sizeof(StorageIndex)))
+            .str());
+  }
+  const StorageIndex num_dofs = dof_map.getNumDofs();
+  const StorageIndex size = num_unknowns;
 
   // construct global stiffness matrix and force vector
   SparseMat Kg(size, size);
-  SparseMat force_vec(size, 1);
-  force_vec.reserve(forces.size() + BCs.size());
+  ForceVector force_vec = ForceVector::Zero(size);
 
   // construct global assembler object and assemble global stiffness matrix
   auto start_time = std::chrono::high_resolution_clock::now();
-  GlobalStiffAssembler assembleK3D = GlobalStiffAssembler();
-  assembleK3D(Kg, job, ties);
+  BasicGlobalStiffAssembler<Config> assembleK3D(
+      options.cache_element_matrices, options.element_cache_tolerance,
+      needsElementForces(options));
+  if (element_stream) {
+    assembleK3D(Kg, force_vec, job.nodes, *element_stream, ties, BCs,
+                equations, dof_map);
+  } else {
+    assembleK3D(Kg, force_vec, job, ties, BCs, equations, dof_map);
+  }
   auto end_time = std::chrono::high_resolution_clock::now();
   auto delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(
                         end_time - start_time)
@@ -371,54 +1133,24 @@ Summary solve(const Job &job, const std::vector<BC> &BCs,
     std::cout << "Global stiffness matrix assembled in " << delta_time
               << " ms.\nNow preprocessing factorization..." << std::endl;
 
-  unsigned int numberOfDoF = DOF::NUM_DOFS * job.nodes.size();
-#ifdef DEBUG_FILE
-  Eigen::MatrixXd KgNoBCDense(Kg.block(0, 0, numberOfDoF, numberOfDoF));
-  std::ofstream kgNoBCFile("KgNoBC.csv");
-  if (kgNoBCFile.is_open()) {
-    const static Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,
-                                           Eigen::DontAlignCols, ", ", "\n");
-    kgNoBCFile << KgNoBCDense.format(CSVFormat) << '\n';
-    kgNoBCFile.close();
-  }
-//    std::cout << KgNoBCDense << std::endl;
-#endif
-  // load prescribed boundary conditions into stiffness matrix and force vector
-  loadBCs(Kg, force_vec, BCs, job.nodes.size());
-
-  if (equations.size() > 0) {
-    loadEquations(Kg, equations, job.nodes.size(), BCs.size());
-  }
+  // report DOFs that would make the factorization fail
+  checkFreeDofs(Kg, job, BCs, equations, dof_map, node_ids);
 
   // load prescribed forces into force vector
   if (forces.size() > 0) {
-    loadForces(force_vec, forces);
+    loadForces(force_vec, forces, dof_map);
   }
-#ifdef DEBUG_FILE
-  Eigen::MatrixXd KgDense(Kg);
-  //    std::cout << KgDense << std::endl;
-  Eigen::VectorXd forcesVectorDense(force_vec);
-//    std::cout << forcesVectorDense << std::endl;
-#endif
-  // compress global stiffness matrix since all non-zero values have been added.
+  // drop coefficients that cancelled out during assembly. The matrix is
+  // already compressed by `setFromTriplets`.
   Kg.prune(1.e-14);
-  Kg.makeCompressed();
-#ifdef DEBUG_FILE
-  std::ofstream kgFile("Kg.csv");
-  if (kgFile.is_open()) {
-    const static Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,
-                                           Eigen::DontAlignCols, ", ", "\n");
-    kgFile << KgDense.format(CSVFormat) << '\n';
-    kgFile.close();
-  }
-  std::ofstream forcesFile("forces.csv");
-  if (forcesFile.is_open()) {
-    const static Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,
-                                           Eigen::DontAlignCols, ", ", "\n");
-    forcesFile << forcesVectorDense.format(CSVFormat) << '\n';
-    forcesFile.close();
+
+  if (options.save_global_system) {
+    writeMatrixMarket(options.global_system_prefix + "_KgNoBC.mtx", Kg,
+                      num_dofs, num_dofs);
+    writeMatrixMarket(options.global_system_prefix + "_Kg.mtx", Kg);
+    writeMatrixMarket(options.global_system_prefix + "_rhs.mtx", force_vec);
   }
-#endif
+
   // initialize solver based on whether MKL should be used
 #ifdef EIGEN_USE_MKL_ALL
   Eigen::PardisoLU<SparseMat> solver;
@@ -446,8 +1178,16 @@ Summary solve(const Job &job, const std::vector<BC> &BCs,
   // Compute the numerical factorization
   start_time = std::chrono::high_resolution_clock::now();
   solver.factorize(Kg);
-  std::cout << solver.lastErrorMessage() << std::endl;
-  assert(solver.info() == Eigen::Success);
+  if (solver.info() != Eigen::Success) {
+#ifdef EIGEN_USE_MKL_ALL
+    throw std::runtime_error(
+        "Factorization of the global stiffness matrix failed.");
+#else
+    throw std::runtime_error(
+        "Factorization of the global stiffness matrix failed: " +
+        solver.lastErrorMessage());
+#endif
+  }
   end_time = std::chrono::high_resolution_clock::now();
 
   delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time -
@@ -461,7 +1201,7 @@ Summary solve(const Job &job, const std::vector<BC> &BCs,
 
   // Use the factors to solve the linear system
   start_time = std::chrono::high_resolution_clock::now();
-  SparseMat dispSparse = solver.solve(force_vec);
+  Eigen::VectorXd disp = solver.solve(force_vec);
   end_time = std::chrono::high_resolution_clock::now();
   delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time -
                                                                      start_time)
@@ -472,56 +1212,65 @@ Summary solve(const Job &job, const std::vector<BC> &BCs,
   if (options.verbose)
     std::cout << "System was solved in " << delta_time << " ms.\n" << std::endl;
 
-  // convert to dense matrix
-  Eigen::VectorXd disp(dispSparse);
-
-  // convert from Eigen vector to std vector
-  std::vector<std::vector<double>> disp_vec(job.nodes.size(),
-                                            std::vector<double>(dofs_per_elem));
-  for (size_t i = 0; i < disp_vec.size(); ++i) {
-    for (unsigned int j = 0; j < dofs_per_elem; ++j)
+  // convert from Eigen vector to std vector. Results always hold all 6 DOFs of
+  // a node, DOFs outside of the analysis type remain zero. The DOFs of slave
+  // nodes are recovered from the unknowns of their master nodes.
+  NodalResults &nodal_disp = summary.nodal_displacements;
+  nodal_disp.setZero(job.nodes.size(), DOF::NUM_DOFS);
+  unsigned int num_terms;
+  StorageIndex idx[DofMap<Config>::MAX_TERMS] = {};
+  double coeff[DofMap<Config>::MAX_TERMS] = {};
+  for (size_t i = 0; i < job.nodes.size(); ++i) {
+    for (unsigned int j = 0; j < dofs_per_elem; ++j) {
+      num_terms = dof_map.expand(i, Config::dof(j), idx, coeff);
+      double value = 0.0;
+      for (unsigned int k = 0; k < num_terms; ++k) {
+        value += coeff[k] * disp(idx[k]);
+      }
       // round all values close to 0.0
-      disp_vec[i][j] = std::abs(disp(dofs_per_elem * i + j)) < options.epsilon
-                           ? 0.0
-                           : disp(dofs_per_elem * i + j);
+      nodal_disp(i, Config::dof(j)) =
+          std::abs(value) < options.epsilon ? 0.0 : value;
+    }
   }
-  summary.nodal_displacements = disp_vec;
 
   // [calculate nodal forces
-  start_time = std::chrono::high_resolution_clock::now();
+  if (needsNodalForces(options)) {
+    start_time = std::chrono::high_resolution_clock::now();
 
-  Kg = Kg.topLeftCorner(dofs_per_elem * job.nodes.size(),
-                        dofs_per_elem * job.nodes.size());
-  dispSparse = dispSparse.topRows(dofs_per_elem * job.nodes.size());
+    const Eigen::VectorXd nodal_forces_dense =
+        multiplyStiffnessBlock(Kg, disp, num_dofs);
 
-  SparseMat nodal_forces_sparse = Kg * dispSparse;
+    NodalResults &nodal_forces = summary.nodal_forces;
+    nodal_forces.setZero(job.nodes.size(), DOF::NUM_DOFS);
+    for (size_t i = 0; i < job.nodes.size(); ++i) {
+      // the forces of a rigid body are lumped into its master node
+      if (dof_map.isSlave(i)) {
+        continue;
+      }
+      const size_t first_idx = dof_map.getDofIndex(i);
+      for (unsigned int j = 0; j < dofs_per_elem; ++j)
+        // round all values close to 0.0
+        nodal_forces(i, Config::dof(j)) =
+            std::abs(nodal_forces_dense(first_idx + j)) < options.epsilon
+                ? 0.0
+                : nodal_forces_dense(first_idx + j);
+    }
 
-  Eigen::VectorXd nodal_forces_dense(nodal_forces_sparse);
+    end_time = std::chrono::high_resolution_clock::now();
 
-  std::vector<std::vector<double>> nodal_forces_vec(
-      job.nodes.size(), std::vector<double>(dofs_per_elem));
-  for (size_t i = 0; i < nodal_forces_vec.size(); ++i) {
-    for (unsigned int j = 0; j < dofs_per_elem; ++j)
-      // round all values close to 0.0
-      nodal_forces_vec[i][j] =
-          std::abs(nodal_forces_dense(dofs_per_elem * i + j)) < options.epsilon
-              ? 0.0
-              : nodal_forces_dense(dofs_per_elem * i + j);
+    summary.nodal_forces_solve_time_in_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end_time -
+                                                              start_time)
+            .count();
   }
-  summary.nodal_forces = nodal_forces_vec;
-
-  end_time = std::chrono::high_resolution_clock::now();
-
-  summary.nodal_forces_solve_time_in_ms =
-      std::chrono::duration_cast<std::chrono::milliseconds>(end_time -
-                                                            start_time)
-          .count();
+  // the factors hold their own copy of the matrix
+  SparseMat().swap(Kg);
   //]
 
   // [ calculate forces associated with ties
-  if (ties.size() > 0) {
+  if (ties.size() > 0 && needsTieForces(options)) {
     start_time = std::chrono::high_resolution_clock::now();
-    summary.tie_forces = computeTieForces(ties, disp_vec);
+    summary.tie_forces = computeTieForces(ties, nodal_disp);
     end_time = std::chrono::high_resolution_clock::now();
     summary.tie_forces_solve_time_in_ms =
         std::chrono::duration_cast<std::chrono::milliseconds>(end_time -
@@ -530,27 +1279,245 @@ Summary solve(const Job &job, const std::vector<BC> &BCs,
   }
   // ]
 
+  // Compute per element forces
+  if (!needsElementForces(options)) {
+    // the elements were read once during assembly
+    if (element_stream) {
+      summary.num_elems = element_stream->getNumRead();
+    }
+  } else if (element_stream) {
+    // the force operators were not kept, so they are formed again. The number
+    // of elements is only known at the end of the stream, so the storage
+    // grows geometrically.
+    ElementResults &element_forces = summary.element_forces;
+    size_t num_elems = 0;
+    ElementChunk chunk;
+    element_stream->rewind();
+    while (element_stream->next(chunk)) {
+      num_elems = chunk.first + chunk.elems.size();
+      if (num_elems > static_cast<size_t>(element_forces.rows())) {
+        element_forces.conservativeResize(
+            std::max(num_elems, 2 * static_cast<size_t>(element_forces.rows())),
+            Eigen::NoChange);
+      }
+      ElemMatrix elem_disps(2 * DOF::NUM_DOFS, chunk.elems.size());
+      gatherElemDisps(nodal_disp, chunk.elems, 0, chunk.elems.size(),
+                      elem_disps);
+      for (size_t i = 0; i < chunk.elems.size(); ++i) {
+        assembleK3D.calcKelem(job.nodes[chunk.elems[i][0]],
+                              job.nodes[chunk.elems[i][1]], chunk.props[i],
+                              chunk.props[i].normal_vec);
+        const Eigen::Matrix<double, 2 * DOF::NUM_DOFS, 1> elem_forces =
+            assembleK3D.getKlocalAelem() * elem_disps.col(i);
+        storeElemForces(elem_forces, element_forces, chunk.first + i);
+      }
+    }
+    element_forces.conservativeResize(num_elems, Eigen::NoChange);
+    summary.num_elems = summary.element_forces.rows();
+  } else {
+    recoverElemForces(assembleK3D, job.elems, nodal_disp,
+                      summary.element_forces);
+  }
+}
+
+// Solves each component as a separate system, concurrently if OpenMP is
+// enabled, and gathers the results in `summary`. The time taken by each step
+// is summed over the components.
+template <typename Config>
+void solveComponents(const std::vector<Component> &components, const Job &job,
+                     const std::vector<BC> &BCs,
+                     const std::vector<Force> &forces,
+                     const std::vector<Tie> &ties,
+                     const std::vector<Equation> &equations,
+                     const std::vector<RigidBody> &rigid_bodies,
+                     const Options &options, Summary &summary) {
+  const long long num_components = components.size();
+  std::vector<Summary> summaries(components.size());
+  std::vector<std::string> errors(components.size());
+
+  // progress messages of concurrent solves would interleave
+  Options shared_options(options);
+  shared_options.verbose = false;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (long long c = 0; c < num_components; ++c) {
+    // exceptions may not leave a parallel region
+    try {
+      // each component saves its own global system
+      Options component_options(shared_options);
+      component_options.global_system_prefix +=
+          (boost::format("_component%d") % c).str();
+      const ComponentAnalysis analysis = extractComponent(
+          components[c], job, BCs, forces, ties, equations, rigid_bodies);
+      solveSystem<Config>(analysis.job, analysis.bcs, analysis.forces,
+                          analysis.ties, analysis.equations,
+                          analysis.rigid_bodies, component_options,
+                          components[c].nodes, summaries[c]);
+    } catch (const std::exception &e) {
+      errors[c] = e.what();
+    }
+  }
+
+  for (size_t c = 0; c < components.size(); ++c) {
+    if (!errors[c].empty()) {
+      throw std::runtime_error(errors[c]);
+    }
+  }
+
+  // results that were not requested stay empty
+  const bool has_nodal_forces = needsNodalForces(options);
+  const bool has_element_forces = needsElementForces(options);
+  const bool has_tie_forces = needsTieForces(options) && ties.size() > 0;
+  summary.nodal_displacements.setZero(job.nodes.size(), DOF::NUM_DOFS);
+  summary.nodal_forces.setZero(has_nodal_forces ? job.nodes.size() : 0,
+                               DOF::NUM_DOFS);
+  summary.element_forces.setZero(has_element_forces ? job.elems.size() : 0,
+                                 2 * DOF::NUM_DOFS);
+  summary.tie_forces.setZero(has_tie_forces ? ties.size() : 0, DOF::NUM_DOFS);
+
+  for (size_t c = 0; c < components.size(); ++c) {
+    const Component &component = components[c];
+    Summary &component_summary = summaries[c];
+    for (size_t i = 0; i < component.nodes.size(); ++i) {
+      summary.nodal_displacements.row(component.nodes[i]) =
+          component_summary.nodal_displacements.row(i);
+      if (has_nodal_forces) {
+        summary.nodal_forces.row(component.nodes[i]) =
+            component_summary.nodal_forces.row(i);
+      }
+    }
+    for (size_t i = 0; has_element_forces && i < component.elems.size();
+         ++i) {
+      summary.element_forces.row(component.elems[i]) =
+          component_summary.element_forces.row(i);
+    }
+    for (size_t i = 0; has_tie_forces && i < component.ties.size(); ++i) {
+      summary.tie_forces.row(component.ties[i]) =
+          component_summary.tie_forces.row(i);
+    }
+    summary.assembly_time_in_ms += component_summary.assembly_time_in_ms;
+    summary.preprocessing_time_in_ms +=
+        component_summary.preprocessing_time_in_ms;
+    summary.factorization_time_in_ms +=
+        component_summary.factorization_time_in_ms;
+    summary.solve_time_in_ms += component_summary.solve_time_in_ms;
+    summary.nodal_forces_solve_time_in_ms +=
+        component_summary.nodal_forces_solve_time_in_ms;
+    summary.tie_forces_solve_time_in_ms +=
+        component_summary.tie_forces_solve_time_in_ms;
+  }
+}
+
+template <typename Config>
+Summary solveAnalysis(const Job &job, const std::vector<BC> &all_BCs,
+                      const std::vector<Force> &forces,
+                      const std::vector<Tie> &ties,
+                      const std::vector<Equation> &equations,
+                      const std::vector<RigidBody> &rigid_bodies,
+                      const Options &options, const Summary &load_summary,
+                      ElementStream *element_stream) {
+  auto initial_start_time = std::chrono::high_resolution_clock::now();
+
+  Summary summary;
+  summary.input_load_time_in_ms = load_summary.input_load_time_in_ms;
+  summary.file_load_times_in_ms = load_summary.file_load_times_in_ms;
+  summary.num_nodes = job.nodes.size();
+  summary.num_elems = job.elems.size();
+  summary.num_bcs = all_BCs.size();
+  summary.num_forces = forces.size();
+  summary.num_ties = ties.size();
+  summary.num_eqns = equations.size();
+
+  checkPlanarNodes<Config>(job);
+  const std::vector<BC> BCs = activeBCs<Config>(all_BCs);
+  // merge coincident nodes by condensing them into the node of lowest index
+  std::vector<RigidBody> all_rigid_bodies(rigid_bodies);
+  if (options.merge_coincident_nodes) {
+    const std::vector<RigidBody> merged = createCoincidentNodeRigidBodies(
+        job.nodes, options.coincident_node_tolerance, rigid_bodies);
+    all_rigid_bodies.insert(all_rigid_bodies.end(), merged.begin(),
+                            merged.end());
+    if (options.verbose)
+      std::cout << "Merged " << merged.size()
+                << " groups of coincident nodes." << std::endl;
+  }
+
+  // [find the disconnected parts of the model and make sure none of them can
+  // move as a rigid body before factorizing anything. Streamed elements are
+  // not held in memory, so the model is solved as a single system and
+  // insufficient restraints are reported as DOFs without stiffness.
+  const std::vector<Component> components =
+      element_stream ? std::vector<Component>()
+                     : findComponents(job, BCs, forces, ties, equations,
+                                      all_rigid_bodies);
+  summary.num_components = element_stream ? 1 : components.size();
+
+  std::string unrestrained;
+  unsigned int num_unrestrained = 0;
+  for (size_t c = 0; c < components.size(); ++c) {
+    const unsigned int num_modes =
+        countUnrestrainedModes<Config>(components[c], job, BCs, equations);
+    if (num_modes > 0 && ++num_unrestrained <= 10) {
+      unrestrained.append(
+          (boost::format("\n\tComponent of %d nodes containing node %d has %d "
+                         "unrestrained rigid body modes") %
+           components[c].nodes.size() % components[c].nodes[0] % num_modes)
+              .str());
+    }
+  }
+  if (num_unrestrained > 0) {
+    throw std::runtime_error(
+        (boost::format("%d parts of the model are not sufficiently restrained "
+                       "by boundary conditions:%s%s") %
+         num_unrestrained % unrestrained %
+         (num_unrestrained > 10 ? "\n\t..." : ""))
+            .str());
+  }
+
+  if (options.verbose)
+    std::cout << "Model consists of " << summary.num_components
+              << " independent parts." << std::endl;
+  // ]
+
+  if (components.size() > 1) {
+    solveComponents<Config>(components, job, BCs, forces, ties, equations,
+                            all_rigid_bodies, options, summary);
+  } else {
+    solveSystem<Config>(job, BCs, forces, ties, equations, all_rigid_bodies,
+                        options, std::vector<NodeIndex>(), summary,
+                        element_stream);
+  }
+
   // [save files specified in options
-  CSVParser csv;
-  start_time = std::chrono::high_resolution_clock::now();
+  auto start_time = std::chrono::high_resolution_clock::now();
   if (options.save_nodal_displacements) {
     std::cout << "Writing to:" + options.nodal_displacements_filename
               << std::endl;
-    csv.write(options.nodal_displacements_filename, disp_vec,
-              options.csv_precision, options.csv_delimiter);
+    saveResults(options.nodal_displacements_filename,
+                summary.nodal_displacements, options);
   }
 
   if (options.save_nodal_forces) {
-    csv.write(options.nodal_forces_filename, nodal_forces_vec,
-              options.csv_precision, options.csv_delimiter);
+    saveResults(options.nodal_forces_filename, summary.nodal_forces, options);
   }
 
   if (options.save_tie_forces) {
-    csv.write(options.tie_forces_filename, summary.tie_forces,
-              options.csv_precision, options.csv_delimiter);
+    saveResults(options.tie_forces_filename, summary.tie_forces, options);
   }
 
-  end_time = std::chrono::high_resolution_clock::now();
+  if (options.save_elemental_forces) {
+    std::cout << "Writing to:" + options.elemental_forces_filename << std::endl;
+    saveResults(options.elemental_forces_filename, summary.element_forces,
+                options);
+  }
+
+  if (options.save_vtu) {
+    writeVTU(options.vtu_filename, job, summary, element_stream);
+  }
+
+  auto end_time = std::chrono::high_resolution_clock::now();
   summary.file_save_time_in_ms =
       std::chrono::duration_cast<std::chrono::milliseconds>(end_time -
                                                             start_time)
@@ -559,10 +1526,10 @@ Summary solve(const Job &job, const std::vector<BC> &BCs,
 
   auto final_end_time = std::chrono::high_resolution_clock::now();
 
-  delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                   final_end_time - initial_start_time)
-                   .count();
-  summary.total_time_in_ms = delta_time;
+  summary.total_time_in_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          final_end_time - initial_start_time)
+          .count();
 
   if (options.save_report) {
     writeStringToTxt(options.report_filename, summary.FullReport());
@@ -571,54 +1538,81 @@ Summary solve(const Job &job, const std::vector<BC> &BCs,
   if (options.verbose)
     std::cout << summary.FullReport();
 
-  // Compute per element forces
-  summary.element_forces.resize(job.elems.size(),
-                                std::vector<double>(2 * DOF::NUM_DOFS));
-  std::vector<LocalMatrix> perElemKlocalAelem =
-      assembleK3D.getPerElemKlocalAelem();
-
-  for (size_t elemIndex = 0; elemIndex < job.elems.size(); elemIndex++) {
-    // Assemble the displacements of the nodes of the beam
-    Eigen::Matrix<double, 12, 1> elemDisps;
-    // Displacements of the first node of the beam
-    const size_t nodeIndex0 = job.elems[elemIndex](0);
-    elemDisps(0) = summary.nodal_displacements[nodeIndex0][0];
-    elemDisps(1) = summary.nodal_displacements[nodeIndex0][1];
-    elemDisps(2) = summary.nodal_displacements[nodeIndex0][2];
-    elemDisps(3) = summary.nodal_displacements[nodeIndex0][3];
-    elemDisps(4) = summary.nodal_displacements[nodeIndex0][4];
-    elemDisps(5) = summary.nodal_displacements[nodeIndex0][5];
-    // Displacemen ts of the second node of the beam
-    const size_t nodeIndex1 = job.elems[elemIndex](1);
-    elemDisps(6) = summary.nodal_displacements[nodeIndex1][0];
-    elemDisps(7) = summary.nodal_displacements[nodeIndex1][1];
-    elemDisps(8) = summary.nodal_displacements[nodeIndex1][2];
-    elemDisps(9) = summary.nodal_displacements[nodeIndex1][3];
-    elemDisps(10) = summary.nodal_displacements[nodeIndex1][4];
-    elemDisps(11) = summary.nodal_displacements[nodeIndex1][5];
-
-    Eigen::Matrix<double, 12, 1> elemForces =
-        perElemKlocalAelem[elemIndex] * elemDisps;
-    for (int dofIndex = 0; dofIndex < DOF::NUM_DOFS; dofIndex++) {
-      summary.element_forces[elemIndex][static_cast<size_t>(dofIndex)] =
-          -elemForces(dofIndex);
-    }
-    // meaning of sign = reference to first node:
-    // + = compression for axial, - traction
-    for (int dofIndex = DOF::NUM_DOFS; dofIndex < 2 * DOF::NUM_DOFS;
-         dofIndex++) {
-      summary.element_forces[elemIndex][static_cast<size_t>(dofIndex)] =
-          +elemForces(dofIndex);
-    }
-  }
+  return summary;
+};
 
-  if (options.save_elemental_forces) {
-    std::cout << "Writing to:" + options.elemental_forces_filename << std::endl;
-    csv.write(options.elemental_forces_filename, summary.element_forces,
-              options.csv_precision, options.csv_delimiter);
+// Dispatches to the analysis selected by `options.analysis_type`.
+Summary solveModel(const Job &job, const std::vector<BC> &BCs,
+                   const std::vector<Force> &forces,
+                   const std::vector<Tie> &ties,
+                   const std::vector<Equation> &equations,
+                   const std::vector<RigidBody> &rigid_bodies,
+                   const Options &options, const Summary &load_summary,
+                   ElementStream *element_stream) {
+  switch (options.analysis_type) {
+  case FRAME_2D:
+    return solveAnalysis<Frame2D>(job, BCs, forces, ties, equations,
+                                  rigid_bodies, options, load_summary,
+                                  element_stream);
+  case TRUSS_3D:
+    return solveAnalysis<Truss3D>(job, BCs, forces, ties, equations,
+                                  rigid_bodies, options, load_summary,
+                                  element_stream);
+  case TRUSS_2D:
+    return solveAnalysis<Truss2D>(job, BCs, forces, ties, equations,
+                                  rigid_bodies, options, load_summary,
+                                  element_stream);
+  default:
+    return solveAnalysis<Frame3D>(job, BCs, forces, ties, equations,
+                                  rigid_bodies, options, load_summary,
+                                  element_stream);
   }
+}
+} // namespace
 
-  return summary;
+Summary solve(const Job &job, const std::vector<BC> &BCs,
+              const std::vector<Force> &forces, const std::vector<Tie> &ties,
+              const std::vector<Equation> &equations, const Options &options) {
+  return solve(job, BCs, forces, ties, equations, std::vector<RigidBody>(),
+               options);
 };
 
+Summary solve(const Job &job, const std::vector<BC> &BCs,
+              const std::vector<Force> &forces, const std::vector<Tie> &ties,
+              const std::vector<Equation> &equations,
+              const std::vector<RigidBody> &rigid_bodies,
+              const Options &options) {
+  return solveModel(job, BCs, forces, ties, equations, rigid_bodies, options,
+                    Summary(), nullptr);
+};
+
+Summary solve(const Model &model, const Options &options,
+              const Summary &load_summary) {
+  return solveModel(model.job, model.bcs, model.forces, model.ties,
+                    model.equations, model.rigid_bodies, options,
+                    load_summary, model.element_stream.get());
+};
+
+#define FEA_INSTANTIATE_ANALYSIS(Config)                                       \
+  template class DofMap<Config>;                                               \
+  template class BasicGlobalStiffAssembler<Config>;                            \
+  template void loadBCs<Config>(std::vector<Triplet> &, ForceVector &,         \
+                                const std::vector<BC> &,                       \
+                                const DofMap<Config> &);                       \
+  template void loadEquations<Config>(std::vector<Triplet> &,                  \
+                                      const std::vector<Equation> &,           \
+                                      const DofMap<Config> &, size_t);         \
+  template void loadTies<Config>(std::vector<Triplet> &,                       \
+                                 const std::vector<Tie> &,                     \
+                                 const DofMap<Config> &);                      \
+  template void loadForces<Config>(ForceVector &, const std::vector<Force> &,  \
+                                   const DofMap<Config> &);
+
+FEA_INSTANTIATE_ANALYSIS(Frame3D)
+FEA_INSTANTIATE_ANALYSIS(Frame2D)
+FEA_INSTANTIATE_ANALYSIS(Truss3D)
+FEA_INSTANTIATE_ANALYSIS(Truss2D)
+
+#undef FEA_INSTANTIATE_ANALYSIS
+
 } // namespace fea
@@ -0,0 +1,268 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <boost/format.hpp>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "vtu_writer.h"
+
+namespace fea {
+
+    namespace {
+        const unsigned char VTK_LINE = 3;
+
+        /**
+         * An array of the appended data section.
+         */
+        struct VTUArray {
+            VTUArray(const std::string &_name, const std::string &_type, unsigned int _num_components,
+                     std::uint64_t _num_bytes)
+                    : name(_name), type(_type), num_components(_num_components), num_bytes(_num_bytes) { };
+
+            std::string name;
+            std::string type;
+            unsigned int num_components;
+            std::uint64_t num_bytes;
+        };
+
+        /**
+         * Buffers binary output and writes it to the file in chunks of about 1MB.
+         */
+        class ChunkedWriter {
+        public:
+            explicit ChunkedWriter(std::ofstream &_output_file)
+                    : output_file(_output_file), buffer(1 << 20), pos(0) { }
+
+            ~ChunkedWriter() { flush(); }
+
+            template<typename T>
+            void append(const T &value) {
+                if (pos + sizeof(T) > buffer.size()) {
+                    flush();
+                }
+                std::memcpy(&buffer[pos], &value, sizeof(T));
+                pos += sizeof(T);
+            }
+
+            /**
+             * Appends `count` values of `data`, writing them directly once the buffer has been flushed.
+             */
+            void append(const double *data, size_t count) {
+                flush();
+                output_file.write(reinterpret_cast<const char *>(data), count * sizeof(double));
+            }
+
+            void flush() {
+                output_file.write(buffer.data(), pos);
+                pos = 0;
+            }
+
+        private:
+            std::ofstream &output_file;
+            std::vector<char> buffer;
+            size_t pos; /**<Number of bytes in `buffer`.*/
+        };
+
+        /**
+         * Returns `true` if `data` holds `num_rows` rows.
+         */
+        template<typename Results>
+        bool hasRows(const Results &data, size_t num_rows) {
+            return num_rows > 0 && static_cast<size_t>(data.rows()) == num_rows;
+        }
+
+        /**
+         * Appends the byte count of an array followed by columns `[first_col, first_col + 3)` of each row.
+         */
+        void appendVectors(ChunkedWriter &writer, const NodalResults &data, size_t first_col) {
+            writer.append(static_cast<std::uint64_t>(3 * sizeof(double) * data.rows()));
+            for (Eigen::Index i = 0; i < data.rows(); ++i) {
+                writer.append(data(i, first_col));
+                writer.append(data(i, first_col + 1));
+                writer.append(data(i, first_col + 2));
+            }
+        }
+    }
+
+    void writeVTU(const std::string &filename, const Job &job, const Summary &summary,
+                  ElementStream *element_stream) {
+        const std::uint32_t one = 1;
+        if (*reinterpret_cast<const unsigned char *>(&one) != 1) {
+            throw std::runtime_error("VTU files are written little-endian and cannot be written on this platform.");
+        }
+
+        const std::uint64_t num_points = job.nodes.size();
+        const std::uint64_t num_cells = element_stream ? summary.num_elems : job.elems.size();
+        const bool has_displacements = hasRows(summary.nodal_displacements, num_points);
+        const bool has_forces = hasRows(summary.nodal_forces, num_points);
+        const bool has_element_forces = hasRows(summary.element_forces, num_cells);
+
+        // [describe the arrays in the order they are appended
+        std::vector<VTUArray> point_arrays;
+        if (has_displacements) {
+            point_arrays.push_back(VTUArray("displacement", "Float64", 3, 24 * num_points));
+            point_arrays.push_back(VTUArray("rotation", "Float64", 3, 24 * num_points));
+        }
+        if (has_forces) {
+            point_arrays.push_back(VTUArray("force", "Float64", 3, 24 * num_points));
+            point_arrays.push_back(VTUArray("moment", "Float64", 3, 24 * num_points));
+        }
+        std::vector<VTUArray> cell_arrays;
+        if (has_element_forces) {
+            cell_arrays.push_back(VTUArray("element_forces", "Float64", 2 * DOF::NUM_DOFS, 96 * num_cells));
+        }
+        const VTUArray points("Points", "Float64", 3, 24 * num_points);
+        const std::vector<VTUArray> cells = {VTUArray("connectivity", "Int64", 1, 16 * num_cells),
+                                             VTUArray("offsets", "Int64", 1, 8 * num_cells),
+                                             VTUArray("types", "UInt8", 1, num_cells)};
+        // ]
+
+        std::ofstream output_file(filename.c_str(), std::ios::binary);
+        if (!output_file.is_open()) {
+            throw std::runtime_error(
+                    (boost::format("Error opening file %s") % filename).str()
+            );
+        }
+
+        // [write the XML header with the offset of each array into the appended data
+        std::uint64_t offset = 0;
+        std::string header;
+        auto addDataArray = [&header, &offset](const VTUArray &array, bool named) {
+            header += (boost::format("        <DataArray type=\"%s\"%s NumberOfComponents=\"%d\" "
+                                             "format=\"appended\" offset=\"%d\"/>\n") % array.type %
+                       (named ? " Name=\"" + array.name + "\"" : std::string()) % array.num_components %
+                       offset).str();
+            offset += sizeof(std::uint64_t) + array.num_bytes;
+        };
+        header += "<?xml version=\"1.0\"?>\n"
+                "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" "
+                "header_type=\"UInt64\">\n"
+                "  <UnstructuredGrid>\n";
+        header += (boost::format("    <Piece NumberOfPoints=\"%d\" NumberOfCells=\"%d\">\n") % num_points %
+                   num_cells).str();
+        header += has_displacements ? "      <PointData Vectors=\"displacement\">\n" : "      <PointData>\n";
+        for (size_t i = 0; i < point_arrays.size(); ++i) {
+            addDataArray(point_arrays[i], true);
+        }
+        header += "      </PointData>\n"
+                "      <CellData>\n";
+        for (size_t i = 0; i < cell_arrays.size(); ++i) {
+            addDataArray(cell_arrays[i], true);
+        }
+        header += "      </CellData>\n"
+                "      <Points>\n";
+        addDataArray(points, false);
+        header += "      </Points>\n"
+                "      <Cells>\n";
+        for (size_t i = 0; i < cells.size(); ++i) {
+            addDataArray(cells[i], true);
+        }
+        header += "      </Cells>\n"
+                "    </Piece>\n"
+                "  </UnstructuredGrid>\n"
+                "  <AppendedData encoding=\"raw\">\n"
+                "   _";
+        output_file.write(header.data(), header.size());
+        // ]
+
+        {
+            ChunkedWriter writer(output_file);
+            if (has_displacements) {
+                appendVectors(writer, summary.nodal_displacements, 0);
+                appendVectors(writer, summary.nodal_displacements, 3);
+            }
+            if (has_forces) {
+                appendVectors(writer, summary.nodal_forces, 0);
+                appendVectors(writer, summary.nodal_forces, 3);
+            }
+            if (has_element_forces) {
+                writer.append(cell_arrays[0].num_bytes);
+                // the rows of the element forces are already laid out as VTK expects
+                writer.append(summary.element_forces.data(), 2 * DOF::NUM_DOFS * num_cells);
+            }
+
+            writer.append(points.num_bytes);
+            for (size_t i = 0; i < num_points; ++i) {
+                writer.append(job.nodes[i](0));
+                writer.append(job.nodes[i](1));
+                writer.append(job.nodes[i](2));
+            }
+
+            writer.append(cells[0].num_bytes);
+            if (element_stream) {
+                ElementChunk chunk;
+                std::uint64_t num_read = 0;
+                element_stream->rewind();
+                while (element_stream->next(chunk)) {
+                    num_read += chunk.elems.size();
+                    if (num_read > num_cells) {
+                        break;
+                    }
+                    for (size_t i = 0; i < chunk.elems.size(); ++i) {
+                        writer.append(static_cast<std::int64_t>(chunk.elems[i][0]));
+                        writer.append(static_cast<std::int64_t>(chunk.elems[i][1]));
+                    }
+                }
+                if (num_read != num_cells) {
+                    throw std::runtime_error(
+                            (boost::format("Cannot write %s because the element stream does not hold the %d "
+                                                   "elements of the analysis.") % filename % num_cells).str()
+                    );
+                }
+            }
+            else {
+                for (size_t i = 0; i < num_cells; ++i) {
+                    writer.append(static_cast<std::int64_t>(job.elems[i][0]));
+                    writer.append(static_cast<std::int64_t>(job.elems[i][1]));
+                }
+            }
+
+            writer.append(cells[1].num_bytes);
+            for (std::uint64_t i = 0; i < num_cells; ++i) {
+                writer.append(static_cast<std::int64_t>(2 * (i + 1)));
+            }
+
+            writer.append(cells[2].num_bytes);
+            for (std::uint64_t i = 0; i < num_cells; ++i) {
+                writer.append(VTK_LINE);
+            }
+        }
+
+        const std::string footer = "\n  </AppendedData>\n</VTKFile>\n";
+        output_file.write(footer.data(), footer.size());
+        output_file.close();
+
+        if (!output_file) {
+            throw std::runtime_error(
+                    (boost::format("Error writing file %s") % filename).str()
+            );
+        }
+    }
+
+} // namespace fea
@@ -212,6 +212,50 @@ TEST_F(beamFEATest, AssemblesGlobalStiffness) {
   }
 }
 
+// The Lagrange border of boundary conditions and equations is assembled
+// together with the stiffness of the elements.
+TEST_F(beamFEATest, AssemblesBorderOfBCsAndEquations) {
+  const DofMap<Frame3D> dof_map(JOB_CANTILEVER.nodes.size());
+  std::vector<BC> bcs = {BC(0, DOF::DISPLACEMENT_X, 0.0),
+                         BC(1, DOF::ROTATION_Z, 0.5)};
+  std::vector<Equation> equations = {
+      Equation({Equation::Term(1, DOF::DISPLACEMENT_Y, 2.0),
+                Equation::Term(1, DOF::DISPLACEMENT_Y, 1.0),
+                Equation::Term(0, DOF::DISPLACEMENT_Z, -1.0)})};
+  std::vector<Tie> ties;
+
+  const size_t num_dofs = dof_map.getNumDofs();
+  const size_t size = num_dofs + bcs.size() + equations.size();
+  SparseMat Kg(size, size);
+  SparseMat KgNoBC(num_dofs, num_dofs);
+  ForceVector force_vec = ForceVector::Zero(size);
+
+  assembleK3D(Kg, force_vec, JOB_CANTILEVER, ties, bcs, equations, dof_map);
+  assembleK3D(KgNoBC, JOB_CANTILEVER, ties);
+  EXPECT_TRUE(Kg.isCompressed());
+
+  GlobalStiffMatrix KgDense(Kg);
+  GlobalStiffMatrix KgNoBCDense(KgNoBC);
+  for (size_t i = 0; i < num_dofs; ++i) {
+    for (size_t j = 0; j < num_dofs; ++j) {
+      EXPECT_DOUBLE_EQ(KgNoBCDense(i, j), KgDense(i, j));
+    }
+  }
+
+  GlobalStiffMatrix expected_border = GlobalStiffMatrix::Zero(num_dofs, 3);
+  expected_border(0, 0) = 1.0;
+  expected_border(11, 1) = 1.0;
+  expected_border(7, 2) = 3.0;
+  expected_border(2, 2) = -1.0;
+  for (size_t i = 0; i < num_dofs; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      EXPECT_DOUBLE_EQ(expected_border(i, j), KgDense(i, num_dofs + j));
+      EXPECT_DOUBLE_EQ(expected_border(i, j), KgDense(num_dofs + j, i));
+    }
+  }
+  EXPECT_DOUBLE_EQ(0.5, force_vec(num_dofs + 1));
+}
+
 TEST_F(beamFEATest, CorrectNodalDisplacementsNoTies) {
   std::vector<Tie> ties;
   std::vector<Equation> equations;
@@ -228,9 +272,9 @@ TEST_F(beamFEATest, CorrectNodalDisplacementsNoTies) {
       {0., 0.5, 0., -0.4375, 0., 0.125},
       {0., 0.625, 0., -0.625, 0., 1.25, -0.625}};
 
-  for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-    for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j) {
-      EXPECT_NEAR(expected[i][j], summary.nodal_displacements[i][j], 1.e-10);
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_NEAR(expected[i][j], summary.nodal_displacements(i, j), 1.e-10);
     }
   }
 }
@@ -281,13 +325,224 @@ TEST_F(beamFEATest, CorrectNodalDisplacementsWithStiffTies) {
       {0., 0.5, 0., -0.4375, 0., 0.125},
       {0., 0.625, 0., -0.625, 0., 1.25, -0.625}};
 
-  for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-    for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j) {
-      EXPECT_NEAR(expected[i][j], summary.nodal_displacements[i][j], 1.e-7);
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_NEAR(expected[i][j], summary.nodal_displacements(i, j), 1.e-7);
+    }
+  }
+}
+
+// Rigidly linking the coincident nodes of the tied L-bracket must reproduce
+// the L-bracket without the redundant node, without any penalty stiffness.
+TEST_F(beamFEATest, CorrectNodalDisplacementsWithRigidLink) {
+  std::vector<double> normal_vec = {0.0, 1.0, 0.0};
+  Props props1(10.0, 10.0, 10.0, 10.0, normal_vec);
+  Props props2(10.0, 1.0, 1.0, 10.0, normal_vec);
+
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(1.0, 0.0, 0.0), Node(2.0, 0.0, 0.0),
+                             Node(2.0, 0.0, 1.0)};
+  std::vector<Elem> elems = {Elem(0, 1, props1), Elem(2, 3, props1),
+                             Elem(3, 4, props2)};
+
+  Job job_link(nodes, elems);
+
+  std::vector<BC> bcs = {BC(0, 0, 0.0), BC(0, 1, 0.0), BC(0, 2, 0.0),
+                         BC(0, 3, 0.0), BC(0, 4, 0.0), BC(0, 5, 0.0),
+                         BC(4, 1, 0.5)};
+  std::vector<RigidBody> rigid_bodies = {RigidBody(1, 2)};
+  std::vector<Tie> ties;
+  std::vector<Force> forces;
+  std::vector<Equation> equations;
+
+  Summary summary = solve(job_link, bcs, forces, ties, equations,
+                          rigid_bodies, Options());
+  Summary expected = solve(JOB_L_BRACKET, BCS_L_BRACKET, forces, ties,
+                           equations, Options());
+
+  const std::vector<size_t> expected_node = {0, 1, 1, 2, 3};
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_NEAR(expected.nodal_displacements(expected_node[i], j),
+                  summary.nodal_displacements(i, j), 1.e-12);
+    }
+  }
+}
+
+// A load on the free end of a rigid arm attached to the cantilever tip acts on
+// the tip as the same load plus the moment M = F * offset. The end of the arm
+// follows the rotation of the tip.
+TEST_F(beamFEATest, CorrectDisplacementRigidArmCantileverBeam) {
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(2.0, 0.0, 0.0)};
+  std::vector<Elem> elems = {
+      Elem(0, 1, Props(1.0, 1.0, 1.0, 1.0, {0.0, 0.0, 1.0}))};
+  Job job(nodes, elems);
+
+  std::vector<Force> forces = {Force(2, DOF::DISPLACEMENT_Y, 0.1)};
+  std::vector<RigidBody> rigid_bodies = {RigidBody(1, {2})};
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+
+  Summary summary = solve(job, BCS_CANTILEVER, forces, ties, equations,
+                          rigid_bodies, Options());
+
+  // v = PL^3/3EI + ML^2/2EI, theta = PL^2/2EI + ML/EI with P = M = 0.1
+  const double tip_disp = 0.1 / 3.0 + 0.1 / 2.0;
+  const double tip_rot = 0.1 / 2.0 + 0.1;
+  EXPECT_NEAR(tip_disp, summary.nodal_displacements(1, 1), 1e-12);
+  EXPECT_NEAR(tip_rot, summary.nodal_displacements(1, 5), 1e-12);
+  EXPECT_NEAR(tip_disp + tip_rot, summary.nodal_displacements(2, 1), 1e-12);
+  EXPECT_NEAR(tip_rot, summary.nodal_displacements(2, 5), 1e-12);
+
+  // the load and its moment are reported on the master node
+  EXPECT_NEAR(0.1, summary.nodal_forces(1, 1), 1e-12);
+  EXPECT_NEAR(0.1, summary.nodal_forces(1, 5), 1e-12);
+  EXPECT_DOUBLE_EQ(0.0, summary.nodal_forces(2, 1));
+}
+
+// Boundary conditions on the slave of a rigid arm that follow from the ones on
+// its master, through the lever arm or directly for rotations, are applied
+// once instead of making the system singular.
+TEST_F(beamFEATest, DropsRedundantBCsOnRigidBody) {
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(2.0, 0.0, 0.0)};
+  std::vector<Elem> elems = {
+      Elem(0, 1, Props(1.0, 1.0, 1.0, 1.0, {0.0, 0.0, 1.0}))};
+  Job job(nodes, elems);
+
+  std::vector<Force> forces = {Force(2, DOF::DISPLACEMENT_Z, 0.1)};
+  std::vector<RigidBody> rigid_bodies = {RigidBody(1, {2})};
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+
+  std::vector<BC> master_bcs = BCS_CANTILEVER;
+  master_bcs.push_back(BC(1, DOF::DISPLACEMENT_Y, 0.0));
+  master_bcs.push_back(BC(1, DOF::ROTATION_Z, 0.0));
+  Summary expected = solve(job, master_bcs, forces, ties, equations,
+                           rigid_bodies, Options());
+
+  std::vector<BC> bcs = master_bcs;
+  bcs.push_back(BC(2, DOF::DISPLACEMENT_Y, 0.0));
+  bcs.push_back(BC(2, DOF::ROTATION_Z, 0.0));
+  bcs.push_back(BC(1, DOF::ROTATION_Z, 0.0));
+  Summary summary =
+      solve(job, bcs, forces, ties, equations, rigid_bodies, Options());
+
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_NEAR(expected.nodal_displacements(i, j),
+                  summary.nodal_displacements(i, j), 1e-12);
+    }
+  }
+
+  // v2 = v1 + theta_z1 * 1 is already zero
+  bcs = master_bcs;
+  bcs.push_back(BC(2, DOF::DISPLACEMENT_Y, 0.1));
+  EXPECT_THROW(
+      solve(job, bcs, forces, ties, equations, rigid_bodies, Options()),
+      std::runtime_error);
+}
+
+TEST_F(beamFEATest, RejectsNodeInSeveralRigidBodies) {
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(2.0, 0.0, 0.0)};
+  std::vector<Elem> elems = {
+      Elem(0, 1, Props(1.0, 1.0, 1.0, 1.0, {0.0, 0.0, 1.0}))};
+  Job job(nodes, elems);
+
+  std::vector<RigidBody> rigid_bodies = {RigidBody(0, 2), RigidBody(1, 2)};
+  EXPECT_THROW(DofMap<Frame3D>(job, rigid_bodies), std::runtime_error);
+
+  rigid_bodies = {RigidBody(0, 1), RigidBody(1, 2)};
+  EXPECT_THROW(DofMap<Frame3D>(job, rigid_bodies), std::runtime_error);
+
+  rigid_bodies = {RigidBody(1, {0, 2})};
+  EXPECT_EQ(6u, DofMap<Frame3D>(job, rigid_bodies).getNumDofs());
+}
+
+// Merging the coincident nodes of the tied L-bracket must reproduce the
+// L-bracket without the redundant node.
+TEST_F(beamFEATest, CorrectNodalDisplacementsMergedCoincidentNodes) {
+  std::vector<double> normal_vec = {0.0, 1.0, 0.0};
+  Props props1(10.0, 10.0, 10.0, 10.0, normal_vec);
+  Props props2(10.0, 1.0, 1.0, 10.0, normal_vec);
+
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(1.0, 1e-12, 0.0), Node(2.0, 0.0, 0.0),
+                             Node(2.0, 0.0, 1.0)};
+  std::vector<Elem> elems = {Elem(0, 1, props1), Elem(2, 3, props1),
+                             Elem(3, 4, props2)};
+
+  Job job_merged(nodes, elems);
+
+  std::vector<BC> bcs = {BC(0, 0, 0.0), BC(0, 1, 0.0), BC(0, 2, 0.0),
+                         BC(0, 3, 0.0), BC(0, 4, 0.0), BC(0, 5, 0.0),
+                         BC(4, 1, 0.5)};
+  std::vector<Tie> ties;
+  std::vector<Force> forces;
+  std::vector<Equation> equations;
+
+  Options opts;
+  opts.merge_coincident_nodes = true;
+  Summary summary = solve(job_merged, bcs, forces, ties, equations, opts);
+  Summary expected = solve(JOB_L_BRACKET, BCS_L_BRACKET, forces, ties,
+                           equations, Options());
+
+  const std::vector<size_t> expected_node = {0, 1, 1, 2, 3};
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_NEAR(expected.nodal_displacements(expected_node[i], j),
+                  summary.nodal_displacements(i, j), 1.e-10);
     }
   }
 }
 
+// Boundary conditions on the same DOF of two merged coincident nodes constrain
+// the same unknown and are applied once.
+TEST_F(beamFEATest, MergedCoincidentNodesWithRepeatedBCs) {
+  std::vector<double> normal_vec = {0.0, 1.0, 0.0};
+  Props props1(10.0, 10.0, 10.0, 10.0, normal_vec);
+  Props props2(10.0, 1.0, 1.0, 10.0, normal_vec);
+
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(1.0, 1e-12, 0.0), Node(2.0, 0.0, 0.0),
+                             Node(2.0, 0.0, 1.0)};
+  std::vector<Elem> elems = {Elem(0, 1, props1), Elem(2, 3, props1),
+                             Elem(3, 4, props2)};
+
+  Job job_merged(nodes, elems);
+
+  std::vector<BC> bcs = {BC(0, 0, 0.0), BC(0, 1, 0.0), BC(0, 2, 0.0),
+                         BC(0, 3, 0.0), BC(0, 4, 0.0), BC(0, 5, 0.0),
+                         BC(4, 1, 0.5), BC(1, 2, 0.0), BC(2, 2, 0.0)};
+  std::vector<Tie> ties;
+  std::vector<Force> forces;
+  std::vector<Equation> equations;
+
+  Options opts;
+  opts.merge_coincident_nodes = true;
+  Summary summary = solve(job_merged, bcs, forces, ties, equations, opts);
+
+  std::vector<BC> expected_bcs = BCS_L_BRACKET;
+  expected_bcs.push_back(BC(1, 2, 0.0));
+  Summary expected = solve(JOB_L_BRACKET, expected_bcs, forces, ties,
+                           equations, Options());
+
+  const std::vector<size_t> expected_node = {0, 1, 1, 2, 3};
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_NEAR(expected.nodal_displacements(expected_node[i], j),
+                  summary.nodal_displacements(i, j), 1.e-10);
+    }
+  }
+
+  // the merged nodes cannot be held at different positions
+  bcs.back().value = 0.1;
+  EXPECT_THROW(solve(job_merged, bcs, forces, ties, equations, opts),
+               std::runtime_error);
+}
+
 TEST_F(beamFEATest, CorrectDisplacementWithEquationsCantileverBeam) {
   std::vector<BC> bcs = {BC(0, 0, 0.1), BC(0, 1, 0.0), BC(0, 2, 0.0),
                          BC(0, 3, 0.0), BC(0, 4, 0.0), BC(0, 5, 0.0)};
@@ -306,9 +561,9 @@ TEST_F(beamFEATest, CorrectDisplacementWithEquationsCantileverBeam) {
   std::vector<std::vector<double>> expected = {{0.1, 0., 0., 0., 0., 0.},
                                                {-0.1, 0., 0., 0., 0., 0.}};
 
-  for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-    for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j)
-      EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements[i][j]);
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j)
+      EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements(i, j));
   }
 }
 
@@ -329,12 +584,33 @@ TEST_F(beamFEATest, CorrectTipDisplacementCantileverBeam) {
   std::vector<std::vector<double>> expected = {
       {0., 0., 0., 0., 0., 0.}, {0., 0.033333333333333333, 0., 0., 0., 0.05}};
 
-  for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-    for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j)
-      EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements[i][j]);
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j)
+      EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements(i, j));
   }
 }
 
+// Many forces on the same DOFs, in any order, add up to the load of the
+// single force cantilever.
+TEST_F(beamFEATest, SumsDuplicateForcesCantileverBeam) {
+
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  std::vector<Force> forces;
+  for (int i = 0; i < 1000; ++i) {
+    forces.push_back(Force(1, DOF::DISPLACEMENT_Y, 0.0002));
+    forces.push_back(Force(0, DOF::DISPLACEMENT_X, 1.0));
+    forces.push_back(Force(1, DOF::DISPLACEMENT_Y, -0.0001));
+  }
+
+  Summary summary =
+      solve(JOB_CANTILEVER, BCS_CANTILEVER, forces, ties, equations, Options());
+
+  EXPECT_NEAR(0.033333333333333333, summary.nodal_displacements(1, 1), 1e-12);
+  EXPECT_NEAR(0.05, summary.nodal_displacements(1, 5), 1e-12);
+  EXPECT_NEAR(0.1, summary.nodal_forces(1, 1), 1e-12);
+}
+
 // This test displaces a cantilever beam axially and
 // transverse to the beam axis. Nodal forces are
 // compared to the analytical result.
@@ -354,9 +630,9 @@ TEST_F(beamFEATest, CorrectTipForcesCantileverBeam) {
   std::vector<std::vector<double>> expected = {{-0.1, -0.3, 0., 0., 0., -0.3},
                                                {0.1, 0.3, 0., 0., 0., 0.}};
 
-  for (size_t i = 0; i < summary.nodal_forces.size(); ++i) {
-    for (size_t j = 0; j < summary.nodal_forces[i].size(); ++j)
-      EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_forces[i][j]);
+  for (size_t i = 0; i < summary.nodal_forces.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_forces.cols(); ++j)
+      EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_forces(i, j));
   }
 }
 
@@ -402,9 +678,9 @@ TEST_F(beamFEATest, CorrectDisplacementWeakTies) {
                                                {0.5, 0.0, 0.0, 0.0, 0.0, 0.0},
                                                {0.5, 0.0, 0.0, 0.0, 0.0, 0.0}};
 
-  for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-    for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j) {
-      EXPECT_NEAR(expected[i][j], summary.nodal_displacements[i][j], 1e-10);
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_NEAR(expected[i][j], summary.nodal_displacements(i, j), 1e-10);
     }
   }
 }
@@ -446,9 +722,445 @@ TEST_F(beamFEATest, CorrectForcesWeakTies) {
   std::vector<std::vector<double>> expected = {
       {0.005, 0.0, 0.0, 0.005, 0.0, 0.0}};
 
-  for (size_t i = 0; i < summary.tie_forces.size(); ++i) {
-    for (size_t j = 0; j < summary.tie_forces[i].size(); ++j) {
-      EXPECT_NEAR(expected[i][j], summary.tie_forces[i][j], 1e-13);
+  for (size_t i = 0; i < summary.tie_forces.rows(); ++i) {
+    for (size_t j = 0; j < summary.tie_forces.cols(); ++j) {
+      EXPECT_NEAR(expected[i][j], summary.tie_forces(i, j), 1e-13);
+    }
+  }
+}
+
+// A straight line of equally spaced nodes forms elements that differ only by
+// their position, so the cache should compute a single elemental matrix and
+// assemble the same global stiffness matrix as the uncached assembler.
+TEST_F(beamFEATest, CachedElementMatricesMatchUncached) {
+  std::vector<double> normal_vec = {0.0, 1.0, 0.0};
+  Props props(10.0, 10.0, 10.0, 10.0, normal_vec);
+
+  std::vector<Node> nodes;
+  std::vector<Elem> elems;
+  for (unsigned int i = 0; i < 5; ++i) {
+    nodes.push_back(Node(0.5 * i, 0.0, 0.0));
+    if (i > 0) {
+      elems.push_back(Elem(i - 1, i, props));
+    }
+  }
+  Job job(nodes, elems);
+  std::vector<Tie> ties;
+
+  const size_t size = DOF::NUM_DOFS * nodes.size();
+  SparseMat Kg(size, size);
+  SparseMat KgCached(size, size);
+
+  assembleK3D(Kg, job, ties);
+  GlobalStiffAssembler cachedAssembler(true, 1e-12);
+  cachedAssembler(KgCached, job, ties);
+
+  EXPECT_EQ(elems.size(), assembleK3D.getNumUniqueElemMatrices());
+  EXPECT_EQ(1, cachedAssembler.getNumUniqueElemMatrices());
+
+  GlobalStiffMatrix KgDense(Kg);
+  GlobalStiffMatrix KgCachedDense(KgCached);
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      EXPECT_NEAR(KgDense(i, j), KgCachedDense(i, j), 1e-9);
+    }
+  }
+
+  for (size_t i = 0; i < elems.size(); ++i) {
+    const LocalMatrix &expected = assembleK3D.getKlocalAelem(i);
+    const LocalMatrix &cached = cachedAssembler.getKlocalAelem(i);
+    for (size_t j = 0; j < expected.size(); ++j) {
+      EXPECT_NEAR(expected(j), cached(j), 1e-9);
+    }
+  }
+}
+
+TEST_F(beamFEATest, CachedElementMatricesSolveLBracket) {
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  Options opts;
+  opts.cache_element_matrices = true;
+
+  Summary expected = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET,
+                           ties, equations, Options());
+  Summary summary = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET, ties,
+                          equations, opts);
+
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_DOUBLE_EQ(expected.nodal_displacements(i, j),
+                       summary.nodal_displacements(i, j));
+    }
+  }
+  for (size_t i = 0; i < summary.element_forces.rows(); ++i) {
+    for (size_t j = 0; j < summary.element_forces.cols(); ++j) {
+      EXPECT_DOUBLE_EQ(expected.element_forces(i, j),
+                       summary.element_forces(i, j));
+    }
+  }
+}
+
+// Element forces are recovered in batches. A long cantilever spans several
+// batches, and every element carries the same shear and a linearly varying
+// moment whether or not its force operator is shared with other elements.
+TEST_F(beamFEATest, RecoversElementForcesAcrossBatches) {
+  const unsigned int num_elems = 300;
+  const double length = 1.0;
+  const double tip_force = -2.0;
+  Props props(1.e6, 1.e6, 1.e6, 1.e6, {0.0, 0.0, 1.0});
+
+  std::vector<Node> nodes;
+  std::vector<Elem> elems;
+  for (unsigned int i = 0; i <= num_elems; ++i) {
+    nodes.push_back(Node(length * i, 0.0, 0.0));
+    if (i > 0) {
+      elems.push_back(Elem(i - 1, i, props));
     }
   }
+  Job job(nodes, elems);
+  std::vector<BC> bcs;
+  for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+    bcs.push_back(BC(0, j, 0.0));
+  }
+  std::vector<Force> forces = {Force(num_elems, DOF::DISPLACEMENT_Y, tip_force)};
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  Options cached;
+  cached.cache_element_matrices = true;
+
+  Summary summary = solve(job, bcs, forces, ties, equations, Options());
+  Summary summary_cached = solve(job, bcs, forces, ties, equations, cached);
+
+  ASSERT_EQ(num_elems, summary.element_forces.rows());
+  for (size_t i = 0; i < num_elems; ++i) {
+    // shear along and moment about the local axes at the far end of element i
+    const double moment = tip_force * length * (num_elems - i - 1);
+    EXPECT_NEAR(-tip_force, summary.element_forces(i, 8), 1e-3);
+    EXPECT_NEAR(moment, summary.element_forces(i, 10), 1e-3);
+    for (size_t j = 0; j < summary.element_forces.cols(); ++j) {
+      EXPECT_NEAR(summary.element_forces(i, j),
+                  summary_cached.element_forces(i, j), 1e-3);
+    }
+  }
+}
+
+// Results are stored as one contiguous row-major array, and the nested form is
+// only produced on request.
+TEST_F(beamFEATest, StoresResultsContiguously) {
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  Summary summary = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET,
+                          ties, equations, Options());
+
+  ASSERT_EQ(JOB_L_BRACKET.nodes.size(), summary.nodal_displacements.rows());
+  ASSERT_EQ(JOB_L_BRACKET.elems.size(), summary.element_forces.rows());
+  EXPECT_EQ(&summary.nodal_displacements(0, 0) + DOF::NUM_DOFS,
+            &summary.nodal_displacements(1, 0));
+  EXPECT_EQ(&summary.element_forces(0, 0) + 2 * DOF::NUM_DOFS,
+            &summary.element_forces(1, 0));
+
+  const std::vector<std::vector<double>> nested =
+      toNestedVectors(summary.nodal_displacements);
+  ASSERT_EQ(JOB_L_BRACKET.nodes.size(), nested.size());
+  for (size_t i = 0; i < nested.size(); ++i) {
+    ASSERT_EQ(DOF::NUM_DOFS, nested[i].size());
+    for (size_t j = 0; j < nested[i].size(); ++j) {
+      EXPECT_EQ(summary.nodal_displacements(i, j), nested[i][j]);
+    }
+  }
+}
+
+// Forces that are neither requested nor saved are skipped without changing the
+// nodal displacements.
+TEST_F(beamFEATest, SkipsUnrequestedResults) {
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  Options options;
+  options.compute_nodal_forces = false;
+  options.compute_tie_forces = false;
+  options.compute_element_forces = false;
+  Summary expected = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET,
+                           ties, equations, Options());
+  Summary summary = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET, ties,
+                          equations, options);
+
+  EXPECT_EQ(0, summary.nodal_forces.rows());
+  EXPECT_EQ(0, summary.tie_forces.rows());
+  EXPECT_EQ(0, summary.element_forces.rows());
+  EXPECT_EQ(JOB_L_BRACKET.elems.size(), summary.num_elems);
+  ASSERT_EQ(expected.nodal_displacements.rows(),
+            summary.nodal_displacements.rows());
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+      EXPECT_NEAR(expected.nodal_displacements(i, j),
+                  summary.nodal_displacements(i, j), 1e-12);
+    }
+  }
+  EXPECT_EQ(std::string::npos, summary.FullReport().find("Nodal Forces"));
+  EXPECT_NE(std::string::npos,
+            summary.FullReport().find("Nodal displacements"));
+
+  // saving a result computes it even if it was not requested
+  options.save_nodal_forces = true;
+  options.nodal_forces_filename = "skipped_nodal_forces.csv";
+  summary = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET, ties,
+                  equations, options);
+  EXPECT_EQ(expected.nodal_forces.rows(), summary.nodal_forces.rows());
+  EXPECT_EQ(0, summary.element_forces.rows());
+  std::remove(options.nodal_forces_filename.c_str());
+}
+
+TEST_F(beamFEATest, SectionTableMatchesPerElementProps) {
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+
+  std::vector<Props> sections = {JOB_L_BRACKET.props[0],
+                                 JOB_L_BRACKET.props[2]};
+  std::vector<unsigned int> section_ids = {0, 0, 1};
+  Job job(JOB_L_BRACKET.nodes, JOB_L_BRACKET.elems, sections, section_ids);
+
+  Summary expected = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET,
+                           ties, equations, Options());
+  Summary summary =
+      solve(job, BCS_L_BRACKET, FORCES_L_BRACKET, ties, equations, Options());
+
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+      EXPECT_DOUBLE_EQ(expected.nodal_displacements(i, j),
+                       summary.nodal_displacements(i, j));
+    }
+  }
+}
+
+// The cantilever lies in the x-y plane and is loaded in the y-direction, so
+// the planar frame must reproduce the analytical tip displacement and
+// rotation. BCs on the out-of-plane DOFs hold them at zero and are dropped.
+TEST_F(beamFEATest, CorrectTipDisplacementPlanarFrame) {
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  Options opts;
+  opts.analysis_type = FRAME_2D;
+
+  Summary summary = solve(JOB_CANTILEVER, BCS_CANTILEVER, FORCES_CANTILEVER,
+                          ties, equations, opts);
+
+  std::vector<std::vector<double>> expected = {
+      {0., 0., 0., 0., 0., 0.}, {0., 0.033333333333333333, 0., 0., 0., 0.05}};
+
+  for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+    for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j)
+      EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements(i, j));
+  }
+}
+
+TEST_F(beamFEATest, PlanarFrameRejectsOutOfPlaneLoads) {
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  std::vector<Force> forces = {Force(1, DOF::DISPLACEMENT_Z, 0.1)};
+  Options opts;
+  opts.analysis_type = FRAME_2D;
+
+  EXPECT_THROW(solve(JOB_CANTILEVER, BCS_CANTILEVER, forces, ties, equations,
+                     opts),
+               std::runtime_error);
+}
+
+// A horizontal bar and a diagonal bar with EA = 1 meet at a loaded node.
+// Statics give an axial force of -1 in the horizontal bar and sqrt(2) in the
+// diagonal bar, from which the displacement of the loaded node follows.
+TEST_F(beamFEATest, PlanarAnalysesRejectOutOfPlaneInput) {
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  std::vector<Force> forces = {Force(1, DOF::DISPLACEMENT_Y, 0.1)};
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.5)};
+  Job job(nodes, JOB_CANTILEVER.elems, JOB_CANTILEVER.props);
+
+  for (AnalysisType type : {FRAME_2D, TRUSS_2D}) {
+    Options opts;
+    opts.analysis_type = type;
+    EXPECT_THROW(solve(job, BCS_CANTILEVER, forces, ties, equations, opts),
+                 std::runtime_error);
+
+    std::vector<BC> bcs = BCS_CANTILEVER;
+    bcs.push_back(BC(1, DOF::DISPLACEMENT_Z, 0.1));
+    EXPECT_THROW(
+        solve(JOB_CANTILEVER, bcs, forces, ties, equations, opts),
+        std::runtime_error);
+  }
+}
+
+TEST_F(beamFEATest, CorrectDisplacementTruss) {
+  std::vector<double> normal_vec = {0.0, 0.0, 1.0};
+  Props props(1.0, 1.0, 1.0, 1.0, normal_vec);
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(0.0, 1.0, 0.0)};
+  std::vector<Elem> elems = {Elem(0, 1, props), Elem(2, 1, props)};
+  Job job(nodes, elems);
+
+  std::vector<BC> bcs = {BC(0, 0, 0.0), BC(0, 1, 0.0), BC(2, 0, 0.0),
+                         BC(2, 1, 0.0)};
+  std::vector<Force> forces = {Force(1, DOF::DISPLACEMENT_Y, -1.0)};
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+
+  const double ux = -1.0;
+  const double uy = -1.0 - 2.0 * std::sqrt(2.0);
+
+  Options opts;
+  opts.analysis_type = TRUSS_2D;
+  Summary summary = solve(job, bcs, forces, ties, equations, opts);
+  EXPECT_NEAR(ux, summary.nodal_displacements(1, 0), 1e-12);
+  EXPECT_NEAR(uy, summary.nodal_displacements(1, 1), 1e-12);
+  EXPECT_EQ(6, summary.nodal_displacements.cols());
+
+  // the 3D truss also needs the out-of-plane motion of every node fixed
+  bcs.push_back(BC(0, 2, 0.0));
+  bcs.push_back(BC(1, 2, 0.0));
+  bcs.push_back(BC(2, 2, 0.0));
+  opts.analysis_type = TRUSS_3D;
+  summary = solve(job, bcs, forces, ties, equations, opts);
+  EXPECT_NEAR(ux, summary.nodal_displacements(1, 0), 1e-12);
+  EXPECT_NEAR(uy, summary.nodal_displacements(1, 1), 1e-12);
+  EXPECT_NEAR(0.0, summary.nodal_displacements(1, 2), 1e-12);
+}
+
+// Two cantilevers that are not connected are solved as separate systems and
+// must give the same results as solving each of them on its own.
+TEST_F(beamFEATest, CorrectResultsDisconnectedComponents) {
+  std::vector<double> normal_vec = {0.0, 0.0, 1.0};
+  Props props(1.0, 1.0, 1.0, 1.0, normal_vec);
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(0.0, 1.0, 0.0),
+                             Node(1.0, 0.0, 0.0), Node(0.0, 2.0, 0.0)};
+  std::vector<Elem> elems = {Elem(1, 3, props), Elem(0, 2, props)};
+  Job job(nodes, elems);
+
+  std::vector<BC> bcs = BCS_CANTILEVER;
+  for (size_t i = 0; i < BCS_CANTILEVER.size(); ++i) {
+    bcs.push_back(BC(1, BCS_CANTILEVER[i].dof, 0.0));
+  }
+  std::vector<Force> forces = {Force(2, DOF::DISPLACEMENT_Y, 0.1),
+                               Force(3, DOF::DISPLACEMENT_X, -0.2)};
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+
+  Summary summary = solve(job, bcs, forces, ties, equations, Options());
+  EXPECT_EQ(2, summary.num_components);
+
+  std::vector<Force> forces_0 = {Force(1, DOF::DISPLACEMENT_Y, 0.1)};
+  Summary summary_0 = solve(JOB_CANTILEVER, BCS_CANTILEVER, forces_0, ties,
+                            equations, Options());
+  std::vector<Node> nodes_1 = {Node(0.0, 1.0, 0.0), Node(0.0, 2.0, 0.0)};
+  std::vector<Elem> elems_1 = {Elem(0, 1, props)};
+  std::vector<Force> forces_1 = {Force(1, DOF::DISPLACEMENT_X, -0.2)};
+  Summary summary_1 = solve(Job(nodes_1, elems_1), BCS_CANTILEVER, forces_1,
+                            ties, equations, Options());
+  EXPECT_EQ(1, summary_1.num_components);
+
+  for (int j = 0; j < DOF::NUM_DOFS; ++j) {
+    EXPECT_NEAR(summary_0.nodal_displacements(0, j),
+                summary.nodal_displacements(0, j), 1e-12);
+    EXPECT_NEAR(summary_0.nodal_displacements(1, j),
+                summary.nodal_displacements(2, j), 1e-12);
+    EXPECT_NEAR(summary_1.nodal_displacements(0, j),
+                summary.nodal_displacements(1, j), 1e-12);
+    EXPECT_NEAR(summary_1.nodal_displacements(1, j),
+                summary.nodal_displacements(3, j), 1e-12);
+    EXPECT_NEAR(summary_0.nodal_forces(0, j), summary.nodal_forces(0, j),
+                1e-12);
+    EXPECT_NEAR(summary_1.nodal_forces(0, j), summary.nodal_forces(1, j),
+                1e-12);
+  }
+  for (int j = 0; j < 2 * DOF::NUM_DOFS; ++j) {
+    EXPECT_NEAR(summary_1.element_forces(0, j), summary.element_forces(0, j),
+                1e-12);
+    EXPECT_NEAR(summary_0.element_forces(0, j), summary.element_forces(1, j),
+                1e-12);
+  }
+}
+
+TEST_F(beamFEATest, RejectsUnrestrainedComponent) {
+  std::vector<double> normal_vec = {0.0, 0.0, 1.0};
+  Props props(1.0, 1.0, 1.0, 1.0, normal_vec);
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(0.0, 1.0, 0.0), Node(0.0, 2.0, 0.0)};
+  std::vector<Elem> elems = {Elem(0, 1, props), Elem(2, 3, props)};
+  Job job(nodes, elems);
+
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+
+  // the second beam floats freely
+  EXPECT_THROW(solve(job, BCS_CANTILEVER, FORCES_CANTILEVER, ties, equations,
+                     Options()),
+               std::runtime_error);
+
+  // a node without elements, constraints or boundary conditions
+  nodes.push_back(Node(5.0, 5.0, 5.0));
+  std::vector<BC> bcs = BCS_CANTILEVER;
+  for (size_t i = 0; i < BCS_CANTILEVER.size(); ++i) {
+    bcs.push_back(BC(2, BCS_CANTILEVER[i].dof, 0.0));
+  }
+  EXPECT_THROW(solve(Job(nodes, elems), bcs, FORCES_CANTILEVER, ties,
+                     equations, Options()),
+               std::runtime_error);
+
+  nodes.pop_back();
+  Summary summary = solve(Job(nodes, elems), bcs, FORCES_CANTILEVER, ties,
+                          equations, Options());
+  EXPECT_EQ(2, summary.num_components);
+}
+
+// A node of a 3D truss that only connects to collinear bars has no stiffness
+// perpendicular to them, which is reported instead of failing to factorize.
+TEST_F(beamFEATest, RejectsDofWithoutStiffness) {
+  std::vector<double> normal_vec = {0.0, 0.0, 1.0};
+  Props props(1.0, 1.0, 1.0, 1.0, normal_vec);
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(2.0, 0.0, 0.0)};
+  std::vector<Elem> elems = {Elem(0, 1, props), Elem(1, 2, props)};
+  Job job(nodes, elems);
+
+  std::vector<BC> bcs = {BC(0, 0, 0.0), BC(0, 1, 0.0), BC(0, 2, 0.0),
+                         BC(2, 0, 0.0), BC(2, 1, 0.0), BC(2, 2, 0.0)};
+  std::vector<Force> forces = {Force(1, DOF::DISPLACEMENT_X, 1.0)};
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+
+  Options opts;
+  opts.analysis_type = TRUSS_3D;
+  EXPECT_THROW(solve(job, bcs, forces, ties, equations, opts),
+               std::runtime_error);
+
+  bcs.push_back(BC(1, 1, 0.0));
+  bcs.push_back(BC(1, 2, 0.0));
+  Summary summary = solve(job, bcs, forces, ties, equations, opts);
+  EXPECT_NEAR(0.5, summary.nodal_displacements(1, 0), 1e-12);
+}
+
+TEST(JobTest, AdoptsMovedArraysAndExposesFlatViews) {
+  std::vector<Node> nodes = {Node(0, 0, 0), Node(1, 2, 3), Node(4, 5, 6)};
+  std::vector<Connectivity> elems = {Connectivity(0, 1), Connectivity(1, 2)};
+  std::vector<Props> props(2, Props(1, 2, 3, 4, {0, 0, 1}));
+  const Node *nodes_data = nodes.data();
+  const Connectivity *elems_data = elems.data();
+  const Props *props_data = props.data();
+
+  Job job(std::move(nodes), std::move(elems), std::move(props));
+
+  // the job owns the caller's buffers instead of copies
+  EXPECT_EQ(nodes_data, job.nodes.data());
+  EXPECT_EQ(elems_data, job.elems.data());
+  EXPECT_EQ(props_data, job.props.data());
+
+  ASSERT_EQ(3, job.coordinates().cols());
+  EXPECT_DOUBLE_EQ(5, job.coordinates()(1, 2));
+  EXPECT_EQ(job.nodes[0].data(), job.coordinates().data());
+  ASSERT_EQ(2, job.connectivity().cols());
+  EXPECT_EQ(2u, job.connectivity()(1, 1));
+  EXPECT_DOUBLE_EQ(4, job.getProps(1).GJ);
+
+  // the element vector constructor yields the same job
+  Job from_elems(job.nodes, {Elem(0, 1, job.props[0]), Elem(1, 2, job.props[1])});
+  EXPECT_EQ(job.connectivity(), from_elems.connectivity());
+  EXPECT_DOUBLE_EQ(job.props[1].EA, from_elems.props[1].EA);
 }
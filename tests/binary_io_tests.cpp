@@ -0,0 +1,324 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include "binary_io.h"
+
+using namespace fea;
+
+namespace {
+    std::string readFile(const std::string &filename) {
+        std::ifstream input_file(filename, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(input_file)), std::istreambuf_iterator<char>());
+    }
+
+    template<typename T>
+    T readValue(const std::string &contents, size_t offset) {
+        T value;
+        std::memcpy(&value, contents.data() + offset, sizeof(T));
+        return value;
+    }
+
+    std::vector<std::vector<double> > testData() {
+        return {{1.0, -2.5, 1e-300},
+                {0.1, 4.0, -0.0}};
+    }
+}
+
+namespace {
+    template<typename T>
+    void appendBytes(std::string &out, const T &value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    // builds a version 1.0 .npy file holding `values`
+    template<typename T>
+    std::string npyContents(const std::string &descr, const std::string &shape, const std::vector<T> &values,
+                            bool fortran_order = false) {
+        std::string dict = "{'descr': '" + descr + "', 'fortran_order': " + (fortran_order ? "True" : "False") +
+                           ", 'shape': " + shape + ", }\n";
+        std::string contents("\x93NUMPY\x01\x00", 8);
+        appendBytes(contents, static_cast<std::uint16_t>(dict.size()));
+        contents += dict;
+        for (size_t i = 0; i < values.size(); ++i) {
+            appendBytes(contents, values[i]);
+        }
+        return contents;
+    }
+
+    // builds a zip archive of the `members` as written by numpy.savez, without checksums
+    std::string npzContents(const std::vector<std::pair<std::string, std::string> > &members,
+                            std::uint16_t method = 0) {
+        std::string archive, directory;
+        for (size_t i = 0; i < members.size(); ++i) {
+            const std::uint32_t offset = static_cast<std::uint32_t>(archive.size());
+            const std::uint32_t size = static_cast<std::uint32_t>(members[i].second.size());
+            const std::uint16_t name_length = static_cast<std::uint16_t>(members[i].first.size());
+
+            appendBytes(archive, std::uint32_t(0x04034b50));
+            appendBytes(archive, std::uint16_t(20));
+            appendBytes(archive, std::uint16_t(0));
+            appendBytes(archive, method);
+            appendBytes(archive, std::uint32_t(0));
+            appendBytes(archive, std::uint32_t(0));
+            appendBytes(archive, size);
+            appendBytes(archive, size);
+            appendBytes(archive, name_length);
+            appendBytes(archive, std::uint16_t(0));
+            archive += members[i].first + members[i].second;
+
+            appendBytes(directory, std::uint32_t(0x02014b50));
+            appendBytes(directory, std::uint16_t(20));
+            appendBytes(directory, std::uint16_t(20));
+            appendBytes(directory, std::uint16_t(0));
+            appendBytes(directory, method);
+            appendBytes(directory, std::uint32_t(0));
+            appendBytes(directory, std::uint32_t(0));
+            appendBytes(directory, size);
+            appendBytes(directory, size);
+            appendBytes(directory, name_length);
+            appendBytes(directory, std::uint16_t(0));
+            appendBytes(directory, std::uint16_t(0));
+            appendBytes(directory, std::uint16_t(0));
+            appendBytes(directory, std::uint16_t(0));
+            appendBytes(directory, std::uint32_t(0));
+            appendBytes(directory, offset);
+            directory += members[i].first;
+        }
+        const std::uint32_t directory_offset = static_cast<std::uint32_t>(archive.size());
+        archive += directory;
+        appendBytes(archive, std::uint32_t(0x06054b50));
+        appendBytes(archive, std::uint16_t(0));
+        appendBytes(archive, std::uint16_t(0));
+        appendBytes(archive, static_cast<std::uint16_t>(members.size()));
+        appendBytes(archive, static_cast<std::uint16_t>(members.size()));
+        appendBytes(archive, static_cast<std::uint32_t>(directory.size()));
+        appendBytes(archive, directory_offset);
+        appendBytes(archive, std::uint16_t(0));
+        return archive;
+    }
+
+    void writeFile(const std::string &filename, const std::string &contents) {
+        std::ofstream output_file(filename, std::ios::binary);
+        output_file.write(contents.data(), contents.size());
+    }
+}
+
+TEST(BinaryIOTest, WritesRawBinary) {
+    std::string filename = "raw_results.bin";
+    const std::vector<std::vector<double> > data = testData();
+    writeRawBinary(filename, data);
+
+    const std::string contents = readFile(filename);
+    ASSERT_EQ(64 + 6 * sizeof(double), contents.size());
+    EXPECT_EQ(std::string("FEARES\0\0", 8), contents.substr(0, 8));
+    EXPECT_EQ(1, readValue<std::uint32_t>(contents, 8));
+    EXPECT_EQ(64, readValue<std::uint32_t>(contents, 12));
+    EXPECT_EQ(2, readValue<std::uint64_t>(contents, 16));
+    EXPECT_EQ(3, readValue<std::uint64_t>(contents, 24));
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            // values are stored exactly
+            EXPECT_EQ(0, std::memcmp(&data[i][j], contents.data() + 64 + (3 * i + j) * sizeof(double),
+                                     sizeof(double)));
+        }
+    }
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryIOTest, WritesNpy) {
+    std::string filename = "npy_results.npy";
+    const std::vector<std::vector<double> > data = testData();
+    writeNpy(filename, data);
+
+    const std::string contents = readFile(filename);
+    ASSERT_GE(contents.size(), 10);
+    EXPECT_EQ(std::string("\x93NUMPY\x01\x00", 8), contents.substr(0, 8));
+    const size_t header_size = 10 + readValue<std::uint16_t>(contents, 8);
+    EXPECT_EQ(0, header_size % 64);
+    const std::string dict = contents.substr(10, header_size - 10);
+    EXPECT_EQ(0, dict.find("{'descr': '<f8', 'fortran_order': False, 'shape': (2, 3), }"));
+    EXPECT_EQ('\n', dict.back());
+    ASSERT_EQ(header_size + 6 * sizeof(double), contents.size());
+    EXPECT_EQ(0, std::memcmp(&data[1][0], contents.data() + header_size + 3 * sizeof(double), sizeof(double)));
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryIOTest, WritesEmptyArrays) {
+    std::string filename = "empty_results.npy";
+    writeNpy(filename, std::vector<std::vector<double> >());
+    EXPECT_NE(std::string::npos, readFile(filename).find("'shape': (0, 0)"));
+
+    writeRawBinary(filename, std::vector<std::vector<double> >());
+    EXPECT_EQ(64, readFile(filename).size());
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryIOTest, WritesContiguousArraysLikeNestedVectors) {
+    const std::vector<std::vector<double> > data = testData();
+    const std::vector<double> flat = {data[0][0], data[0][1], data[0][2], data[1][0], data[1][1], data[1][2]};
+
+    writeNpy("nested.npy", data);
+    writeNpy("flat.npy", flat.data(), 2, 3);
+    EXPECT_EQ(readFile("nested.npy"), readFile("flat.npy"));
+
+    writeRawBinary("nested.bin", data);
+    writeRawBinary("flat.bin", flat.data(), 2, 3);
+    EXPECT_EQ(readFile("nested.bin"), readFile("flat.bin"));
+
+    const char *filenames[] = {"nested.npy", "flat.npy", "nested.bin", "flat.bin"};
+    for (const char *filename : filenames) {
+        if (std::remove(filename) != 0) {
+            std::cerr << "Error removing test binary file " << filename << ".\n";
+        }
+    }
+}
+
+TEST(BinaryIOTest, RejectsRaggedRows) {
+    std::vector<std::vector<double> > data = {{1, 2}, {3}};
+    EXPECT_THROW(writeNpy("ragged.npy", data), std::runtime_error);
+    EXPECT_THROW(writeRawBinary("ragged.bin", data), std::runtime_error);
+}
+
+TEST(BinaryIOTest, ReadsNpyWrittenByWriteNpy) {
+    std::string filename = "round_trip.npy";
+    const std::vector<std::vector<double> > expected = testData();
+    writeNpy(filename, expected);
+
+    std::vector<double> data;
+    std::vector<size_t> row_offsets;
+    readNumpyArray(filename, "nodes", data, row_offsets);
+
+    std::vector<size_t> expected_offsets = {0, 3, 6};
+    EXPECT_EQ(expected_offsets, row_offsets);
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(expected[i][j], data[row_offsets[i] + j]);
+        }
+    }
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryIOTest, ConvertsNpyDtypes) {
+    std::string filename = "dtypes.npy";
+    std::vector<size_t> row_offsets;
+
+    // int64 into unsigned indices
+    writeFile(filename, npyContents<std::int64_t>("<i8", "(2, 2)", {0, 1, 1, 2}));
+    std::vector<unsigned int> elems;
+    readNumpyArray(filename, "elems", elems, row_offsets);
+    std::vector<unsigned int> expected_elems = {0, 1, 1, 2};
+    EXPECT_EQ(expected_elems, elems);
+
+    // column-major float32 into doubles
+    writeFile(filename, npyContents<float>("<f4", "(2, 3)", {1, 4, 2, 5, 3, 6}, true));
+    std::vector<double> nodes;
+    readNumpyArray(filename, "nodes", nodes, row_offsets);
+    std::vector<double> expected_nodes = {1, 2, 3, 4, 5, 6};
+    std::vector<size_t> expected_offsets = {0, 3, 6};
+    EXPECT_EQ(expected_nodes, nodes);
+    EXPECT_EQ(expected_offsets, row_offsets);
+
+    // a 1D array has one value per row
+    writeFile(filename, npyContents<std::uint8_t>("|u1", "(3,)", {7, 8, 9}));
+    readNumpyArray(filename, "nodes", nodes, row_offsets);
+    expected_offsets = {0, 1, 2, 3};
+    EXPECT_EQ(expected_offsets, row_offsets);
+    EXPECT_DOUBLE_EQ(9, nodes[2]);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryIOTest, RejectsUnsupportedNpyArrays) {
+    std::string filename = "unsupported.npy";
+    std::vector<unsigned int> elems;
+    std::vector<double> nodes;
+    std::vector<size_t> row_offsets;
+
+    writeFile(filename, npyContents<double>("<f8", "(1, 2)", {0, 1}));
+    EXPECT_THROW(readNumpyArray(filename, "elems", elems, row_offsets), std::runtime_error);
+
+    writeFile(filename, npyContents<double>(">f8", "(1, 2)", {0, 1}));
+    EXPECT_THROW(readNumpyArray(filename, "nodes", nodes, row_offsets), std::runtime_error);
+
+    writeFile(filename, npyContents<double>("<f8", "(1, 1, 2)", {0, 1}));
+    EXPECT_THROW(readNumpyArray(filename, "nodes", nodes, row_offsets), std::runtime_error);
+
+    writeFile(filename, npyContents<double>("<f8", "(2, 2)", {0, 1}));
+    EXPECT_THROW(readNumpyArray(filename, "nodes", nodes, row_offsets), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryIOTest, ReadsNamedArraysFromNpz) {
+    std::string filename = "model.npz";
+    writeFile(filename, npzContents({{"nodes.npy", npyContents<double>("<f8", "(2, 3)", {0, 0, 0, 1, 0, 0})},
+                                     {"elems.npy", npyContents<std::int32_t>("<i4", "(1, 2)", {0, 1})}}));
+
+    std::vector<double> nodes;
+    std::vector<unsigned int> elems;
+    std::vector<size_t> row_offsets;
+    readNumpyArray(filename, "nodes", nodes, row_offsets);
+    std::vector<double> expected_nodes = {0, 0, 0, 1, 0, 0};
+    EXPECT_EQ(expected_nodes, nodes);
+
+    readNumpyArray(filename, "elems", elems, row_offsets);
+    std::vector<unsigned int> expected_elems = {0, 1};
+    EXPECT_EQ(expected_elems, elems);
+
+    EXPECT_THROW(readNumpyArray(filename, "props", nodes, row_offsets), std::runtime_error);
+
+    // an archive holding a single array is used for any name
+    writeFile(filename, npzContents({{"arr_0.npy", npyContents<double>("<f8", "(1, 3)", {1, 2, 3})}}));
+    readNumpyArray(filename, "props", nodes, row_offsets);
+    EXPECT_EQ(3, nodes.size());
+
+    // compressed members are rejected
+    writeFile(filename, npzContents({{"arr_0.npy", npyContents<double>("<f8", "(1, 3)", {1, 2, 3})}}, 8));
+    EXPECT_THROW(readNumpyArray(filename, "props", nodes, row_offsets), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary file " << filename << ".\n";
+    }
+}
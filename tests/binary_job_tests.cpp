@@ -0,0 +1,172 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include "binary_job.h"
+#include "setup.h"
+
+using namespace fea;
+
+namespace {
+    Model createTestModel() {
+        Model model;
+        Props props(1, 2, 3, 4, {0, 0, 1});
+        model.job = Job({Node(0, 0, 0), Node(1, 0, 0), Node(2, 0.5, 0)},
+                        {Elem(0, 1, props), Elem(1, 2, props)});
+        model.bcs = {BC(0, DOF::DISPLACEMENT_X, 0), BC(0, DOF::ROTATION_Z, 0.25)};
+        model.forces = {Force(2, DOF::DISPLACEMENT_Y, -10)};
+        model.ties = {Tie(1, 2, 100, 200)};
+        model.equations = {Equation({Equation::Term(1, DOF::DISPLACEMENT_X, 1),
+                                     Equation::Term(2, DOF::DISPLACEMENT_X, -1)})};
+        model.rigid_bodies = {RigidBody(0, std::vector<NodeIndex>{1, 2})};
+        return model;
+    }
+}
+
+TEST(BinaryJobTest, RoundTripsModel) {
+    const Model expected = createTestModel();
+    std::string filename = "round_trip.fbj";
+    writeBinaryJob(filename, expected);
+
+    const Model model = readBinaryJob(filename);
+
+    ASSERT_EQ(expected.job.nodes.size(), model.job.nodes.size());
+    for (size_t i = 0; i < model.job.nodes.size(); ++i) {
+        EXPECT_EQ(expected.job.nodes[i], model.job.nodes[i]);
+    }
+    ASSERT_EQ(expected.job.elems.size(), model.job.elems.size());
+    ASSERT_EQ(expected.job.props.size(), model.job.props.size());
+    for (size_t i = 0; i < model.job.elems.size(); ++i) {
+        EXPECT_EQ(expected.job.elems[i], model.job.elems[i]);
+        EXPECT_DOUBLE_EQ(expected.job.props[i].EA, model.job.props[i].EA);
+        EXPECT_DOUBLE_EQ(expected.job.props[i].EIz, model.job.props[i].EIz);
+        EXPECT_DOUBLE_EQ(expected.job.props[i].EIy, model.job.props[i].EIy);
+        EXPECT_DOUBLE_EQ(expected.job.props[i].GJ, model.job.props[i].GJ);
+        EXPECT_EQ(expected.job.props[i].normal_vec, model.job.props[i].normal_vec);
+    }
+    EXPECT_TRUE(model.job.sections.empty());
+
+    ASSERT_EQ(2, model.bcs.size());
+    EXPECT_EQ(0, model.bcs[1].node);
+    EXPECT_EQ(DOF::ROTATION_Z, model.bcs[1].dof);
+    EXPECT_DOUBLE_EQ(0.25, model.bcs[1].value);
+
+    ASSERT_EQ(1, model.forces.size());
+    EXPECT_EQ(2, model.forces[0].node);
+    EXPECT_EQ(DOF::DISPLACEMENT_Y, model.forces[0].dof);
+    EXPECT_DOUBLE_EQ(-10, model.forces[0].value);
+
+    ASSERT_EQ(1, model.ties.size());
+    EXPECT_EQ(1, model.ties[0].node_number_1);
+    EXPECT_EQ(2, model.ties[0].node_number_2);
+    EXPECT_DOUBLE_EQ(100, model.ties[0].lmult);
+    EXPECT_DOUBLE_EQ(200, model.ties[0].rmult);
+
+    ASSERT_EQ(1, model.equations.size());
+    ASSERT_EQ(2, model.equations[0].terms.size());
+    EXPECT_EQ(2, model.equations[0].terms[1].node_number);
+    EXPECT_DOUBLE_EQ(-1, model.equations[0].terms[1].coefficient);
+
+    ASSERT_EQ(1, model.rigid_bodies.size());
+    EXPECT_EQ(0, model.rigid_bodies[0].master_node);
+    EXPECT_EQ(expected.rigid_bodies[0].slave_nodes, model.rigid_bodies[0].slave_nodes);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary job file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryJobTest, RoundTripsSectionTable) {
+    Model expected;
+    Props steel(1, 2, 3, 4, {0, 0, 1});
+    Props aluminum(5, 6, 7, 8, {0, 1, 0});
+    expected.job = Job({Node(0, 0, 0), Node(1, 0, 0), Node(2, 0, 0)},
+                       {Connectivity(0, 1), Connectivity(1, 2)},
+                       {steel, aluminum}, {1, 0},
+                       {Eigen::Vector3d(0, 1, 0), Eigen::Vector3d(0, 0, -1)});
+    std::string filename = "section_table.fbj";
+    writeBinaryJob(filename, expected);
+
+    const Model model = readBinaryJob(filename);
+
+    EXPECT_TRUE(model.job.props.empty());
+    ASSERT_EQ(2, model.job.sections.size());
+    EXPECT_EQ(expected.job.section_ids, model.job.section_ids);
+    ASSERT_EQ(2, model.job.orientations.size());
+    for (size_t i = 0; i < 2; ++i) {
+        EXPECT_DOUBLE_EQ(expected.job.getProps(i).EA, model.job.getProps(i).EA);
+        EXPECT_EQ(expected.job.getNormalVec(i), model.job.getNormalVec(i));
+    }
+    EXPECT_TRUE(model.bcs.empty());
+    EXPECT_TRUE(model.equations.empty());
+    EXPECT_TRUE(model.rigid_bodies.empty());
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary job file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryJobTest, CreatesModelFromBinaryJobInConfig) {
+    std::string filename = "config_model.fbj";
+    writeBinaryJob(filename, createTestModel());
+
+    rapidjson::Document doc;
+    doc.Parse("{\"binary_job\":\"config_model.fbj\"}");
+    const Model model = createModelFromJSON(doc);
+
+    EXPECT_EQ(3, model.job.nodes.size());
+    EXPECT_EQ(2, model.job.elems.size());
+    EXPECT_EQ(1, model.forces.size());
+    EXPECT_EQ(1, model.rigid_bodies.size());
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary job file " << filename << ".\n";
+    }
+}
+
+TEST(BinaryJobTest, RejectsInvalidFiles) {
+    std::string filename = "invalid.fbj";
+    std::ofstream output_file(filename);
+    output_file << "1,2,3\n";
+    output_file.close();
+    EXPECT_THROW(readBinaryJob(filename), std::runtime_error);
+
+    // a truncated file fails instead of reading past the end of the mapping
+    writeBinaryJob(filename, createTestModel());
+    std::ifstream input_file(filename, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(input_file)), std::istreambuf_iterator<char>());
+    input_file.close();
+    output_file.open(filename, std::ios::binary | std::ios::trunc);
+    output_file.write(contents.data(), contents.size() - 8);
+    output_file.close();
+    EXPECT_THROW(readBinaryJob(filename), std::runtime_error);
+
+    EXPECT_THROW(readBinaryJob("does_not_exist.fbj"), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test binary job file " << filename << ".\n";
+    }
+}
@@ -0,0 +1,120 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+
+#include "coincident_nodes.h"
+
+using namespace fea;
+
+TEST(CoincidentNodesTest, FindsNodesWithinTolerance) {
+  // nodes 0, 2 and 5 straddle the boundaries of grid cells
+  std::vector<Node> nodes = {Node(0.0, 0.0, -1e-4),  Node(1.0, 0.0, 0.0),
+                             Node(0.0, 0.0, 1e-4),   Node(1.0, 0.01, 0.0),
+                             Node(2.0, 0.0, 0.0),    Node(1e-4, 1e-4, 0.0),
+                             Node(1.0, 0.0, 0.0011)};
+
+  std::vector<NodeIndex> representatives = findCoincidentNodes(nodes, 1e-3);
+
+  std::vector<NodeIndex> expected = {0, 1, 0, 3, 4, 0, 6};
+  ASSERT_EQ(expected.size(), representatives.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], representatives[i]);
+  }
+}
+
+TEST(CoincidentNodesTest, JoinsChainsOfCoincidentNodes) {
+  // node 2 is only within the tolerance of node 1, which is within the
+  // tolerance of node 0
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(0.8, 0.0, 0.0),
+                             Node(1.6, 0.0, 0.0), Node(5.0, 0.0, 0.0)};
+
+  std::vector<NodeIndex> representatives = findCoincidentNodes(nodes, 1.0);
+
+  std::vector<NodeIndex> expected = {0, 0, 0, 3};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], representatives[i]);
+  }
+}
+
+TEST(CoincidentNodesTest, RejectsNonPositiveTolerance) {
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0)};
+  EXPECT_THROW(findCoincidentNodes(nodes, 0.0), std::runtime_error);
+  EXPECT_THROW(findCoincidentNodes(nodes, -1.0), std::runtime_error);
+}
+
+TEST(CoincidentNodesTest, CreatesRigidBodiesAndTies) {
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(0.0, 0.0, 0.0)};
+
+  std::vector<RigidBody> bodies = createCoincidentNodeRigidBodies(nodes, 1e-9);
+  ASSERT_EQ(2, bodies.size());
+  EXPECT_EQ(0u, bodies[0].master_node);
+  ASSERT_EQ(2, bodies[0].slave_nodes.size());
+  EXPECT_EQ(2u, bodies[0].slave_nodes[0]);
+  EXPECT_EQ(4u, bodies[0].slave_nodes[1]);
+  EXPECT_EQ(1u, bodies[1].master_node);
+  ASSERT_EQ(1, bodies[1].slave_nodes.size());
+  EXPECT_EQ(3u, bodies[1].slave_nodes[0]);
+
+  // duplicates of the nodes of existing rigid bodies are attached to them
+  std::vector<RigidBody> existing = {RigidBody(0, 1)};
+  bodies = createCoincidentNodeRigidBodies(nodes, 1e-9, existing);
+  ASSERT_EQ(1, bodies.size());
+  EXPECT_EQ(0u, bodies[0].master_node);
+  ASSERT_EQ(3, bodies[0].slave_nodes.size());
+  EXPECT_EQ(2u, bodies[0].slave_nodes[0]);
+  EXPECT_EQ(3u, bodies[0].slave_nodes[1]);
+  EXPECT_EQ(4u, bodies[0].slave_nodes[2]);
+
+  existing = {RigidBody(2, 4)};
+  bodies = createCoincidentNodeRigidBodies(nodes, 1e-9, existing);
+  ASSERT_EQ(2, bodies.size());
+  EXPECT_EQ(2u, bodies[0].master_node);
+  ASSERT_EQ(1, bodies[0].slave_nodes.size());
+  EXPECT_EQ(0u, bodies[0].slave_nodes[0]);
+  EXPECT_EQ(1u, bodies[1].master_node);
+  ASSERT_EQ(1, bodies[1].slave_nodes.size());
+  EXPECT_EQ(3u, bodies[1].slave_nodes[0]);
+
+  existing = {RigidBody(0, 5)};
+  EXPECT_THROW(createCoincidentNodeRigidBodies(nodes, 1e-9, existing),
+               std::runtime_error);
+  existing = {RigidBody(5, 0)};
+  EXPECT_THROW(createCoincidentNodeRigidBodies(nodes, 1e-9, existing),
+               std::runtime_error);
+
+  std::vector<Tie> ties = createCoincidentNodeTies(nodes, 1e-9, 10.0, 20.0);
+  ASSERT_EQ(3, ties.size());
+  EXPECT_EQ(0u, ties[0].node_number_1);
+  EXPECT_EQ(2u, ties[0].node_number_2);
+  EXPECT_EQ(1u, ties[1].node_number_1);
+  EXPECT_EQ(3u, ties[1].node_number_2);
+  EXPECT_EQ(0u, ties[2].node_number_1);
+  EXPECT_EQ(4u, ties[2].node_number_2);
+  EXPECT_DOUBLE_EQ(10.0, ties[2].lmult);
+  EXPECT_DOUBLE_EQ(20.0, ties[2].rmult);
+}
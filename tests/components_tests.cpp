@@ -0,0 +1,157 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+
+#include "components.h"
+
+using namespace fea;
+
+namespace {
+
+Props beamProps() { return Props(1.0, 1.0, 1.0, 1.0, {0.0, 0.0, 1.0}); }
+
+std::vector<BC> fixedNode(unsigned int node) {
+  std::vector<BC> bcs;
+  for (unsigned int dof = 0; dof < 6; ++dof) {
+    bcs.push_back(BC(node, dof, 0.0));
+  }
+  return bcs;
+}
+
+// Counts the unrestrained modes of a job that forms a single component.
+template <typename Config>
+unsigned int countModes(const Job &job, const std::vector<BC> &bcs,
+                        const std::vector<Equation> &equations) {
+  std::vector<Component> components =
+      findComponents(job, bcs, {}, {}, equations, {});
+  EXPECT_EQ(1, components.size());
+  return countUnrestrainedModes<Config>(components[0], job, bcs, equations);
+}
+
+} // namespace
+
+TEST(ComponentsTest, FindsDisconnectedParts) {
+  // two beams joined by a tie, a separate beam and a node joined to the
+  // separate beam by an equation, and an isolated node
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(5.0, 0.0, 0.0), Node(6.0, 0.0, 0.0),
+                             Node(1.0, 0.0, 0.0), Node(2.0, 0.0, 0.0),
+                             Node(9.0, 0.0, 0.0), Node(6.0, 1.0, 0.0)};
+  std::vector<Elem> elems = {Elem(0, 1, beamProps()), Elem(2, 3, beamProps()),
+                             Elem(4, 5, beamProps())};
+  Job job(nodes, elems);
+
+  std::vector<BC> bcs = {BC(6, 0, 0.0), BC(2, 0, 0.0), BC(0, 0, 0.0)};
+  std::vector<Force> forces = {Force(5, 1, 1.0)};
+  std::vector<Tie> ties = {Tie(1, 4, 1.0, 1.0)};
+  std::vector<Equation> equations = {
+      Equation({Equation::Term(3, 0, 1.0), Equation::Term(7, 0, -1.0)})};
+  std::vector<RigidBody> rigid_bodies;
+
+  std::vector<Component> components =
+      findComponents(job, bcs, forces, ties, equations, rigid_bodies);
+
+  ASSERT_EQ(3, components.size());
+  EXPECT_EQ(std::vector<NodeIndex>({0, 1, 4, 5}), components[0].nodes);
+  EXPECT_EQ(std::vector<size_t>({0, 2}), components[0].elems);
+  EXPECT_EQ(std::vector<size_t>({2}), components[0].bcs);
+  EXPECT_EQ(std::vector<size_t>({0}), components[0].forces);
+  EXPECT_EQ(std::vector<size_t>({0}), components[0].ties);
+
+  EXPECT_EQ(std::vector<NodeIndex>({2, 3, 7}), components[1].nodes);
+  EXPECT_EQ(std::vector<size_t>({1}), components[1].elems);
+  EXPECT_EQ(std::vector<size_t>({1}), components[1].bcs);
+  EXPECT_EQ(std::vector<size_t>({0}), components[1].equations);
+
+  EXPECT_EQ(std::vector<NodeIndex>({6}), components[2].nodes);
+  EXPECT_EQ(std::vector<size_t>({0}), components[2].bcs);
+  EXPECT_TRUE(components[2].elems.empty());
+}
+
+TEST(ComponentsTest, ExtractsRenumberedComponent) {
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(5.0, 0.0, 0.0),
+                             Node(1.0, 0.0, 0.0), Node(6.0, 0.0, 0.0)};
+  std::vector<Elem> elems = {Elem(0, 2, beamProps()), Elem(1, 3, beamProps())};
+  Job job(nodes, elems);
+
+  std::vector<BC> bcs = fixedNode(1);
+  std::vector<Force> forces = {Force(3, 1, 1.0)};
+  std::vector<Tie> ties;
+  std::vector<Equation> equations;
+  std::vector<RigidBody> rigid_bodies;
+
+  std::vector<Component> components =
+      findComponents(job, bcs, forces, ties, equations, rigid_bodies);
+  ASSERT_EQ(2, components.size());
+
+  ComponentAnalysis analysis = extractComponent(
+      components[1], job, bcs, forces, ties, equations, rigid_bodies);
+  ASSERT_EQ(2, analysis.job.nodes.size());
+  EXPECT_DOUBLE_EQ(5.0, analysis.job.nodes[0](0));
+  EXPECT_DOUBLE_EQ(6.0, analysis.job.nodes[1](0));
+  ASSERT_EQ(1, analysis.job.elems.size());
+  EXPECT_EQ(0, analysis.job.elems[0](0));
+  EXPECT_EQ(1, analysis.job.elems[0](1));
+  ASSERT_EQ(6, analysis.bcs.size());
+  EXPECT_EQ(0, analysis.bcs[0].node);
+  ASSERT_EQ(1, analysis.forces.size());
+  EXPECT_EQ(1, analysis.forces[0].node);
+}
+
+TEST(ComponentsTest, CountsUnrestrainedRigidBodyModes) {
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(1.0, 1.0, 0.0)};
+  std::vector<Elem> elems = {Elem(0, 1, beamProps()), Elem(1, 2, beamProps())};
+  Job job(nodes, elems);
+
+  EXPECT_EQ(6, countModes<Frame3D>(job, {}, {}));
+  EXPECT_EQ(3, countModes<Frame2D>(job, {}, {}));
+  EXPECT_EQ(0, countModes<Frame3D>(job, fixedNode(0), {}));
+
+  // pinning two nodes leaves the rotation about the line through them
+  std::vector<BC> pins = {BC(0, 0, 0.0), BC(0, 1, 0.0), BC(0, 2, 0.0),
+                          BC(1, 0, 0.0), BC(1, 1, 0.0), BC(1, 2, 0.0)};
+  EXPECT_EQ(1, countModes<Frame3D>(job, pins, {}));
+
+  // an equation tying the rotation of node 0 to ground removes that mode
+  std::vector<Equation> equations = {Equation({Equation::Term(0, 3, 1.0)})};
+  EXPECT_EQ(0, countModes<Frame3D>(job, pins, equations));
+}
+
+TEST(ComponentsTest, IgnoresRotationOfStraightTruss) {
+  // a truss on the x-axis cannot represent a rotation about the x-axis
+  std::vector<Node> nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 0.0, 0.0),
+                             Node(2.0, 0.0, 0.0)};
+  std::vector<Elem> elems = {Elem(0, 1, beamProps()), Elem(1, 2, beamProps())};
+  Job job(nodes, elems);
+
+  std::vector<BC> bcs = {BC(0, 0, 0.0), BC(0, 1, 0.0), BC(0, 2, 0.0),
+                         BC(2, 1, 0.0), BC(2, 2, 0.0)};
+  EXPECT_EQ(0, countModes<Truss3D>(job, bcs, {}));
+
+  bcs.pop_back();
+  EXPECT_EQ(1, countModes<Truss3D>(job, bcs, {}));
+}
@@ -98,3 +98,205 @@ TEST(CSVParserTest, ReadWriteElemSetFromFile) {
         std::cerr << "Error removing test csv file " << filename << ".\n";
     }
 }
+
+TEST(CSVParserTest, ParseToArrayRaggedRows) {
+
+    std::string filename = "ragged_rows_to_array.csv";
+    std::ofstream output_file(filename);
+    output_file << "1,2,3\r\n\n4, 5\t6,7e-1\n  -8.5 ,  1.25E2\n9";
+    output_file.close();
+
+    CSVParser csv;
+    std::vector<double> data;
+    std::vector<size_t> row_offsets;
+    csv.parseToArray(filename, data, row_offsets);
+
+    std::vector<double> expected_data = {1, 2, 3, 4, 5, 6, 0.7, -8.5, 125, 9};
+    std::vector<size_t> expected_offsets = {0, 3, 7, 9, 10};
+    ASSERT_EQ(expected_data.size(), data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_DOUBLE_EQ(expected_data[i], data[i]);
+    }
+    EXPECT_EQ(expected_offsets, row_offsets);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
+
+TEST(CSVParserTest, ParseToArrayIntegers) {
+
+    std::string filename = "integers_to_array.csv";
+    std::ofstream output_file(filename);
+    output_file << "0,1\n1.0,-2\n+3,4e1\n";
+    output_file.close();
+
+    CSVParser csv;
+    std::vector<int> data;
+    std::vector<size_t> row_offsets;
+    csv.parseToArray(filename, data, row_offsets);
+
+    std::vector<int> expected_data = {0, 1, 1, -2, 3, 40};
+    std::vector<size_t> expected_offsets = {0, 2, 4, 6};
+    EXPECT_EQ(expected_data, data);
+    EXPECT_EQ(expected_offsets, row_offsets);
+
+    // unsigned integers such as node indices reject negative and fractional values
+    std::vector<unsigned int> indices;
+    EXPECT_THROW(csv.parseToArray(filename, indices, row_offsets), std::runtime_error);
+    output_file.open(filename);
+    output_file << "0,1\n1.5,2\n";
+    output_file.close();
+    EXPECT_THROW(csv.parseToArray(filename, indices, row_offsets), std::runtime_error);
+    EXPECT_THROW(csv.parseToArray(filename, data, row_offsets), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
+
+TEST(CSVParserTest, ParseToArrayMatchesParseToVectorAcrossChunks) {
+
+    // large enough to be split into several chunks
+    std::vector<std::vector<double> > expected(100000, std::vector<double>(3));
+    for (size_t i = 0; i < expected.size(); ++i) {
+        expected[i][0] = 0.5 * i;
+        expected[i][1] = -1.0 * i;
+        expected[i][2] = 1.0 / (i + 1);
+    }
+
+    std::string filename = "large_to_array.csv";
+    CSVParser csv;
+    csv.write(filename, expected, 12, ",");
+
+    std::vector<std::vector<double> > rows;
+    csv.parseToVector(filename, rows);
+    std::vector<double> data;
+    std::vector<size_t> row_offsets;
+    csv.parseToArray(filename, data, row_offsets);
+
+    ASSERT_EQ(rows.size() + 1, row_offsets.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ASSERT_EQ(3 * i, row_offsets[i]);
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(rows[i][j], data[row_offsets[i] + j]);
+        }
+    }
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
+
+TEST(CSVParserTest, ParseToArrayReportsLineOfInvalidValue) {
+
+    std::string filename = "invalid_to_array.csv";
+    std::ofstream output_file(filename);
+    output_file << "1,2\n\n3,x\n";
+    output_file.close();
+
+    CSVParser csv;
+    std::vector<double> data;
+    std::vector<size_t> row_offsets;
+    try {
+        csv.parseToArray(filename, data, row_offsets);
+        FAIL() << "Expected an exception for a value that is not a number.";
+    }
+    catch (const std::runtime_error &e) {
+        EXPECT_NE(std::string(e.what()).find("Line 3"), std::string::npos) << e.what();
+    }
+
+    EXPECT_THROW(csv.parseToArray("does_not_exist.csv", data, row_offsets), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
+
+TEST(CSVParserTest, SplitLinesAlignsChunksToLines) {
+
+    std::string text = "aaaa\nbb\ncccccc\nd\n";
+    std::vector<size_t> bounds = splitLines(text.data(), text.size(), 3);
+
+    ASSERT_GE(bounds.size(), 2);
+    EXPECT_EQ(0, bounds.front());
+    EXPECT_EQ(text.size(), bounds.back());
+    for (size_t i = 1; i + 1 < bounds.size(); ++i) {
+        EXPECT_EQ('\n', text[bounds[i] - 1]);
+    }
+}
+
+namespace {
+    template<typename T>
+    std::string formatWithStream(const std::vector<std::vector<T> > &data, unsigned int precision,
+                                 const std::string &delimiter) {
+        std::ostringstream out;
+        for (size_t i = 0; i < data.size(); ++i) {
+            for (size_t j = 0; j < data[i].size(); ++j) {
+                out << std::fixed << std::setprecision(precision) << data[i][j];
+                if (j < data[i].size() - 1) {
+                    out << delimiter;
+                }
+            }
+            out << "\n";
+        }
+        return out.str();
+    }
+
+    std::string readFile(const std::string &filename) {
+        std::ifstream input_file(filename, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(input_file)), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST(CSVParserTest, WriteMatchesStreamFormatting) {
+
+    // enough rows to span several formatting blocks
+    std::vector<std::vector<double> > doubles(10000);
+    for (size_t i = 0; i < doubles.size(); ++i) {
+        doubles[i] = {1.0 / (i + 1), -1.5e10 * i, 0.5, -0.0, 1e-20 * i, 123456789.987654321};
+    }
+    doubles.push_back({});
+    doubles.push_back({1e300, -2.5, std::numeric_limits<double>::infinity()});
+
+    std::vector<std::vector<int> > ints = {{0, -1, 2147483647}, {-2147483647 - 1}, {}};
+    std::vector<std::vector<unsigned int> > uints = {{0, 1, 4294967295u}};
+
+    CSVParser csv;
+    std::string filename = "write_matches_stream.csv";
+    unsigned int precisions[] = {0, 3, 8, 14};
+    for (unsigned int precision : precisions) {
+        csv.write(filename, doubles, precision, ",");
+        EXPECT_EQ(formatWithStream(doubles, precision, ","), readFile(filename)) << precision;
+    }
+    csv.write(filename, doubles, 6, "; ");
+    EXPECT_EQ(formatWithStream(doubles, 6, "; "), readFile(filename));
+    csv.write(filename, ints, 4, ",");
+    EXPECT_EQ(formatWithStream(ints, 4, ","), readFile(filename));
+    csv.write(filename, uints, 4, ",");
+    EXPECT_EQ(formatWithStream(uints, 4, ","), readFile(filename));
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
+
+TEST(CSVParserTest, WritesContiguousArrayLikeNestedVectors) {
+    std::vector<std::vector<double> > nested = {{1.5, -2.0, 3.25}, {0.0, 1e6, -7.125}};
+    std::vector<double> flat;
+    for (size_t i = 0; i < nested.size(); ++i) {
+        flat.insert(flat.end(), nested[i].begin(), nested[i].end());
+    }
+
+    CSVParser csv;
+    csv.write("contiguous_nested.csv", nested, 4, ",");
+    csv.write("contiguous_flat.csv", flat.data(), 2, 3, 4, ",");
+    EXPECT_EQ(readFile("contiguous_nested.csv"), readFile("contiguous_flat.csv"));
+
+    const char *filenames[] = {"contiguous_nested.csv", "contiguous_flat.csv"};
+    for (const char *filename : filenames) {
+        if (std::remove(filename) != 0) {
+            std::cerr << "Error removing test csv file " << filename << ".\n";
+        }
+    }
+}
@@ -0,0 +1,252 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include "element_stream.h"
+#include "setup.h"
+#include "threed_beam_fea.h"
+
+using namespace fea;
+
+namespace {
+    void writeFile(const std::string &filename, const std::string &contents) {
+        std::ofstream file(filename);
+        file << contents;
+    }
+
+    Model createTestModel() {
+        Model model;
+        Props props(1000, 20, 30, 40, {0, 0, 1});
+        Props stiff_props(2000, 40, 60, 80, {0, 1, 0});
+        model.job = Job({Node(0, 0, 0), Node(1, 0, 0), Node(2, 0.5, 0), Node(3, 0.5, 1), Node(4, 1, 1)},
+                        {Elem(0, 1, props), Elem(1, 2, stiff_props), Elem(2, 3, props), Elem(3, 4, stiff_props),
+                         Elem(1, 3, props)});
+        for (unsigned int dof = 0; dof < DOF::NUM_DOFS; ++dof) {
+            model.bcs.push_back(BC(0, dof, 0));
+        }
+        model.forces = {Force(4, DOF::DISPLACEMENT_Y, -10), Force(3, DOF::DISPLACEMENT_Z, 5)};
+        model.ties = {Tie(2, 4, 100, 200)};
+        return model;
+    }
+
+    void writeTestModel(const Model &model, const std::string &elems_filename, const std::string &props_filename) {
+        std::ofstream elems_file(elems_filename);
+        std::ofstream props_file(props_filename);
+        elems_file.precision(17);
+        props_file.precision(17);
+        for (size_t i = 0; i < model.job.elems.size(); ++i) {
+            const Props &p = model.job.props[i];
+            elems_file << model.job.elems[i][0] << "," << model.job.elems[i][1] << "\n";
+            props_file << p.EA << "," << p.EIz << "," << p.EIy << "," << p.GJ << "," << p.normal_vec(0) << ","
+                       << p.normal_vec(1) << "," << p.normal_vec(2) << "\n";
+        }
+    }
+}
+
+TEST(ElementStreamTest, ReadsElementsInChunks) {
+    writeFile("stream_elems.csv", "0,1\n1,2\n\n2,3\n3,4\n4,5\n");
+    writeFile("stream_props.csv", "1,2,3,4,0,0,1\n2,2,3,4,0,0,1\n3,2,3,4,0,0,1\n4,2,3,4,0,0,1\n5,2,3,4,0,1,0\n");
+    ElementStream stream("stream_elems.csv", "stream_props.csv", 2);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        ElementChunk chunk;
+        std::vector<size_t> chunk_sizes;
+        std::vector<size_t> firsts;
+        std::vector<double> EAs;
+        while (stream.next(chunk)) {
+            chunk_sizes.push_back(chunk.elems.size());
+            firsts.push_back(chunk.first);
+            for (size_t i = 0; i < chunk.elems.size(); ++i) {
+                EXPECT_EQ(chunk.first + i, static_cast<size_t>(chunk.elems[i][0]));
+                EXPECT_EQ(chunk.first + i + 1, static_cast<size_t>(chunk.elems[i][1]));
+                EAs.push_back(chunk.props[i].EA);
+                const Eigen::Vector3d normal_vec = chunk.first + i == 4 ? Eigen::Vector3d(0, 1, 0)
+                                                                        : Eigen::Vector3d(0, 0, 1);
+                EXPECT_EQ(normal_vec, chunk.props[i].normal_vec);
+            }
+        }
+        EXPECT_EQ((std::vector<size_t>{2, 2, 1}), chunk_sizes);
+        EXPECT_EQ((std::vector<size_t>{0, 2, 4}), firsts);
+        EXPECT_EQ((std::vector<double>{1, 2, 3, 4, 5}), EAs);
+        stream.rewind();
+    }
+}
+
+TEST(ElementStreamTest, ResolvesSections) {
+    writeFile("stream_section_elems.csv", "0,1,1\n1,2,0,1,0,0\n");
+    std::vector<Props> sections = {Props(1, 2, 3, 4, {0, 0, 1}), Props(5, 6, 7, 8, {0, 1, 0})};
+    ElementStream stream("stream_section_elems.csv", sections, 10);
+
+    ElementChunk chunk;
+    ASSERT_TRUE(stream.next(chunk));
+    ASSERT_EQ(2, chunk.elems.size());
+    EXPECT_DOUBLE_EQ(5, chunk.props[0].EA);
+    EXPECT_EQ(Eigen::Vector3d(0, 1, 0), chunk.props[0].normal_vec);
+    EXPECT_DOUBLE_EQ(1, chunk.props[1].EA);
+    EXPECT_EQ(Eigen::Vector3d(1, 0, 0), chunk.props[1].normal_vec);
+    EXPECT_FALSE(stream.next(chunk));
+}
+
+TEST(ElementStreamTest, ThrowsOnMismatchedRows) {
+    writeFile("stream_short_elems.csv", "0,1\n1,2\n");
+    writeFile("stream_long_props.csv", "1,2,3,4,0,0,1\n1,2,3,4,0,0,1\n1,2,3,4,0,0,1\n");
+    ElementStream stream("stream_short_elems.csv", "stream_long_props.csv", 1);
+    ElementChunk chunk;
+    EXPECT_TRUE(stream.next(chunk));
+    EXPECT_TRUE(stream.next(chunk));
+    EXPECT_THROW(stream.next(chunk), std::runtime_error);
+
+    writeFile("stream_bad_elems.csv", "0,1\n1,x\n");
+    ElementStream bad_stream("stream_bad_elems.csv", "stream_long_props.csv", 1);
+    EXPECT_TRUE(bad_stream.next(chunk));
+    EXPECT_THROW(bad_stream.next(chunk), std::runtime_error);
+}
+
+TEST(ElementStreamTest, ThrowsOnInvalidNodeIndices) {
+    writeFile("stream_props.csv", "1,2,3,4,0,0,1\n");
+    ElementChunk chunk;
+    for (const char *elems : {"0,-1\n", "0.5,1\n", "0,1e30\n"}) {
+        writeFile("stream_invalid_elems.csv", elems);
+        ElementStream stream("stream_invalid_elems.csv", "stream_props.csv", 1);
+        EXPECT_THROW(stream.next(chunk), std::runtime_error) << elems;
+    }
+
+    std::vector<Props> sections = {Props(1, 2, 3, 4, {0, 0, 1})};
+    for (const char *elems : {"0,-1,0\n", "0,1,-1\n", "0,1,0.5\n"}) {
+        writeFile("stream_invalid_elems.csv", elems);
+        ElementStream stream("stream_invalid_elems.csv", sections, 1);
+        EXPECT_THROW(stream.next(chunk), std::runtime_error) << elems;
+    }
+}
+
+TEST(ElementStreamTest, StreamedSolveMatchesInMemorySolve) {
+    const Model model = createTestModel();
+    writeTestModel(model, "stream_model_elems.csv", "stream_model_props.csv");
+    const Summary expected = solve(model, Options());
+
+    Model streamed_model = model;
+    streamed_model.job = Job(model.job.nodes, std::vector<Elem>());
+    streamed_model.element_stream = std::make_shared<ElementStream>("stream_model_elems.csv",
+                                                                    "stream_model_props.csv", 2);
+    const Summary summary = solve(streamed_model, Options());
+
+    EXPECT_EQ(model.job.elems.size(), summary.num_elems);
+    ASSERT_EQ(expected.nodal_displacements.rows(), summary.nodal_displacements.rows());
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+            EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+            EXPECT_NEAR(expected.nodal_forces(i, j), summary.nodal_forces(i, j), 1e-8);
+        }
+    }
+    ASSERT_EQ(expected.element_forces.rows(), summary.element_forces.rows());
+    for (size_t i = 0; i < summary.element_forces.rows(); ++i) {
+        for (size_t j = 0; j < 2 * DOF::NUM_DOFS; ++j) {
+            EXPECT_NEAR(expected.element_forces(i, j), summary.element_forces(i, j), 1e-8);
+        }
+    }
+    ASSERT_EQ(1, summary.tie_forces.rows());
+    EXPECT_NEAR(expected.tie_forces(0, 0), summary.tie_forces(0, 0), 1e-8);
+}
+
+TEST(ElementStreamTest, StreamedSolveSkipsUnrequestedElementForces) {
+    const Model model = createTestModel();
+    writeTestModel(model, "stream_skip_elems.csv", "stream_skip_props.csv");
+    const Summary expected = solve(model, Options());
+
+    Model streamed_model = model;
+    streamed_model.job = Job(model.job.nodes, std::vector<Elem>());
+    streamed_model.element_stream = std::make_shared<ElementStream>("stream_skip_elems.csv",
+                                                                    "stream_skip_props.csv", 2);
+    Options options;
+    options.compute_element_forces = false;
+    const Summary summary = solve(streamed_model, options);
+
+    EXPECT_EQ(model.job.elems.size(), summary.num_elems);
+    EXPECT_EQ(0, summary.element_forces.rows());
+    ASSERT_EQ(expected.nodal_displacements.rows(), summary.nodal_displacements.rows());
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+            EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+        }
+    }
+}
+
+TEST(ElementStreamTest, StreamedSolveWithConstraintsMatchesInMemorySolve) {
+    Model model = createTestModel();
+    // an element ends at node 5, which is condensed into node 4
+    model.job.nodes.push_back(Node(4, 1, 1.5));
+    model.job.elems.push_back(Connectivity(2, 5));
+    model.job.props.push_back(model.job.props[0]);
+    model.rigid_bodies = {RigidBody(4, 5)};
+    model.forces.push_back(Force(5, DOF::DISPLACEMENT_X, 3));
+    model.equations = {Equation({Equation::Term(1, DOF::DISPLACEMENT_X, 1),
+                                 Equation::Term(2, DOF::DISPLACEMENT_X, -1)})};
+    writeTestModel(model, "stream_constraints_elems.csv", "stream_constraints_props.csv");
+    const Summary expected = solve(model, Options());
+
+    Model streamed_model = model;
+    streamed_model.job = Job(model.job.nodes, std::vector<Elem>());
+    streamed_model.element_stream = std::make_shared<ElementStream>("stream_constraints_elems.csv",
+                                                                    "stream_constraints_props.csv", 2);
+    const Summary summary = solve(streamed_model, Options());
+
+    ASSERT_EQ(expected.nodal_displacements.rows(), summary.nodal_displacements.rows());
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+            EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+        }
+    }
+}
+
+TEST(ElementStreamTest, ThrowsOnMissingNode) {
+    Model model = createTestModel();
+    writeFile("stream_missing_node_elems.csv", "0,1\n1,7\n");
+    writeFile("stream_missing_node_props.csv", "1,2,3,4,0,0,1\n1,2,3,4,0,0,1\n");
+    model.job = Job(model.job.nodes, std::vector<Elem>());
+    model.element_stream = std::make_shared<ElementStream>("stream_missing_node_elems.csv",
+                                                           "stream_missing_node_props.csv", 2);
+    EXPECT_THROW(solve(model, Options()), std::runtime_error);
+}
+
+TEST(ElementStreamTest, CreatesStreamedModelFromJSON) {
+    const Model model = createTestModel();
+    writeTestModel(model, "stream_json_elems.csv", "stream_json_props.csv");
+    writeFile("stream_json_nodes.csv", "0,0,0\n1,0,0\n2,0.5,0\n3,0.5,1\n4,1,1\n");
+
+    rapidjson::Document doc;
+    doc.Parse("{\"nodes\": \"stream_json_nodes.csv\", \"elems\": \"stream_json_elems.csv\", "
+              "\"props\": \"stream_json_props.csv\", \"element_chunk_size\": 3}");
+    const Model streamed_model = createModelFromJSON(doc);
+
+    EXPECT_EQ(5, streamed_model.job.nodes.size());
+    EXPECT_TRUE(streamed_model.job.elems.empty());
+    ASSERT_TRUE(streamed_model.element_stream != nullptr);
+    EXPECT_EQ(3, streamed_model.element_stream->getChunkSize());
+
+    doc.Parse("{\"nodes\": \"stream_json_nodes.csv\", \"elems\": [[0, 1]], \"props\": \"stream_json_props.csv\", "
+              "\"element_chunk_size\": 3}");
+    EXPECT_THROW(createModelFromJSON(doc), std::runtime_error);
+}
@@ -0,0 +1,106 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include "matrix_market.h"
+
+using namespace fea;
+
+namespace {
+    std::string readFile(const std::string &filename) {
+        std::ifstream file(filename);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    long long numNonzeros(const std::string &contents) {
+        std::istringstream stream(contents.substr(contents.find('\n') + 1));
+        long long num_rows, num_cols, num_nonzeros;
+        stream >> num_rows >> num_cols >> num_nonzeros;
+        return num_nonzeros;
+    }
+
+    SparseMat createTestMatrix() {
+        std::vector<Triplet> triplets = {Triplet(0, 0, 4), Triplet(1, 0, -1), Triplet(0, 1, -1),
+                                         Triplet(1, 1, 0.1), Triplet(2, 1, 1), Triplet(1, 2, 1)};
+        SparseMat matrix(3, 3);
+        matrix.setFromTriplets(triplets.begin(), triplets.end());
+        return matrix;
+    }
+}
+
+TEST(MatrixMarketTest, WritesSparseMatrix) {
+    writeMatrixMarket("matrix.mtx", createTestMatrix());
+    EXPECT_EQ("%%MatrixMarket matrix coordinate real general\n"
+                      "3 3 6\n"
+                      "1 1 4\n"
+                      "2 1 -1\n"
+                      "1 2 -1\n"
+                      "2 2 0.10000000000000001\n"
+                      "3 2 1\n"
+                      "2 3 1\n", readFile("matrix.mtx"));
+}
+
+TEST(MatrixMarketTest, WritesLeadingBlock) {
+    writeMatrixMarket("block.mtx", createTestMatrix(), 2, 2);
+    EXPECT_EQ("%%MatrixMarket matrix coordinate real general\n"
+                      "2 2 4\n"
+                      "1 1 4\n"
+                      "2 1 -1\n"
+                      "1 2 -1\n"
+                      "2 2 0.10000000000000001\n", readFile("block.mtx"));
+}
+
+TEST(MatrixMarketTest, WritesVector) {
+    ForceVector vector(3);
+    vector << 1, -2.5, 0;
+    writeMatrixMarket("vector.mtx", vector);
+    EXPECT_EQ("%%MatrixMarket matrix array real general\n3 1\n1\n-2.5\n0\n", readFile("vector.mtx"));
+}
+
+TEST(MatrixMarketTest, SavesGlobalSystemOfAnalysis) {
+    Props props(1, 2, 3, 4, {0, 0, 1});
+    Job job({Node(0, 0, 0), Node(1, 0, 0)}, {Elem(0, 1, props)});
+    std::vector<BC> bcs;
+    for (unsigned int dof = 0; dof < DOF::NUM_DOFS; ++dof) {
+        bcs.push_back(BC(0, dof, 0));
+    }
+    std::vector<Force> forces = {Force(1, DOF::DISPLACEMENT_Y, 2)};
+    Options options;
+    options.save_global_system = true;
+    options.global_system_prefix = "cantilever";
+    solve(job, bcs, forces, std::vector<Tie>(), std::vector<Equation>(), options);
+
+    const std::string Kg = readFile("cantilever_Kg.mtx");
+    const std::string KgNoBC = readFile("cantilever_KgNoBC.mtx");
+    const std::string rhs = readFile("cantilever_rhs.mtx");
+    EXPECT_EQ(0, Kg.find("%%MatrixMarket matrix coordinate real general\n18 18 "));
+    EXPECT_EQ(0, KgNoBC.find("%%MatrixMarket matrix coordinate real general\n12 12 "));
+    EXPECT_EQ(0, rhs.find("%%MatrixMarket matrix array real general\n18 1\n"));
+    // the Lagrange multipliers border the stiffness matrix with 2 coefficients per boundary condition
+    EXPECT_EQ(numNonzeros(KgNoBC) + 12, numNonzeros(Kg));
+}
@@ -0,0 +1,219 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <fstream>
+#include "mesh_import.h"
+
+using namespace fea;
+
+namespace {
+    void writeFile(const std::string &filename, const std::string &contents) {
+        std::ofstream file(filename, std::ios::binary);
+        file << contents;
+    }
+
+    std::vector<Props> createTestSections() {
+        return {Props(1, 2, 3, 4, {0, 0, 1}), Props(5, 6, 7, 8, {0, 1, 0})};
+    }
+}
+
+TEST(MeshImportTest, ReadsGmshVersion2) {
+    writeFile("mesh_v2.msh",
+              "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n"
+              "$Nodes\n3\n10 0 0 0\n20 1 0 0\n30 2 0.5 0\n$EndNodes\n"
+              "$Elements\n4\n"
+              "1 15 2 1 1 10\n"
+              "2 1 2 2 1 10 20\n"
+              "3 1 2 1 2 20 30\n"
+              "4 2 2 1 3 10 20 30\n"
+              "$EndElements\n");
+    Model model = readGmsh("mesh_v2.msh", createTestSections());
+
+    ASSERT_EQ(3, model.job.nodes.size());
+    EXPECT_EQ(Node(2, 0.5, 0), model.job.nodes[2]);
+    ASSERT_EQ(2, model.job.elems.size());
+    EXPECT_EQ(0, model.job.elems[0](0));
+    EXPECT_EQ(1, model.job.elems[0](1));
+    EXPECT_EQ(1, model.job.elems[1](0));
+    EXPECT_EQ(2, model.job.elems[1](1));
+    EXPECT_EQ(6, model.job.getProps(0).EIz);
+    EXPECT_EQ(2, model.job.getProps(1).EIz);
+    EXPECT_TRUE(model.bcs.empty());
+}
+
+TEST(MeshImportTest, ReadsGmshVersion4) {
+    writeFile("mesh_v4.msh",
+              "$MeshFormat\r\n4.1 0 8\r\n$EndMeshFormat\r\n"
+              "$PhysicalNames\r\n1\r\n1 2 \"beams\"\r\n$EndPhysicalNames\r\n"
+              "$Entities\r\n2 1 0 0\r\n"
+              "1 0 0 0 0\r\n2 2 0 0 0\r\n"
+              "1 0 0 0 2 0 0 1 2 2 1 -2\r\n"
+              "$EndEntities\r\n"
+              "$Nodes\r\n2 3 1 7\r\n"
+              "0 1 0 1\r\n7\r\n0 0 0\r\n"
+              "1 1 0 2\r\n5\r\n6\r\n1 0 0\r\n2 0 0\r\n"
+              "$EndNodes\r\n"
+              "$Elements\r\n2 3 1 3\r\n"
+              "0 1 15 1\r\n1 7\r\n"
+              "1 1 1 2\r\n2 7 5\r\n3 5 6\r\n"
+              "$EndElements\r\n");
+    Model model = readGmsh("mesh_v4.msh", createTestSections());
+
+    ASSERT_EQ(3, model.job.nodes.size());
+    EXPECT_EQ(Node(1, 0, 0), model.job.nodes[1]);
+    ASSERT_EQ(2, model.job.elems.size());
+    EXPECT_EQ(0, model.job.elems[0](0));
+    EXPECT_EQ(1, model.job.elems[0](1));
+    EXPECT_EQ(2, model.job.elems[1](1));
+    EXPECT_EQ(6, model.job.getProps(0).EIz);
+    EXPECT_EQ(6, model.job.getProps(1).EIz);
+}
+
+TEST(MeshImportTest, SingleSectionAppliesToAllGmshLines) {
+    writeFile("mesh_single.msh",
+              "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n"
+              "$Nodes\n2\n1 0 0 0\n2 1 0 0\n$EndNodes\n"
+              "$Elements\n1\n1 1 2 9 1 1 2\n$EndElements\n");
+    Model model = readGmsh("mesh_single.msh", {Props(1, 2, 3, 4, {0, 0, 1})});
+    ASSERT_EQ(1, model.job.elems.size());
+    EXPECT_EQ(2, model.job.getProps(0).EIz);
+}
+
+TEST(MeshImportTest, GmshErrorsAreReported) {
+    writeFile("mesh_binary.msh", "$MeshFormat\n2.2 1 8\n$EndMeshFormat\n");
+    EXPECT_THROW(readGmsh("mesh_binary.msh", createTestSections()), std::runtime_error);
+
+    writeFile("mesh_missing_node.msh",
+              "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n"
+              "$Nodes\n1\n1 0 0 0\n$EndNodes\n"
+              "$Elements\n1\n1 1 2 1 1 1 2\n$EndElements\n");
+    EXPECT_THROW(readGmsh("mesh_missing_node.msh", createTestSections()), std::runtime_error);
+
+    writeFile("mesh_group.msh",
+              "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n"
+              "$Nodes\n2\n1 0 0 0\n2 1 0 0\n$EndNodes\n"
+              "$Elements\n1\n1 1 2 3 1 1 2\n$EndElements\n");
+    EXPECT_THROW(readGmsh("mesh_group.msh", createTestSections()), std::runtime_error);
+}
+
+TEST(MeshImportTest, ReadsAbaqusBeamModel) {
+    writeFile("model.inp",
+              "*HEADING\n"
+              "** cantilever\n"
+              "*Node, nset=all\n"
+              "101, 0., 0., 0.\n"
+              "102, 1., 0., 0.\n"
+              "103, 2., 0., 0.\n"
+              "*Element, type=B31, elset=rods\n"
+              "1, 101, 102\n"
+              "*Element, type=B33\n"
+              "2, 102, 103\n"
+              "*Elset, elset=boxes, generate\n"
+              "2, 2, 1\n"
+              "*Nset, nset=tip\n"
+              "103\n"
+              "*Material, name=steel\n"
+              "*Density\n"
+              "7800.\n"
+              "*Elastic\n"
+              "200., 0.25\n"
+              "*Beam Section, elset=rods, material=steel, section=CIRC\n"
+              "0.5\n"
+              "0., 1., 0.\n"
+              "*Beam Section, elset=boxes, material=STEEL, section=RECT\n"
+              "2., 1.\n"
+              "*Beam General Section, elset=none, section=GENERAL\n"
+              "1., 2., 0., 3., 4.\n"
+              "0., 0., -1.\n"
+              "10., 4.\n"
+              "*Boundary\n"
+              "101, ENCASTRE\n"
+              "102, 2, 3, 0.5\n"
+              "*Cload\n"
+              "tip, 2, -10.\n");
+    Model model = readAbaqus("model.inp");
+
+    ASSERT_EQ(3, model.job.nodes.size());
+    EXPECT_EQ(Node(2, 0, 0), model.job.nodes[2]);
+    ASSERT_EQ(2, model.job.elems.size());
+    EXPECT_EQ(1, model.job.elems[1](0));
+    EXPECT_EQ(2, model.job.elems[1](1));
+
+    const double pi = std::acos(-1.0);
+    const Props &rod = model.job.getProps(0);
+    EXPECT_DOUBLE_EQ(200 * pi * 0.25, rod.EA);
+    EXPECT_DOUBLE_EQ(200 * pi * 0.0625 / 4, rod.EIy);
+    EXPECT_DOUBLE_EQ(80 * pi * 0.0625 / 2, rod.GJ);
+    EXPECT_EQ(Eigen::Vector3d(0, 1, 0), rod.normal_vec);
+
+    const Props &box = model.job.getProps(1);
+    EXPECT_DOUBLE_EQ(200 * 2, box.EA);
+    EXPECT_DOUBLE_EQ(200 * 2.0 / 12, box.EIy);
+    EXPECT_DOUBLE_EQ(200 * 8.0 / 12, box.EIz);
+    EXPECT_EQ(Eigen::Vector3d(0, 0, -1), box.normal_vec);
+
+    ASSERT_EQ(8, model.bcs.size());
+    EXPECT_EQ(0, model.bcs[0].node);
+    EXPECT_EQ(0, model.bcs[0].dof);
+    EXPECT_EQ(5, model.bcs[5].dof);
+    EXPECT_EQ(1, model.bcs[6].node);
+    EXPECT_EQ(1, model.bcs[6].dof);
+    EXPECT_EQ(0.5, model.bcs[7].value);
+
+    ASSERT_EQ(1, model.forces.size());
+    EXPECT_EQ(2, model.forces[0].node);
+    EXPECT_EQ(1, model.forces[0].dof);
+    EXPECT_EQ(-10, model.forces[0].value);
+}
+
+TEST(MeshImportTest, AbaqusErrorsAreReported) {
+    writeFile("truss.inp",
+              "*Node\n1, 0, 0, 0\n2, 1, 0, 0\n"
+              "*Element, type=T3D2\n1, 1, 2\n");
+    EXPECT_THROW(readAbaqus("truss.inp"), std::runtime_error);
+
+    writeFile("no_section.inp",
+              "*Node\n1, 0, 0, 0\n2, 1, 0, 0\n"
+              "*Element, type=B31\n1, 1, 2\n");
+    EXPECT_THROW(readAbaqus("no_section.inp"), std::runtime_error);
+
+    writeFile("missing_nset.inp",
+              "*Node\n1, 0, 0, 0\n2, 1, 0, 0\n"
+              "*Element, type=B31, elset=all\n1, 1, 2\n"
+              "*Beam General Section, elset=all, section=GENERAL\n1, 1, 0, 1, 1\n0, 0, 1\n1, 1\n"
+              "*Boundary\nfixed, 1, 6\n");
+    EXPECT_THROW(readAbaqus("missing_nset.inp"), std::runtime_error);
+}
+
+TEST(MeshImportTest, ReadMeshDispatchesOnExtension) {
+    writeFile("dispatch.INP",
+              "*Node\n1, 0, 0, 0\n2, 1, 0, 0\n"
+              "*Element, type=B31, elset=all\n1, 1, 2\n"
+              "*Beam General Section, elset=all, section=GENERAL\n1, 1, 0, 1, 1\n0, 0, 1\n1, 1\n");
+    EXPECT_EQ(1, readMesh("dispatch.INP", {}).job.elems.size());
+    EXPECT_THROW(readMesh("mesh.vtk", {}), std::runtime_error);
+}
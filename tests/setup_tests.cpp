@@ -24,6 +24,10 @@
 // Author: ryan.latture@gmail.com (Ryan Latture)
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "binary_io.h"
 #include "csv_parser.h"
 #include "setup.h"
 
@@ -90,6 +94,43 @@ TEST(SetupTest, CreatesCorrectNodesFromJSON) {
     }
 }
 
+TEST(SetupTest, CreatesCorrectNodesAndBCsFromNpy) {
+    std::string nodes_file = "CreatesNodesFromNpy.npy";
+    std::string bcs_file = "CreatesBCsFromNpy.npy";
+    rapidjson::Document doc;
+    doc.Parse(("{\"nodes\":\"" + nodes_file + "\",\"bcs\":\"" + bcs_file + "\"}").c_str());
+
+    std::vector<std::vector<double> > expected_nodes = {{1, 2, 3},
+                                                        {4, 5, 6}};
+    writeNpy(nodes_file, expected_nodes);
+    writeNpy(bcs_file, {{1, 2, 0.5}});
+
+    std::vector<Node> nodes = createNodeVecFromJSON(doc);
+    ASSERT_EQ(2, nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(expected_nodes[i][j], nodes[i][j]);
+        }
+    }
+
+    std::vector<BC> bcs = createBCVecFromJSON(doc);
+    ASSERT_EQ(1, bcs.size());
+    EXPECT_EQ(1, bcs[0].node);
+    EXPECT_EQ(2, bcs[0].dof);
+    EXPECT_DOUBLE_EQ(0.5, bcs[0].value);
+
+    // the shape is checked like the rows of a csv file
+    writeNpy(nodes_file, {{1, 2}});
+    EXPECT_THROW(createNodeVecFromJSON(doc), std::runtime_error);
+
+    if (std::remove(nodes_file.c_str()) != 0) {
+        std::cerr << "Error removing test npy file " << nodes_file << ".\n";
+    }
+    if (std::remove(bcs_file.c_str()) != 0) {
+        std::cerr << "Error removing test npy file " << bcs_file << ".\n";
+    }
+}
+
 TEST(SetupTest, CreatesCorrectElemsFromJSON) {
     std::string elems_file = "CreatesCorrectElems_elems.csv";
     std::string props_file = "CreatesCorrectElems_props.csv";
@@ -262,6 +303,39 @@ TEST(SetupTest, CreatesCorrectEquationsFromJSON) {
     }
 }
 
+TEST(SetupTest, CreatesCorrectRigidBodiesFromJSON) {
+    std::string bodies_file = "CreatesCorrectRigidBodies.csv";
+    std::string json = "{\"rigid_bodies\":\"" + bodies_file + "\"}\n";
+    std::string filename = "CreatesCorrectRigidBodies.json";
+    writeStringToTxt(filename, json);
+
+    rapidjson::Document doc = parseJSONConfig(filename);
+
+    std::vector<std::vector<double> > expected = {{0, 1},
+                                                  {2, 3, 4, 5}};
+
+    CSVParser csv;
+    csv.write(bodies_file, expected, 0, ",");
+
+    std::vector<RigidBody> bodies = createRigidBodyVecFromJSON(doc);
+
+    ASSERT_EQ(expected.size(), bodies.size());
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        EXPECT_EQ((unsigned int) expected[i][0], bodies[i].master_node);
+        ASSERT_EQ(expected[i].size() - 1, bodies[i].slave_nodes.size());
+        for (size_t j = 0; j < bodies[i].slave_nodes.size(); ++j) {
+            EXPECT_EQ((unsigned int) expected[i][j + 1], bodies[i].slave_nodes[j]);
+        }
+    }
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+    if (std::remove(bodies_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << bodies_file << ".\n";
+    }
+}
+
 TEST(SetupTest, CreatesCorrectJobFromJSON) {
     std::string elems_file = "CreatesCorrectJob_elems.csv";
     std::string props_file = "CreatesCorrectJob_props.csv";
@@ -328,7 +402,11 @@ TEST(SetupTest, CreatesCorrectOptionsFromJSON) {
             "\"save_nodal_displacements\":true,\"save_nodal_forces\":true,\"save_nodal_forces\":true,"
             "\"save_tie_forces\":true,\"verbose\":true,\"save_report\":true,"
             "\"nodal_displacements_filename\":\"ndf.csv\",\"nodal_forces_filename\":\"nff.csv\","
-            "\"tie_forces_filename\":\"tff.csv\",\"report_filename\":\"rf.txt\"}}\n";
+            "\"tie_forces_filename\":\"tff.csv\",\"report_filename\":\"rf.txt\","
+            "\"cache_element_matrices\":true,\"element_cache_tolerance\":1E-8,\"analysis_type\":\"truss_2d\","
+            "\"merge_coincident_nodes\":true,\"coincident_node_tolerance\":1E-6,\"result_format\":\"npy\","
+            "\"save_elemental_forces\":true,\"elemental_forces_filename\":\"eff.csv\","
+            "\"compute_nodal_forces\":false,\"compute_tie_forces\":false,\"compute_element_forces\":false}}\n";
     std::string filename = "CreatesCorrectOptions.json";
     writeStringToTxt(filename, json);
 
@@ -346,6 +424,17 @@ TEST(SetupTest, CreatesCorrectOptionsFromJSON) {
     expected.nodal_forces_filename = "nff.csv";
     expected.tie_forces_filename = "tff.csv";
     expected.report_filename = "rf.txt";
+    expected.cache_element_matrices = true;
+    expected.element_cache_tolerance = 1E-8;
+    expected.analysis_type = TRUSS_2D;
+    expected.merge_coincident_nodes = true;
+    expected.coincident_node_tolerance = 1E-6;
+    expected.result_format = NPY_RESULTS;
+    expected.save_elemental_forces = true;
+    expected.elemental_forces_filename = "eff.csv";
+    expected.compute_nodal_forces = false;
+    expected.compute_tie_forces = false;
+    expected.compute_element_forces = false;
 
     Options options = createOptionsFromJSON(doc);
 
@@ -360,6 +449,254 @@ TEST(SetupTest, CreatesCorrectOptionsFromJSON) {
     EXPECT_EQ(expected.nodal_forces_filename, options.nodal_forces_filename);
     EXPECT_EQ(expected.tie_forces_filename, options.tie_forces_filename);
     EXPECT_EQ(expected.report_filename, options.report_filename);
+    EXPECT_EQ(expected.cache_element_matrices, options.cache_element_matrices);
+    EXPECT_DOUBLE_EQ(expected.element_cache_tolerance, options.element_cache_tolerance);
+    EXPECT_EQ(expected.analysis_type, options.analysis_type);
+    EXPECT_EQ(expected.merge_coincident_nodes, options.merge_coincident_nodes);
+    EXPECT_DOUBLE_EQ(expected.coincident_node_tolerance, options.coincident_node_tolerance);
+    EXPECT_EQ(expected.result_format, options.result_format);
+    EXPECT_EQ(expected.save_elemental_forces, options.save_elemental_forces);
+    EXPECT_EQ(expected.elemental_forces_filename, options.elemental_forces_filename);
+    EXPECT_EQ(expected.compute_nodal_forces, options.compute_nodal_forces);
+    EXPECT_EQ(expected.compute_tie_forces, options.compute_tie_forces);
+    EXPECT_EQ(expected.compute_element_forces, options.compute_element_forces);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
+
+TEST(SetupTest, CreatesCorrectJobFromSections) {
+    std::string elems_file = "CreatesCorrectJobFromSections_elems.csv";
+    std::string sections_file = "CreatesCorrectJobFromSections_sections.csv";
+    std::string nodes_file = "CreatesCorrectJobFromSections_nodes.csv";
+
+    std::vector<std::vector<double> > elems_rows = {{0, 1, 1},
+                                                    {1, 2, 0, 0, 0, 1},
+                                                    {2, 0, 1}};
+    std::vector<std::vector<double> > expected_sections = {{1, 2, 3, 4, 0, 1, 0},
+                                                           {8, 9, 10, 11, 1, 0, 0}};
+    std::vector<std::vector<double> > expected_nodes = {{0, 0, 0},
+                                                        {1, 0, 0},
+                                                        {0, 1, 0}};
+
+    CSVParser csv;
+    csv.write(elems_file, elems_rows, 0, ",");
+    csv.write(sections_file, expected_sections, 1, ",");
+    csv.write(nodes_file, expected_nodes, 1, ",");
+
+    std::string json = "{\"elems\":\"" + elems_file + "\",\"sections\":\"" + sections_file + "\",\"nodes\":\"" +
+                       nodes_file + "\"}\n";
+    std::string filename = "CreatesCorrectJobFromSections.json";
+    writeStringToTxt(filename, json);
+
+    rapidjson::Document doc = parseJSONConfig(filename);
+
+    Job job = createJobFromJSON(doc);
+
+    EXPECT_EQ(0, job.props.size());
+    ASSERT_EQ(2, job.sections.size());
+    ASSERT_EQ(3, job.elems.size());
+
+    std::vector<unsigned int> expected_ids = {1, 0, 1};
+    std::vector<Eigen::Vector3d> expected_normals = {Eigen::Vector3d(1, 0, 0),
+                                                     Eigen::Vector3d(0, 0, 1),
+                                                     Eigen::Vector3d(1, 0, 0)};
+    for (size_t i = 0; i < job.elems.size(); ++i) {
+        EXPECT_EQ((int) elems_rows[i][0], job.elems[i][0]);
+        EXPECT_EQ((int) elems_rows[i][1], job.elems[i][1]);
+        EXPECT_EQ(expected_ids[i], job.section_ids[i]);
+        EXPECT_DOUBLE_EQ(expected_sections[expected_ids[i]][0], job.getProps(i).EA);
+        EXPECT_DOUBLE_EQ(expected_sections[expected_ids[i]][3], job.getProps(i).GJ);
+        for (int j = 0; j < 3; ++j) {
+            EXPECT_DOUBLE_EQ(expected_normals[i][j], job.getNormalVec(i)[j]);
+        }
+    }
+
+    // the element vector expands the section table into per-element properties
+    std::vector<Elem> elems = createElemVecFromJSON(doc);
+    ASSERT_EQ(3, elems.size());
+    EXPECT_DOUBLE_EQ(1, elems[1].props.EA);
+    EXPECT_DOUBLE_EQ(1, elems[1].props.normal_vec[2]);
+    EXPECT_DOUBLE_EQ(8, elems[2].props.EA);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+    if (std::remove(elems_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << elems_file << ".\n";
+    }
+    if (std::remove(sections_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << sections_file << ".\n";
+    }
+    if (std::remove(nodes_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << nodes_file << ".\n";
+    }
+}
+
+TEST(SetupTest, LoadsModelFilesWithLoadTimes) {
+    std::string nodes_file = "LoadsModelNodes.csv";
+    std::string elems_file = "LoadsModelElems.csv";
+    std::string props_file = "LoadsModelProps.csv";
+    std::string bcs_file = "LoadsModelBCs.csv";
+    writeStringToTxt(nodes_file, "0,0,0\n1,0,0\n2,0,0\n");
+    writeStringToTxt(elems_file, "0,1\n1,2\n");
+    writeStringToTxt(props_file, "1,2,3,4,0,0,1\n5,6,7,8,0,1,0\n");
+    writeStringToTxt(bcs_file, "0,0,0\n0,1,0.5\n");
+
+    rapidjson::Document doc;
+    doc.Parse(("{\"nodes\":\"" + nodes_file + "\",\"elems\":\"" + elems_file + "\",\"props\":\"" +
+               props_file + "\",\"bcs\":\"" + bcs_file + "\"}").c_str());
+
+    Summary load_summary;
+    Model model = createModelFromJSON(doc, load_summary);
+
+    ASSERT_EQ(3, model.job.nodes.size());
+    ASSERT_EQ(2, model.job.elems.size());
+    ASSERT_EQ(2, model.job.props.size());
+    EXPECT_EQ(2u, model.job.elems[1][1]);
+    EXPECT_DOUBLE_EQ(5, model.job.props[1].EA);
+    EXPECT_DOUBLE_EQ(1, model.job.props[1].normal_vec[1]);
+    ASSERT_EQ(2, model.bcs.size());
+    EXPECT_DOUBLE_EQ(0.5, model.bcs[1].value);
+    EXPECT_TRUE(model.forces.empty());
+
+    std::vector<std::string> expected_names = {"nodes", "elems", "props", "bcs"};
+    ASSERT_EQ(expected_names.size(), load_summary.file_load_times_in_ms.size());
+    for (size_t i = 0; i < expected_names.size(); ++i) {
+        EXPECT_EQ(expected_names[i], load_summary.file_load_times_in_ms[i].first);
+        EXPECT_GE(load_summary.file_load_times_in_ms[i].second, 0);
+    }
+    EXPECT_GE(load_summary.input_load_time_in_ms, 0);
+
+    // an error in one of the concurrent loads is reported once all loads finished
+    std::remove(bcs_file.c_str());
+    EXPECT_THROW(createModelFromJSON(doc, load_summary), std::runtime_error);
+
+    for (const std::string &file : {nodes_file, elems_file, props_file}) {
+        if (std::remove(file.c_str()) != 0) {
+            std::cerr << "Error removing test csv file " << file << ".\n";
+        }
+    }
+}
+
+TEST(SetupTest, RunsLoadTasksConcurrently) {
+#ifdef _OPENMP
+    // use several threads even on a single core
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(std::max(max_threads, 4));
+
+    // each task waits until another one is loading at the same time, or gives up after a few seconds
+    std::atomic<int> num_active(0);
+    std::atomic<int> max_active(0);
+    auto load = [&num_active, &max_active]() {
+        const int active = ++num_active;
+        int seen = max_active.load();
+        while (active > seen && !max_active.compare_exchange_weak(seen, active)) { }
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (max_active.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        --num_active;
+    };
+
+    // a file of several chunks is parsed by the tasks of the other threads and must match a sequential parse
+    std::string filename = "RunsLoadTasksConcurrently.csv";
+    std::ofstream output_file(filename);
+    for (int i = 0; i < 200000; ++i) {
+        output_file << i << "," << i + 1 << "," << 0.5 * i << "\n";
+    }
+    output_file.close();
+    std::vector<double> data;
+    std::vector<size_t> row_offsets;
+    CSVParser csv;
+
+    std::vector<LoadTask> tasks = {LoadTask("first", load), LoadTask("second", load),
+                                   LoadTask("csv", [&]() { csv.parseToArray(filename, data, row_offsets); })};
+    std::vector<std::pair<std::string, long long> > load_times;
+    runLoadTasks(tasks, load_times);
+    EXPECT_GE(max_active.load(), 2);
+    ASSERT_EQ(3, load_times.size());
+    EXPECT_EQ("second", load_times[1].first);
+
+    omp_set_num_threads(1);
+    std::vector<double> expected_data;
+    std::vector<size_t> expected_offsets;
+    csv.parseToArray(filename, expected_data, expected_offsets);
+    EXPECT_EQ(expected_data, data);
+    EXPECT_EQ(expected_offsets, row_offsets);
+    omp_set_num_threads(max_threads);
+
+    // errors are rethrown after all tasks finished
+    bool finished = false;
+    tasks = {LoadTask("failing", []() { throw std::runtime_error("failed"); }),
+             LoadTask("finishing", [&finished]() { finished = true; })};
+    EXPECT_THROW(runLoadTasks(tasks, load_times), std::runtime_error);
+    EXPECT_TRUE(finished);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+#endif
+}
+
+TEST(SetupTest, CreatesModelFromInlineArrays) {
+    std::string json = "{\"nodes\":[[0,0,0],[1,0,0],[2,0.5,0]],\"elems\":[[0,1],[1,2.0]],"
+            "\"props\":[[1,2,3,4,0,0,1],[5,6,7,8,0,1,0]],\"bcs\":[[0,0,0],[0,1,0]],"
+            "\"forces\":[[2,1,-10]],\"ties\":[[1,2,100,200]],\"equations\":[[1,0,1,2,0,-1]],"
+            "\"rigid_bodies\":[[0,1]]}\n";
+    std::string filename = "CreatesModelFromInlineArrays.json";
+    writeStringToTxt(filename, json);
+
+    rapidjson::Document doc = parseJSONConfig(filename);
+    Model model = createModelFromJSON(doc);
+
+    ASSERT_EQ(3, model.job.nodes.size());
+    EXPECT_DOUBLE_EQ(0.5, model.job.nodes[2][1]);
+    ASSERT_EQ(2, model.job.elems.size());
+    EXPECT_EQ(2u, model.job.elems[1][1]);
+    EXPECT_DOUBLE_EQ(8, model.job.props[1].GJ);
+    ASSERT_EQ(2, model.bcs.size());
+    EXPECT_EQ(1, model.bcs[1].dof);
+    ASSERT_EQ(1, model.forces.size());
+    EXPECT_DOUBLE_EQ(-10, model.forces[0].value);
+    ASSERT_EQ(1, model.ties.size());
+    EXPECT_DOUBLE_EQ(200, model.ties[0].rmult);
+    ASSERT_EQ(1, model.equations.size());
+    ASSERT_EQ(2, model.equations[0].terms.size());
+    EXPECT_DOUBLE_EQ(-1, model.equations[0].terms[1].coefficient);
+    ASSERT_EQ(1, model.rigid_bodies.size());
+    EXPECT_EQ(1, model.rigid_bodies[0].slave_nodes[0]);
+
+    rapidjson::Document invalid;
+    invalid.Parse("{\"nodes\":[[0,0,\"x\"]]}");
+    EXPECT_THROW(createNodeVecFromJSON(invalid), std::runtime_error);
+
+    // rows are checked against the number of values of each input
+    invalid.Parse("{\"bcs\":[[0,0,0],[0,1]],\"forces\":[[0,1,2,3]],\"ties\":[[0,1,2]],"
+                  "\"equations\":[[0,1,1,2]],\"rigid_bodies\":[[0,1],[2]],\"sections\":[[1,2,3]]}");
+    EXPECT_THROW(createBCVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createForceVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createTieVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createEquationVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createRigidBodyVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createSectionVecFromJSON(invalid), std::runtime_error);
+
+    // node indices and DOFs must be non-negative integers
+    invalid.Parse("{\"bcs\":[[-1,0,0]],\"forces\":[[0,1.5,2]],\"ties\":[[0,0.5,1,1]],"
+                  "\"equations\":[[-2,0,1]],\"rigid_bodies\":[[0,1.5]],\"nodes\":[[0,0,0],[1,0,0]],"
+                  "\"elems\":[[0,-1]],\"props\":[[1,2,3,4,0,0,1]]}");
+    EXPECT_THROW(createBCVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createForceVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createTieVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createEquationVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createRigidBodyVecFromJSON(invalid), std::runtime_error);
+    EXPECT_THROW(createJobFromJSON(invalid), std::runtime_error);
+    invalid.Parse("{\"nodes\":[[0,0,0],[1,0,0]],\"elems\":[[0,0.5,0]],\"sections\":[[1,2,3,4,0,0,1]]}");
+    EXPECT_THROW(createJobFromJSON(invalid), std::runtime_error);
+
+    writeStringToTxt(filename, "{\"nodes\":[[0,0,0]\n");
+    EXPECT_THROW(parseJSONConfig(filename), std::runtime_error);
 
     if (std::remove(filename.c_str()) != 0) {
         std::cerr << "Error removing test csv file " << filename << ".\n";
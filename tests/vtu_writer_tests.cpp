@@ -0,0 +1,130 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "vtu_writer.h"
+
+using namespace fea;
+
+namespace {
+    std::string readFile(const std::string &filename) {
+        std::ifstream file(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    /**
+     * Returns the values of the appended array `name` of the vtu file held in `contents`.
+     */
+    template<typename T>
+    std::vector<T> readAppendedArray(const std::string &contents, const std::string &name) {
+        const size_t attribute = contents.find(name);
+        EXPECT_NE(std::string::npos, attribute);
+        const size_t offset_pos = contents.find("offset=\"", attribute) + 8;
+        const size_t offset = std::stoull(contents.substr(offset_pos, contents.find('"', offset_pos) - offset_pos));
+        const size_t data_start = contents.find("encoding=\"raw\">") + 15;
+        const size_t array_start = contents.find('_', data_start) + 1 + offset;
+
+        std::uint64_t num_bytes;
+        std::memcpy(&num_bytes, contents.data() + array_start, sizeof(num_bytes));
+        std::vector<T> values(num_bytes / sizeof(T));
+        std::memcpy(values.data(), contents.data() + array_start + sizeof(num_bytes), num_bytes);
+        return values;
+    }
+
+    Job createTestJob() {
+        Props props(1, 2, 3, 4, {0, 0, 1});
+        return Job({Node(0, 0, 0), Node(1, 0, 0), Node(2, 0.5, 0)}, {Elem(0, 1, props), Elem(1, 2, props)});
+    }
+
+    Summary createTestSummary() {
+        Summary summary;
+        summary.num_elems = 2;
+        summary.nodal_displacements.resize(3, 6);
+        summary.nodal_forces.resize(3, 6);
+        for (int i = 0; i < 3; ++i) {
+            summary.nodal_displacements.row(i) << 1.0 * i, 2.0 * i, 3.0 * i, 4.0 * i, 5.0 * i, 6.0 * i;
+            summary.nodal_forces.row(i) = -summary.nodal_displacements.row(i);
+        }
+        summary.element_forces.resize(2, 12);
+        for (int i = 0; i < 2; ++i) {
+            summary.element_forces.row(i).setConstant(10.0 + i);
+        }
+        return summary;
+    }
+}
+
+TEST(VTUWriterTest, WritesMeshAndResults) {
+    writeVTU("results.vtu", createTestJob(), createTestSummary());
+    const std::string contents = readFile("results.vtu");
+
+    EXPECT_NE(std::string::npos, contents.find("<Piece NumberOfPoints=\"3\" NumberOfCells=\"2\">"));
+    EXPECT_NE(std::string::npos, contents.find("byte_order=\"LittleEndian\" header_type=\"UInt64\""));
+
+    EXPECT_EQ((std::vector<double>{0, 0, 0, 1, 2, 3, 2, 4, 6}), readAppendedArray<double>(contents, "\"displacement\""));
+    EXPECT_EQ((std::vector<double>{0, 0, 0, 4, 5, 6, 8, 10, 12}), readAppendedArray<double>(contents, "\"rotation\""));
+    EXPECT_EQ((std::vector<double>{-0., -0., -0., -4, -5, -6, -8, -10, -12}),
+              readAppendedArray<double>(contents, "\"moment\""));
+
+    const std::vector<double> element_forces = readAppendedArray<double>(contents, "\"element_forces\"");
+    ASSERT_EQ(24, element_forces.size());
+    EXPECT_EQ(10, element_forces[0]);
+    EXPECT_EQ(11, element_forces[23]);
+
+    EXPECT_EQ((std::vector<double>{0, 0, 0, 1, 0, 0, 2, 0.5, 0}), readAppendedArray<double>(contents, "<Points>"));
+    EXPECT_EQ((std::vector<std::int64_t>{0, 1, 1, 2}), readAppendedArray<std::int64_t>(contents, "\"connectivity\""));
+    EXPECT_EQ((std::vector<std::int64_t>{2, 4}), readAppendedArray<std::int64_t>(contents, "\"offsets\""));
+    EXPECT_EQ((std::vector<std::uint8_t>{3, 3}), readAppendedArray<std::uint8_t>(contents, "\"types\""));
+    EXPECT_EQ("\n  </AppendedData>\n</VTKFile>\n", contents.substr(contents.size() - 30));
+}
+
+TEST(VTUWriterTest, LeavesOutMissingResults) {
+    Summary summary = createTestSummary();
+    summary.element_forces.resize(0, 12);
+    summary.nodal_forces.resize(0, 6);
+    writeVTU("partial_results.vtu", createTestJob(), summary);
+    const std::string contents = readFile("partial_results.vtu");
+
+    EXPECT_EQ(std::string::npos, contents.find("\"element_forces\""));
+    EXPECT_EQ(std::string::npos, contents.find("\"force\""));
+    EXPECT_EQ((std::vector<double>{0, 0, 0, 1, 2, 3, 2, 4, 6}), readAppendedArray<double>(contents, "\"displacement\""));
+    EXPECT_EQ((std::vector<std::int64_t>{0, 1, 1, 2}), readAppendedArray<std::int64_t>(contents, "\"connectivity\""));
+}
+
+TEST(VTUWriterTest, ReadsStreamedElements) {
+    std::ofstream("vtu_elems.csv") << "0,1\n1,2\n";
+    std::ofstream("vtu_props.csv") << "1,2,3,4,0,0,1\n1,2,3,4,0,0,1\n";
+    ElementStream stream("vtu_elems.csv", "vtu_props.csv", 1);
+    Job job = createTestJob();
+    job.elems.clear();
+    job.props.clear();
+
+    writeVTU("streamed_results.vtu", job, createTestSummary(), &stream);
+    writeVTU("results.vtu", createTestJob(), createTestSummary());
+    EXPECT_EQ(readFile("results.vtu"), readFile("streamed_results.vtu"));
+}